@@ -9,18 +9,22 @@
 	} scene;
 
 	layout(std140, binding = 1) uniform ObjectInfo {
-		mat4 transform, uvtransform;
+		vec4 transform[2], uvtransform[2];	// rows of 2d affine transforms
 	} obj;
 
 	layout(location = 0) out vec3 oPos;
 	layout(location = 1) out vec2 oUV;
 
+	vec2 apply(vec4 rows[2], vec2 p) {
+		return vec2(dot(rows[0].xyz, vec3(p, 1.0f)), dot(rows[1].xyz, vec3(p, 1.0f)));
+	}
+
 	void main() {
-		vec4 pos = vec4(iPos, 1.0f);
-		pos = scene.proj * scene.view * obj.transform * pos;
+		vec4 pos = vec4(apply(obj.transform, iPos.xy), iPos.z, 1.0f);
+		pos = scene.proj * scene.view * pos;
 		oPos = pos.xyz;
 		gl_Position = pos;
-		oUV = (obj.uvtransform * vec4(iUV, 0.0f, 1.0f)).xy;
+		oUV = apply(obj.uvtransform, iUV);
 	}
 
 #elif defined(FRAGMENT_SHADER)
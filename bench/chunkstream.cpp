@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <memory>
+#include <random>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+#include <chunkstream.hpp>
+#include <world.hpp>
+
+// the surface of WorldGenerator with caves and ore below it, chunks are generated when they are first asked for
+class StreamWorld : public WorldContainer {
+public:
+	std::shared_ptr<Chunk> loadChunk(lvec2 pos) override {
+		auto chunk = std::as_const(*this).getChunkAbsolute(pos);
+		if(chunk) {
+			return chunk;
+		}
+		chunk = generator.getChunk(pos);
+		if(pos.y < -1) {
+			std::mt19937 rng(pos.x * 73856093 ^ pos.y * 19349663);
+			std::uniform_int_distribution<int> coord(0, Chunk::size - 1), radius(2, 9);
+			for(int i = 0; i < 6; i++) {
+				ivec2 center(coord(rng), coord(rng));
+				int r = radius(rng);
+				uint32_t type = i < 4 ? Tile::null : Tile::stone;
+				for(int y = std::max(center.y - r, 0); y < std::min(center.y + r + 1, int(Chunk::size)); y++) {
+					for(int x = std::max(center.x - r, 0); x < std::min(center.x + r + 1, int(Chunk::size)); x++) {
+						if((x - center.x) * (x - center.x) + (y - center.y) * (y - center.y) <= r * r) {
+							chunk->at(ivec2(x, y)) = Tile(type, type == Tile::stone ? i : 0);
+						}
+					}
+				}
+			}
+		}
+		chunk->setModified(false);
+		setChunkAbsolute(pos, chunk);
+		return chunk;
+	}
+
+private:
+	WorldGenerator generator = WorldGenerator(*this, vec2(1.0f));
+};
+
+// forwards datagrams between the clients and the server, the way to each client is capped like a slow link with a short queue
+class CappedRelay {
+public:
+	CappedRelay(unsigned short serverPort, double capacity) : server(*network::udpsocket::resolve("127.0.0.1", serverPort)), capacity(capacity) {}
+
+	unsigned short getPort() const {
+		return front.getPort();
+	}
+
+	size_t getDropped() const {
+		return dropped;
+	}
+
+	void pump(float dt) {
+		struct sockaddr_in peer;
+		int len;
+		while((len = front.recvFrom(buffer, peer)) >= 0) {
+			auto it = std::find_if(routes.begin(), routes.end(), [&](const Route &route) {
+				return route.client.sin_port == peer.sin_port;
+			});
+			if(it == routes.end()) {
+				it = routes.insert(routes.end(), {peer, std::make_unique<network::udpsocket>(network::address::LoopBack), {}, 0, 0.0});
+			}
+			it->back->sendTo(std::span(buffer.data(), len), server);
+		}
+		for(Route &route : routes) {
+			while((len = route.back->recvFrom(buffer, peer)) >= 0) {
+				// 50 ms of queue but at least a few datagrams, the rest is dropped like a full router buffer would
+				if(route.queued + len > std::max(capacity * 0.05, 4800.0)) {
+					dropped++;
+					continue;
+				}
+				route.queue.emplace_back(buffer.begin(), buffer.begin() + len);
+				route.queued += len;
+			}
+			route.budget += capacity * dt;
+			while(!route.queue.empty() && route.budget >= route.queue.front().size()) {
+				front.sendTo(route.queue.front(), route.client);
+				route.budget -= route.queue.front().size();
+				route.queued -= route.queue.front().size();
+				route.queue.pop_front();
+			}
+			if(route.queue.empty()) {
+				route.budget = std::min(route.budget, 1200.0);
+			}
+		}
+	}
+
+private:
+	struct Route {
+		struct sockaddr_in client;
+		std::unique_ptr<network::udpsocket> back;
+		std::deque<std::vector<uint8_t>> queue;
+		size_t queued;
+		double budget;
+	};
+
+	network::udpsocket front = network::udpsocket(network::address::LoopBack);
+	struct sockaddr_in server;
+	std::vector<Route> routes;
+	std::array<uint8_t, 2048> buffer;
+	double capacity;
+	size_t dropped = 0;
+};
+
+// waits for its first view, then walks right along the surface and back, every client starts somewhere else
+static vec2 camera(int client, double time, double seconds) {
+	double wait = 2.0, speed = 1.5, turn = (seconds + wait) / 2;
+	double x = time < turn ? std::max(time - wait, 0.0) * speed : (seconds - time) * speed;
+	return vec2(client * 40.0 + x, -1.5);
+}
+
+static std::vector<lvec2> visible(vec2 camera, uint8_t radius) {
+	std::vector<lvec2> result;
+	lvec2 center = lvec2(std::floor(camera.x), std::floor(camera.y));
+	for(int y = -radius; y <= radius; y++) {
+		for(int x = -radius; x <= radius; x++) {
+			lvec2 pos = center + lvec2(x, y);
+			if(length(vec2(pos) + vec2(0.5f) - camera) <= radius) {
+				result.push_back(pos);
+			}
+		}
+	}
+	return result;
+}
+
+int main(int argc, char *argv[]) {
+	int clientCount = argc > 1 ? std::stoi(argv[1]) : 4;
+	double seconds = argc > 2 ? std::stod(argv[2]) : 20.0;
+	size_t rate = argc > 3 ? std::stoul(argv[3]) : 192 * 1024;
+	double capacity = argc > 4 ? std::stod(argv[4]) : 256 * 1024;
+	const uint8_t radius = 4;
+	const float dt = 1.0f / 60;
+
+	StreamWorld world;
+	ChunkStreamServer server(world, 0, rate);
+	CappedRelay relay(server.getPort(), capacity);
+	std::vector<std::unique_ptr<ChunkStreamClient>> clients;
+	for(int i = 0; i < clientCount; i++) {
+		clients.push_back(std::make_unique<ChunkStreamClient>("127.0.0.1", relay.getPort()));
+	}
+
+	// time until every chunk in the first view arrived
+	std::vector<double> firstView(clientCount, -1.0);
+	auto complete = [&](int i) {
+		for(lvec2 pos : visible(camera(i, 0.0, seconds), radius)) {
+			auto chunk = world.loadChunk(pos);
+			if(!clients[i]->has(pos, ChunkCodec::hash(ChunkCodec::encode(std::as_const(*chunk).data())))) {
+				return false;
+			}
+		}
+		return true;
+	};
+
+	int ticks = seconds / dt;
+	for(int tick = 0; tick < ticks; tick++) {
+		double time = tick * dt;
+		for(int i = 0; i < clientCount; i++) {
+			clients[i]->setCamera(camera(i, time, seconds), radius);
+		}
+		// the simulation keeps the chunks around every player loaded, only those are streamed
+		for(int i = 0; i < clientCount; i++) {
+			for(lvec2 pos : visible(camera(i, time, seconds), radius)) {
+				world.loadChunk(pos);
+			}
+		}
+		// someone digs right under the first client
+		if(tick == ticks / 4) {
+			vec2 pos = camera(0, time, seconds);
+			world.loadChunk(lvec2(std::floor(pos.x), std::floor(pos.y)))->at(ivec2(32, 32)) = Tile(Tile::null);
+		}
+
+		server.update(dt);
+		relay.pump(dt);
+		for(auto &client : clients) {
+			client->update(dt);
+		}
+		relay.pump(0.0f);
+
+		for(int i = 0; i < clientCount; i++) {
+			if(firstView[i] < 0.0 && complete(i)) {
+				firstView[i] = time + dt;
+			}
+		}
+	}
+	// the clients are back where they started, the last chunks of the way back still have to arrive
+	for(int tick = 0; tick < 120; tick++) {
+		server.update(dt);
+		relay.pump(dt);
+		for(auto &client : clients) {
+			client->update(dt);
+		}
+		relay.pump(0.0f);
+	}
+
+	size_t chunks = 0, raw = 0, encoded = 0;
+	std::array<Tile, Chunk::size * Chunk::size> tiles;
+	for(int i = 0; i < clientCount; i++) {
+		for(lvec2 pos : visible(camera(i, seconds, seconds), radius)) {
+			auto chunk = world.loadChunk(pos);
+			std::span<const Tile> expected = std::as_const(*chunk).data();
+			if(!clients[i]->get(pos, tiles) || !std::equal(expected.begin(), expected.end(), tiles.begin())) {
+				spdlog::error("client {} has a wrong chunk at {} {}", i, pos.x, pos.y);
+				return 1;
+			}
+		}
+		if(firstView[i] < 0.0) {
+			spdlog::error("client {} never received its first view", i);
+			return 1;
+		}
+	}
+	for(auto &[pos, chunk] : world.chunks()) {
+		chunks++;
+		raw += std::as_const(*chunk).data().size_bytes();
+		encoded += ChunkCodec::encode(std::as_const(*chunk).data()).size();
+	}
+
+	double average = 0.0;
+	for(double t : firstView) {
+		average += t / clientCount;
+	}
+	spdlog::info("clients: {}, radius: {}, rate: {:.0f} kB/s, link: {:.0f} kB/s", clientCount, radius, rate / 1e3, capacity / 1e3);
+	spdlog::info("encoding: {} chunks, {:.1f} kB raw, {:.1f} kB encoded ({:.1f}x)", chunks, raw / 1e3, encoded / 1e3, double(raw) / encoded);
+	spdlog::info("first view complete after {:.2f} s on average", average);
+	spdlog::info("sent: {:.1f} kB, {} chunks as data, {} by reference, {} slices resent, {} datagrams dropped by the link",
+		server.getBytesSent() / 1e3, server.getChunksSent(), server.getChunksReferenced(), server.getSlicesResent(), relay.getDropped());
+	return 0;
+}
@@ -0,0 +1,96 @@
+#include <chrono>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/resource.h>
+
+#include <spdlog/spdlog.h>
+
+#include <network/eventloop.hpp>
+
+using namespace network;
+
+class pong : public connection{
+public:
+	using connection::connection;
+
+	size_t onData(std::string_view data) override{
+		size_t consumed = 0, end;
+		while((end = data.find('\n', consumed)) != std::string_view::npos){
+			send("pong\n");
+			consumed = end + 1;
+		}
+		return consumed;
+	}
+};
+
+int main(int argc, char *argv[]){
+	int clients = argc > 1 ? std::stoi(argv[1]) : 10000;
+	double duration = argc > 2 ? std::stod(argv[2]) : 5.0;
+	unsigned threads = argc > 3 ? std::stoi(argv[3]) : 0;
+
+	struct rlimit limit;
+	getrlimit(RLIMIT_NOFILE, &limit);
+	limit.rlim_cur = limit.rlim_max;
+	setrlimit(RLIMIT_NOFILE, &limit);
+
+	eventloop loop([](int handle){
+		return std::unique_ptr<connection>(new pong(handle));
+	}, 0, address::LoopBack, threads);
+	loop.start();
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<int> sockets;
+	struct sockaddr_in server = {AF_INET, htons(loop.getPort()), {htonl(address::LoopBack)}, {}};
+	for(int i = 0; i < clients; i++){
+		int fd = socket(AF_INET, SOCK_STREAM, 0);
+		if(fd < 0 || connect(fd, (struct sockaddr*)&server, sizeof(server)) < 0){
+			spdlog::error("connection {} failed: {}", i, strerror(errno));
+			if(fd >= 0){
+				close(fd);
+			}
+			break;
+		}
+		fcntl(fd, F_SETFL, O_NONBLOCK);
+		sockets.push_back(fd);
+	}
+	double connectTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// every client keeps exactly one request in flight
+	int epoll = epoll_create1(0);
+	if(epoll < 0){
+		spdlog::error("epoll_create1 failed: {}", strerror(errno));
+		return 1;
+	}
+	for(int fd : sockets){
+		struct epoll_event event = {EPOLLIN, {.fd = fd}};
+		epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event);
+		::send(fd, "ping\n", 5, MSG_NOSIGNAL);
+	}
+
+	size_t requests = 0;
+	std::vector<struct epoll_event> events(1024);
+	char buffer[4096];
+	start = std::chrono::steady_clock::now();
+	while(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < duration){
+		int n = epoll_wait(epoll, events.data(), events.size(), 100);
+		for(int i = 0; i < n; i++){
+			ssize_t len = ::recv(events[i].data.fd, buffer, sizeof(buffer), 0);
+			if(len > 0){
+				requests += len / 5;
+				::send(events[i].data.fd, "ping\n", 5, MSG_NOSIGNAL);
+			}
+		}
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	spdlog::info("connections: {} (server: {}), established in {:.2f} s", sockets.size(), loop.connections(), connectTime);
+	spdlog::info("requests: {}, {:.0f} requests/s", requests, requests / elapsed);
+
+	for(int fd : sockets){
+		close(fd);
+	}
+	close(epoll);
+	loop.stop();
+	return sockets.size() == size_t(clients) ? 0 : 1;
+}
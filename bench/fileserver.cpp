@@ -0,0 +1,69 @@
+#include <charconv>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include <network/http.hpp>
+
+using namespace network;
+
+int main(int argc, char *argv[]){
+	std::string root = argc > 1 ? argv[1] : "assets";
+	std::string file = argc > 2 ? argv[2] : "/jetbrains-mono.ttf";
+	int clients = argc > 3 ? std::stoi(argv[3]) : 4;
+	double duration = argc > 4 ? std::stod(argv[4]) : 5.0;
+
+	http::server server(http::serveDirectory(root), 0, address::LoopBack, 1);
+	server.start();
+
+	std::atomic<size_t> responses = 0, bytes = 0;
+	std::atomic<bool> failed = false;
+	std::string request = "GET " + file + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> threads;
+	for(int i = 0; i < clients; i++){
+		threads.emplace_back([&](){
+			tcpsocket s(AF_INET, SOCK_STREAM, 0);
+			if(!s.connect("127.0.0.1", server.getPort())){
+				failed = true;
+				return;
+			}
+			while(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < duration){
+				s.send(request);
+				size_t length = 0;
+				std::optional<std::string_view> line = s.readLine();
+				if(!line || !line->starts_with("HTTP/1.1 200")){
+					failed = true;
+					return;
+				}
+				while((line = s.readLine()) && !line->empty()){
+					if(line->starts_with("Content-Length: ")){
+						std::from_chars(line->data() + 16, line->data() + line->size(), length);
+					}
+				}
+				if(!s.readExact(length)){
+					failed = true;
+					return;
+				}
+				responses++;
+				bytes += length;
+			}
+		});
+	}
+	for(std::thread &t : threads){
+		t.join();
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	server.stop();
+
+	if(failed){
+		spdlog::error("couldn't fetch '{}' from '{}'", file, root);
+		return 1;
+	}
+	spdlog::info("{}: {} responses, {:.0f} requests/s, {:.2f} MB/s", file, size_t(responses), responses / elapsed, bytes / 1e6 / elapsed);
+	spdlog::info("bytes copied into send queues: {} ({:.4f} per body byte)", connection::copiedBytes(), double(connection::copiedBytes()) / bytes);
+	return 0;
+}
@@ -0,0 +1,90 @@
+#include <chrono>
+#include <vector>
+
+#include <sys/epoll.h>
+
+#include <spdlog/spdlog.h>
+
+#include <network/http.hpp>
+
+using namespace network;
+
+int main(int argc, char *argv[]){
+	int clients = argc > 1 ? std::stoi(argv[1]) : 64;
+	int depth = argc > 2 ? std::stoi(argv[2]) : 16;	// pipelined requests per connection
+	double duration = argc > 3 ? std::stod(argv[3]) : 5.0;
+	unsigned threads = argc > 4 ? std::stoi(argv[4]) : 1;
+
+	http::server server([](const http::request &req, http::response &res){
+		res.set("Content-Type", "text/plain");
+		res.body = req.target == "/" ? "Hello World!" : "";
+	}, 0, address::LoopBack, threads);
+	server.start();
+
+	const std::string request = "GET / HTTP/1.1\r\nHost: localhost\r\nUser-Agent: bench_http\r\nAccept: */*\r\n\r\n";
+	std::string batch;
+	for(int i = 0; i < depth; i++){
+		batch += request;
+	}
+
+	http::response expected;
+	expected.set("Content-Type", "text/plain");
+	expected.body = "Hello World!";
+	std::string head;
+	http::serialize(expected, true, head);
+	size_t responseSize = head.size() + expected.body.size();
+
+	struct client{
+		int fd;
+		size_t received;
+	};
+	std::vector<client> connections;
+	int epoll = epoll_create1(0);
+	struct sockaddr_in addr = {AF_INET, htons(server.getPort()), {htonl(address::LoopBack)}, {}};
+	for(int i = 0; i < clients; i++){
+		int fd = socket(AF_INET, SOCK_STREAM, 0);
+		if(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0){
+			spdlog::error("connection {} failed: {}", i, strerror(errno));
+			return 1;
+		}
+		connections.push_back({fd, 0});
+	}
+	for(size_t i = 0; i < connections.size(); i++){
+		struct epoll_event event = {EPOLLIN, {.u64 = i}};
+		epoll_ctl(epoll, EPOLL_CTL_ADD, connections[i].fd, &event);
+		::send(connections[i].fd, batch.data(), batch.size(), MSG_NOSIGNAL);
+	}
+
+	size_t responses = 0;
+	std::vector<char> buffer(64 * 1024);
+	std::vector<struct epoll_event> events(256);
+	auto start = std::chrono::steady_clock::now();
+	while(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < duration){
+		int n = epoll_wait(epoll, events.data(), events.size(), 100);
+		for(int i = 0; i < n; i++){
+			client &c = connections[events[i].data.u64];
+			ssize_t len = ::recv(c.fd, buffer.data(), buffer.size(), 0);
+			if(len <= 0){
+				spdlog::error("server closed a connection");
+				return 1;
+			}
+			c.received += len;
+			if(c.received == responseSize * depth){
+				responses += depth;
+				c.received = 0;
+				::send(c.fd, batch.data(), batch.size(), MSG_NOSIGNAL);
+			}
+		}
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	spdlog::info("connections: {}, pipeline depth: {}, loop threads: {}", clients, depth, threads);
+	spdlog::info("responses: {}, {:.0f} requests/s", responses, responses / elapsed);
+
+	for(client &c : connections){
+		close(c.fd);
+	}
+	close(epoll);
+	server.stop();
+	return 0;
+}
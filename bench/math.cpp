@@ -0,0 +1,391 @@
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <spdlog/fmt/fmt.h>
+
+#include <math/affine.hpp>
+#include <math/math.hpp>
+#include <math/matrix.hpp>
+#include <math/noise.hpp>
+#include <math/quaternion.hpp>
+#include <math/transform.hpp>
+#include <math/vector.hpp>
+
+using namespace math;
+
+// results are summed into here, so the compiler can't drop the work
+static volatile double sink;
+
+struct Result {
+	std::string name;
+	double ns;	// per op, the fastest of the repetitions
+	size_t ops;	// per repetition
+};
+
+class Suite {
+public:
+	Suite(double minSeconds, std::string filter) : minSeconds(minSeconds), filter(std::move(filter)) {}
+
+	// body does ops operations and returns something depending on all of them
+	void add(const std::string &name, size_t ops, const std::function<double()> &body) {
+		if(name.find(filter) == std::string::npos) {
+			return;
+		}
+		using clock = std::chrono::steady_clock;
+		sink = sink + body();	// warm up
+
+		double best = 1e300, spent = 0.0;
+		for(int repetition = 0; repetition < 5 || spent < minSeconds; repetition++) {
+			auto start = clock::now();
+			sink = sink + body();
+			double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+			best = std::min(best, ns / ops);
+			spent += ns / 1e9;
+		}
+		results.push_back({name, best, ops});
+	}
+
+	std::string json() const {
+		std::string out = "{\n\t\"benchmarks\": [";
+		for(size_t i = 0; i < results.size(); i++) {
+			out += fmt::format("{}\n\t\t{{\"name\": \"{}\", \"ns_per_op\": {:.3f}, \"ops\": {}}}", i ? "," : "", results[i].name, results[i].ns, results[i].ops);
+		}
+		return out + "\n\t]\n}\n";
+	}
+
+private:
+	double minSeconds;
+	std::string filter;
+	std::vector<Result> results;
+};
+
+template<typename T>
+static std::vector<T> randomVectors(std::mt19937 &rng, size_t count) {
+	std::uniform_real_distribution<float> value(-100.0f, 100.0f);
+	std::vector<T> out(count);
+	for(T &v : out) {
+		for(size_t i = 0; i < sizeof(T) / sizeof(float); i++) {
+			(&v.x)[i] = value(rng);
+		}
+	}
+	return out;
+}
+
+static mat4 randomMatrix(std::mt19937 &rng) {
+	std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+	return mat4().translate(vec3(value(rng), value(rng), value(rng)) * 100.0f).rotate(vec3(value(rng), value(rng), value(rng)) * 3.0f).scale(vec3(1.5f + value(rng)));
+}
+
+int main(int argc, char *argv[]) {
+	double minSeconds = argc > 1 ? std::stod(argv[1]) : 0.25;	// per benchmark
+	Suite suite(minSeconds, argc > 2 ? argv[2] : "");	// only names containing the filter run
+
+	const size_t count = 4096;
+	std::mt19937 rng(1337);
+	std::vector<vec2> v2a = randomVectors<vec2>(rng, count);
+	std::vector<vec3> v3a = randomVectors<vec3>(rng, count), v3b = randomVectors<vec3>(rng, count);
+	std::vector<vec4> v4a = randomVectors<vec4>(rng, count), v4b = randomVectors<vec4>(rng, count);
+	std::vector<mat4> matrices(256);
+	for(mat4 &m : matrices) {
+		m = randomMatrix(rng);
+	}
+	std::vector<quaternion> quaternions(256);
+	for(quaternion &q : quaternions) {
+		q = quaternion(std::uniform_real_distribution<float>(0.0f, 6.0f)(rng), normalize(randomVectors<vec3>(rng, 1)[0]));
+	}
+	std::vector<vec4> out(count);
+	std::vector<mat4> outMatrices(count);	// whole results are stored, so no part of them can be skipped
+
+	// vectors, one op per element
+	suite.add("vec2 add", count, [&] {
+		vec2 sum;
+		for(size_t i = 0; i < count; i++) {
+			sum += v2a[i] + v2a[count - 1 - i];
+		}
+		return sum.x + sum.y;
+	});
+	suite.add("vec3 add", count, [&] {
+		vec3 sum;
+		for(size_t i = 0; i < count; i++) {
+			sum += v3a[i] + v3b[i];
+		}
+		return sum.x + sum.y + sum.z;
+	});
+	suite.add("vec3 dot", count, [&] {
+		float sum = 0.0f;
+		for(size_t i = 0; i < count; i++) {
+			sum += dot(v3a[i], v3b[i]);
+		}
+		return sum;
+	});
+	suite.add("vec3 cross", count, [&] {
+		vec3 sum;
+		for(size_t i = 0; i < count; i++) {
+			sum += cross(v3a[i], v3b[i]);
+		}
+		return sum.x + sum.y + sum.z;
+	});
+	suite.add("vec3 normalize", count, [&] {
+		vec3 sum;
+		for(size_t i = 0; i < count; i++) {
+			sum += normalize(v3a[i]);
+		}
+		return sum.x + sum.y + sum.z;
+	});
+	suite.add("vec4 mul add", count, [&] {
+		vec4 sum;
+		for(size_t i = 0; i < count; i++) {
+			sum += v4a[i] * v4b[i] + v4a[i];
+		}
+		return sum.x + sum.y + sum.z + sum.w;
+	});
+	suite.add("vec4 dot", count, [&] {
+		float sum = 0.0f;
+		for(size_t i = 0; i < count; i++) {
+			sum += dot(v4a[i], v4b[i]);
+		}
+		return sum;
+	});
+
+	// matrices, one op per matrix
+	suite.add("mat4 multiply", matrices.size(), [&] {
+		mat4 product;
+		for(const mat4 &m : matrices) {
+			product = product * m;
+			product[3] = vec4(0, 0, 0, 1);	// keeps the values bounded
+		}
+		return product[0][0] + product[1][1];
+	});
+	suite.add("mat4 inverse", matrices.size(), [&] {
+		for(size_t i = 0; i < matrices.size(); i++) {
+			outMatrices[i] = matrices[i].inverse();
+		}
+		return outMatrices[1][3][0];
+	});
+	suite.add("mat4 affine inverse", matrices.size(), [&] {
+		for(size_t i = 0; i < matrices.size(); i++) {
+			outMatrices[i] = matrices[i].affineInverse();
+		}
+		return outMatrices[1][3][0];
+	});
+	suite.add("mat4 transpose", matrices.size(), [&] {
+		for(size_t i = 0; i < matrices.size(); i++) {
+			outMatrices[i] = matrices[i].transpose();
+		}
+		return outMatrices[1][3][0];
+	});
+	suite.add("mat4 translate rotate scale", count, [&] {
+		for(size_t i = 0; i < count; i++) {
+			outMatrices[i] = mat4().translate(v3a[i]).rotate(v3b[i]).scale(v3a[count - 1 - i]);
+		}
+		return outMatrices[1][3][0];
+	});
+
+	// the 2d entity transforms, one op per transform
+	std::vector<affine2> affines(matrices.size()), outAffines(count);
+	for(size_t i = 0; i < affines.size(); i++) {
+		affines[i] = affine2().translate(v2a[i]).rotate(v3a[i].x).scale(vec2(1.5f) + v2a[count - 1 - i] * 0.01f);
+	}
+	suite.add("affine2 translate rotate scale", count, [&] {
+		for(size_t i = 0; i < count; i++) {
+			outAffines[i] = affine2().translate(v2a[i]).rotate(v3b[i].z).scale(v2a[count - 1 - i]);
+		}
+		return outAffines[1].t.x;
+	});
+	suite.add("affine2 multiply", affines.size(), [&] {
+		affine2 product;
+		for(const affine2 &a : affines) {
+			product = product * a;
+			product.t = vec2(0);	// keeps the values bounded
+		}
+		return product.x.x + product.y.y;
+	});
+	suite.add("affine2 inverse", affines.size(), [&] {
+		for(size_t i = 0; i < affines.size(); i++) {
+			outAffines[i] = affines[i].inverse();
+		}
+		return outAffines[1].t.x;
+	});
+	suite.add("affine2 * vec2", count, [&] {
+		vec2 sum;
+		for(size_t i = 0; i < count; i++) {
+			sum += affines[i % affines.size()] * v2a[i];
+		}
+		return sum.x + sum.y;
+	});
+	suite.add("mat4 from quaternion", quaternions.size(), [&] {
+		for(size_t i = 0; i < quaternions.size(); i++) {
+			outMatrices[i] = mat4(quaternions[i]);
+		}
+		return outMatrices[1][0][1];
+	});
+	suite.add("quaternion multiply", quaternions.size(), [&] {
+		quaternion product;
+		for(const quaternion &q : quaternions) {
+			product = product * q;
+		}
+		return product.w + product.x;
+	});
+
+	// transforms, one op per point
+	suite.add("mat4 * vec4", count, [&] {
+		vec4 sum;
+		for(size_t i = 0; i < count; i++) {
+			sum += matrices[i % matrices.size()] * v4a[i];
+		}
+		return sum.x + sum.y + sum.z + sum.w;
+	});
+	suite.add("mat4 * vec4 batch", count, [&] {
+		const mat4 &m = matrices[0];
+		for(size_t i = 0; i < count; i++) {
+			out[i] = m * v4a[i];
+		}
+		return out[count / 2].x;
+	});
+
+	// transform_points, one op per point
+	std::vector<vec2> out2(count);
+	std::vector<float> soa[8];
+	for(std::vector<float> &component : soa) {
+		component.resize(count);
+	}
+	for(size_t i = 0; i < count; i++) {
+		soa[0][i] = v4a[i].x, soa[1][i] = v4a[i].y, soa[2][i] = v4a[i].z, soa[3][i] = v4a[i].w;
+	}
+	suite.add("transform_points vec4", count, [&] {
+		transform_points(v4a, matrices[0], out);
+		return out[count / 2].x;
+	});
+	suite.add("transform_points vec2 affine", count, [&] {
+		transform_points(v2a, matrices[0], out2);
+		return out2[count / 2].x;
+	});
+	suite.add("transform_points soa vec4", count, [&] {
+		transform_points(soa[0], soa[1], soa[2], soa[3], matrices[0], soa[4], soa[5], soa[6], soa[7]);
+		return soa[4][count / 2];
+	});
+	suite.add("transform_points soa vec2 affine", count, [&] {
+		transform_points(soa[0], soa[1], matrices[0], soa[4], soa[5]);
+		return soa[4][count / 2];
+	});
+	const size_t large = 1 << 20;
+	std::vector<vec4> largeIn(large), largeOut(large);
+	for(size_t i = 0; i < large; i++) {
+		largeIn[i] = v4a[i % count];
+	}
+	suite.add("transform_points vec4 large", large, [&] {
+		transform_points(largeIn, matrices[0], largeOut);
+		return largeOut[large / 2].x;
+	});
+	suite.add("transform_points vec4 large parallel", large, [&] {
+		transform_points(largeIn, matrices[0], largeOut, true);
+		return largeOut[large / 2].x;
+	});
+
+	// noise, one op per sample
+	const size_t samples = 1024;
+	perlin perlinNoise(1337);
+	simplex simplexNoise(1337);
+	suite.add("perlin 2d", samples, [&] {
+		double sum = 0.0;
+		for(size_t i = 0; i < samples; i++) {
+			sum += perlinNoise.noise(v2a[i].x * 0.05, v2a[i].y * 0.05);
+		}
+		return sum;
+	});
+	suite.add("perlin 3d", samples, [&] {
+		double sum = 0.0;
+		for(size_t i = 0; i < samples; i++) {
+			sum += perlinNoise.noise(v3a[i].x * 0.05, v3a[i].y * 0.05, v3a[i].z * 0.05);
+		}
+		return sum;
+	});
+	suite.add("simplex 2d", samples, [&] {
+		double sum = 0.0;
+		for(size_t i = 0; i < samples; i++) {
+			sum += simplexNoise.noise2d(dvec2(v2a[i]) * 0.05);
+		}
+		return sum;
+	});
+	suite.add("simplex 3d", samples, [&] {
+		double sum = 0.0;
+		for(size_t i = 0; i < samples; i++) {
+			sum += simplexNoise.noise3d(dvec3(v3a[i]) * 0.05);
+		}
+		return sum;
+	});
+	suite.add("simplex 4d", samples, [&] {
+		double sum = 0.0;
+		for(size_t i = 0; i < samples; i++) {
+			sum += simplexNoise.noise4d(dvec4(v4a[i]) * 0.05);
+		}
+		return sum;
+	});
+	std::vector<float> noiseOut(samples);
+	suite.add("perlin 2d batch", samples, [&] {
+		perlinNoise.noise(std::span(v2a).first(samples), noiseOut);
+		return noiseOut[samples / 2];
+	});
+	suite.add("perlin 3d batch", samples, [&] {
+		perlinNoise.noise(std::span(v3a).first(samples), noiseOut);
+		return noiseOut[samples / 2];
+	});
+	suite.add("simplex 2d batch", samples, [&] {
+		simplexNoise.noise2d(std::span(v2a).first(samples), noiseOut);
+		return noiseOut[samples / 2];
+	});
+
+	// noise over a grid, like the generator fills a chunk
+	const size_t grid = 64;
+	std::vector<double> field(grid * grid);
+	suite.add("perlin 2d grid", grid * grid, [&] {
+		for(size_t y = 0; y < grid; y++) {
+			for(size_t x = 0; x < grid; x++) {
+				field[y * grid + x] = perlinNoise.noise(x * 0.05, y * 0.05);
+			}
+		}
+		return field[grid + 1];
+	});
+	suite.add("simplex 2d grid", grid * grid, [&] {
+		for(size_t y = 0; y < grid; y++) {
+			for(size_t x = 0; x < grid; x++) {
+				field[y * grid + x] = simplexNoise.noise2d(dvec2(x, y) * 0.05);
+			}
+		}
+		return field[grid + 1];
+	});
+	std::vector<float> fieldf(grid * grid);
+	suite.add("perlin 2d grid batch", grid * grid, [&] {
+		perlinNoise.grid(dvec2(0.0), dvec2(0.05), ivec2(grid), fieldf);
+		return fieldf[grid + 1];
+	});
+	suite.add("simplex 2d grid batch", grid * grid, [&] {
+		simplexNoise.grid2d(dvec2(0.0), dvec2(0.05), ivec2(grid), fieldf);
+		return fieldf[grid + 1];
+	});
+	const size_t volume = 16;
+	std::vector<double> cave(volume * volume * volume);
+	std::vector<float> cavef(cave.size());
+	suite.add("perlin 3d grid", cave.size(), [&] {
+		for(size_t z = 0; z < volume; z++) {
+			for(size_t y = 0; y < volume; y++) {
+				for(size_t x = 0; x < volume; x++) {
+					cave[(z * volume + y) * volume + x] = perlinNoise.noise(x * 0.05, y * 0.05, z * 0.05);
+				}
+			}
+		}
+		return cave[volume + 1];
+	});
+	suite.add("perlin 3d grid batch", cave.size(), [&] {
+		perlinNoise.grid(dvec3(0.0), dvec3(0.05), ivec3(volume), cavef);
+		return cavef[volume + 1];
+	});
+
+	std::cout << suite.json();
+	return 0;
+}
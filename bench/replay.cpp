@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include <inputlog.hpp>
+#include <world.hpp>
+
+#include <utils/profiler.hpp>
+
+// plays a session recorded with platformer --record on the simulation only, as the game would without rendering
+int main(int argc, char *argv[]) {
+	if(argc < 2) {
+		spdlog::error("usage: {} log [dt]", argv[0]);
+		return 1;
+	}
+	InputLog log;
+	try {
+		log = InputLog::load(argv[1]);
+	}
+	catch(const std::runtime_error &e) {
+		spdlog::error(e.what());
+		return 1;
+	}
+	float fixedDt = argc > 2 ? std::stof(argv[2]) : 0.0f;	// replaces the recorded dt if set
+
+	std::srand(log.getSeed());
+	Camera cam(vec3(0, 0, -128), vec3(), vec2(1080, 720), 90, 2, 256);
+	auto player = std::make_shared<Player>(&cam, std::shared_ptr<TiledTexture>());
+	DynamicWorld<> world;
+	world.setMainEntity(player);
+	world.initGenerator(vec2(1.0f / 32.0f));	// the tileset of the game
+	buildStartArea(world);
+
+	std::vector<double> samples;
+	double elapsed = 0.0;
+	for(const InputLog::Frame &frame : log.getFrames()) {
+		float dt = fixedDt > 0.0f ? fixedDt : frame.dt;
+		elapsed += dt;
+
+		auto start = std::chrono::steady_clock::now();
+		photon::profiler::frame();
+		frame.apply(*player, world);
+		world.update(elapsed, dt);
+		cam.update();
+		samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+	if(samples.empty()) {
+		spdlog::error("{} has no frames", argv[1]);
+		return 1;
+	}
+
+	std::vector<double> sorted = samples;
+	std::sort(sorted.begin(), sorted.end());
+	auto percentile = [&](double p) {
+		return sorted[std::min(size_t(p * sorted.size()), sorted.size() - 1)];
+	};
+	double total = 0.0;
+	for(double sample : sorted) {
+		total += sample;
+	}
+	// the end state shows whether the replay diverged, it has to match between runs
+	std::cout << fmt::format("{{\n\t\"seed\": {}, \"frames\": {}, \"simulated_s\": {:.3f},\n\t\"tick\": {{\"total_ms\": {:.3f}, \"mean_ms\": {:.4f}, \"p50_ms\": {:.4f}, \"p90_ms\": {:.4f}, \"p99_ms\": {:.4f}, \"max_ms\": {:.4f}}},\n\t\"end\": {{\"offset\": [{}, {}], \"pos\": [{:.3f}, {:.3f}], \"chunks\": {}}}\n}}\n",
+		log.getSeed(), samples.size(), elapsed, total, total / sorted.size(), percentile(0.5), percentile(0.9), percentile(0.99), sorted.back(),
+		world.offset().x, world.offset().y, player->pos.x, player->pos.y, world.chunks().size());
+	return 0;
+}
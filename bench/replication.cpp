@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+
+#include <spdlog/spdlog.h>
+
+#include <replication.hpp>
+#include <rigidbody.hpp>
+#include <world.hpp>
+
+class BenchWorld : public WorldContainer {
+protected:
+	std::shared_ptr<Chunk> loadChunk(lvec2 pos) override {
+		return getChunkAbsolute(pos);
+	}
+};
+
+// forwards datagrams between the clients and the server, every client gets its own port towards the server
+class LossyRelay {
+public:
+	LossyRelay(unsigned short serverPort, double loss) : server(*network::udpsocket::resolve("127.0.0.1", serverPort)), loss(loss) {}
+
+	unsigned short getPort() const {
+		return front.getPort();
+	}
+
+	void pump() {
+		struct sockaddr_in peer;
+		int len;
+		while((len = front.recvFrom(buffer, peer)) >= 0) {
+			auto it = std::find_if(routes.begin(), routes.end(), [&](const Route &route) {
+				return route.client.sin_port == peer.sin_port;
+			});
+			if(it == routes.end()) {
+				it = routes.insert(routes.end(), {peer, std::make_unique<network::udpsocket>(network::address::LoopBack)});
+			}
+			forward(*it->back, len, server);
+		}
+		for(Route &route : routes) {
+			while((len = route.back->recvFrom(buffer, peer)) >= 0) {
+				forward(front, len, route.client);
+			}
+		}
+	}
+
+private:
+	struct Route {
+		struct sockaddr_in client;
+		std::unique_ptr<network::udpsocket> back;
+	};
+
+	void forward(network::udpsocket &socket, int len, const struct sockaddr_in &to) {
+		if(std::uniform_real_distribution<double>(0.0, 1.0)(rng) >= loss) {
+			socket.sendTo(std::span(buffer.data(), len), to);
+		}
+	}
+
+	network::udpsocket front = network::udpsocket(network::address::LoopBack);
+	struct sockaddr_in server;
+	std::vector<Route> routes;
+	std::array<uint8_t, 2048> buffer;
+	double loss;
+	std::mt19937 rng = std::mt19937(1337);
+};
+
+// half of the entities circle, the other half walk back and forth, both at walking speed
+static void motion(int i, double time, vec2 &pos, vec2 &speed) {
+	vec2 center = vec2(i % 20, i / 20) * 96.0f;
+	if(i % 2 == 0) {
+		double w = 64.0 / 40.0, phase = i * 0.37;
+		pos = center + vec2(std::cos(w * time + phase), std::sin(w * time + phase)) * 40.0f;
+		speed = vec2(-std::sin(w * time + phase), std::cos(w * time + phase)) * 64.0f;
+	}
+	else {
+		double period = 4.0, t = std::fmod(time + i * 0.21, period);
+		bool back = t >= period / 2;
+		pos = center + vec2((back ? period - t : t) * 64.0, 0.0);
+		speed = vec2(back ? -64.0f : 64.0f, 0.0f);
+	}
+}
+
+int main(int argc, char *argv[]) {
+	int entities = argc > 1 ? std::stoi(argv[1]) : 200;
+	int clientCount = argc > 2 ? std::stoi(argv[2]) : 4;
+	double seconds = argc > 3 ? std::stod(argv[3]) : 10.0;
+	double loss = argc > 4 ? std::stod(argv[4]) : 0.05;
+	const uint8_t tickRate = 60;
+	const float dt = 1.0f / tickRate;
+
+	BenchWorld world;
+	std::vector<std::shared_ptr<RigidBody>> bodies;
+	for(int i = 0; i < entities; i++) {
+		bodies.push_back(world.createEntity<RigidBody>(std::shared_ptr<TiledTexture>()));
+	}
+
+	ReplicationServer server(world, 0, tickRate);
+	LossyRelay relay(server.getPort(), loss);
+	std::vector<std::unique_ptr<ReplicationClient>> clients;
+	for(int i = 0; i < clientCount; i++) {
+		clients.push_back(std::make_unique<ReplicationClient>("127.0.0.1", relay.getPort(), 0.1f));
+	}
+
+	size_t firstSnapshot = 0, measuredBytes = 0, samples = 0;
+	double errorSum = 0.0, errorMax = 0.0, serverTime = 0.0;
+	int ticks = seconds * tickRate, warmup = tickRate;
+	for(int tick = 0; tick < ticks; tick++) {
+		for(int i = 0; i < entities; i++) {
+			motion(i, tick * dt, bodies[i]->pos, bodies[i]->speed);
+		}
+
+		size_t sent = server.getBytesSent();
+		auto start = std::chrono::steady_clock::now();
+		server.tick();
+		if(tick >= warmup) {
+			serverTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			measuredBytes += server.getBytesSent() - sent;
+		}
+		if(!firstSnapshot && server.getBytesSent() > sent) {
+			firstSnapshot = (server.getBytesSent() - sent) / server.getClientCount();
+		}
+
+		relay.pump();
+		for(auto &client : clients) {
+			client->update(dt);
+		}
+		relay.pump();
+
+		if(tick < warmup) {
+			continue;
+		}
+		// server ticks count from 1, tick n holds the motion at (n - 1) * dt
+		for(auto &client : clients) {
+			const std::vector<EntityState> &states = client->getStates();
+			double time = client->getTime() - 1.0 / tickRate;
+			for(size_t i = 0; i < states.size(); i++) {
+				vec2 pos, speed;
+				motion(i, time, pos, speed);
+				double error = length(states[i].pos - pos);
+				errorSum += error;
+				errorMax = std::max(errorMax, error);
+				samples++;
+			}
+		}
+	}
+
+	if(server.getClientCount() != size_t(clientCount) || samples == 0) {
+		spdlog::error("only {} of {} clients synchronized", server.getClientCount(), clientCount);
+		return 1;
+	}
+
+	double measured = (ticks - warmup) / double(tickRate);
+	double perClient = measuredBytes / measured / clientCount;
+	spdlog::info("entities: {}, clients: {}, loss: {:.0f}%, tick rate: {}", entities, clientCount, loss * 100, tickRate);
+	spdlog::info("first snapshot: {} bytes, then {:.0f} bytes per tick", firstSnapshot, perClient / tickRate);
+	spdlog::info("per client: {:.1f} kB/s ({:.0f} kbit/s), {:.2f} bits per entity and tick", perClient / 1e3, perClient * 8 / 1e3, perClient * 8 / tickRate / entities);
+	spdlog::info("server: {:.1f} us per tick", serverTime / (ticks - warmup) * 1e6);
+	spdlog::info("interpolation error: {:.3f} px average, {:.3f} px max", errorSum / samples, errorMax);
+	return 0;
+}
@@ -0,0 +1,80 @@
+#include <chrono>
+#include <filesystem>
+#include <random>
+
+#include <spdlog/spdlog.h>
+
+#include <sqliteworld.hpp>
+
+static double seconds(std::chrono::steady_clock::duration duration) {
+	return std::chrono::duration<double>(duration).count();
+}
+
+int main(int argc, char *argv[]) {
+	int count = argc > 1 ? std::stoi(argv[1]) : 16384;
+	int blobSize = argc > 2 ? std::stoi(argv[2]) : 1024;
+	int batch = argc > 3 ? std::stoi(argv[3]) : 64;	// chunks saved per tick
+	std::string path = argc > 4 ? argv[4] : "bench_world.db";
+	std::filesystem::remove(path);
+	std::filesystem::remove(path + "-wal");
+	std::filesystem::remove(path + "-shm");
+
+	std::mt19937 rng(1337);
+	std::vector<uint8_t> blob(blobSize);
+	for(uint8_t &byte : blob) {
+		byte = rng();
+	}
+	auto position = [](int i) {
+		return lvec2(i % 256 - 128, i / 256 - 128);
+	};
+	size_t bytes = size_t(count) * blobSize;
+
+	auto start = std::chrono::steady_clock::now();
+	{
+		SqliteWorldDB db(path);
+		for(int i = 0; i < count; i++) {
+			db.write(position(i), std::vector<uint8_t>(blob));
+			if((i + 1) % batch == 0) {
+				db.flush();
+			}
+		}
+		db.flush();
+	}
+	double writeTime = seconds(std::chrono::steady_clock::now() - start);
+
+	start = std::chrono::steady_clock::now();
+	size_t found = 0;
+	{
+		SqliteWorldDB db(path);
+		std::vector<uint8_t> data;
+		for(int i = 0; i < count; i++) {
+			found += db.read(position(i), data) && data.size() == blob.size();
+		}
+	}
+	double readTime = seconds(std::chrono::steady_clock::now() - start);
+
+	start = std::chrono::steady_clock::now();
+	size_t scanned = 0;
+	{
+		SqliteWorldDB db(path);
+		db.scanChunks(lvec2(-128), lvec2(127), [&](lvec2, std::span<const uint8_t> data) {
+			scanned += data.size() == blob.size();
+		});
+	}
+	double scanTime = seconds(std::chrono::steady_clock::now() - start);
+
+	if(found != size_t(count) || scanned != size_t(count)) {
+		spdlog::error("read {} and scanned {} of {} blobs", found, scanned, count);
+		return 1;
+	}
+
+	spdlog::info("blobs: {}, size: {} B, batch: {}, file: {:.2f} MB", count, blobSize, batch, std::filesystem::file_size(path) / 1e6);
+	spdlog::info("write: {:.0f} blobs/s, {:.2f} MB/s", count / writeTime, bytes / 1e6 / writeTime);
+	spdlog::info("read: {:.0f} blobs/s, {:.2f} MB/s", count / readTime, bytes / 1e6 / readTime);
+	spdlog::info("scan: {:.0f} blobs/s, {:.2f} MB/s", count / scanTime, bytes / 1e6 / scanTime);
+
+	std::filesystem::remove(path);
+	std::filesystem::remove(path + "-wal");
+	std::filesystem::remove(path + "-shm");
+	return 0;
+}
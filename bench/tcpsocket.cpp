@@ -0,0 +1,88 @@
+#include <chrono>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+#include <network/tcpsocket.hpp>
+
+using namespace network;
+
+// reproduces the old recvLine, which received one byte per syscall
+class bytesocket : public tcpsocket{
+public:
+	using tcpsocket::tcpsocket;
+protected:
+	int read(char *data, size_t) override{
+		return tcpsocket::read(data, 1);
+	}
+};
+
+static const std::string request =
+	"GET /api/world/chunk?x=12&y=-3 HTTP/1.1\r\n"
+	"Host: localhost:8080\r\n"
+	"User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 Firefox/118.0\r\n"
+	"Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8\r\n"
+	"Accept-Language: en-US,en;q=0.5\r\n"
+	"Accept-Encoding: gzip, deflate, br\r\n"
+	"Connection: keep-alive\r\n"
+	"Cookie: session=6f1c2b0e9d8a4c7b; theme=dark; lang=en\r\n"
+	"Upgrade-Insecure-Requests: 1\r\n"
+	"Sec-Fetch-Dest: document\r\n"
+	"Sec-Fetch-Mode: navigate\r\n"
+	"Sec-Fetch-Site: none\r\n"
+	"\r\n";
+
+template<typename socket_t>
+static void run(const char *name, int requests){
+	int listener = socket(AF_INET, SOCK_STREAM, 0);
+	struct sockaddr_in server = {AF_INET, 0, {htonl(address::LoopBack)}, {}};
+	socklen_t len = sizeof(server);
+	bind(listener, (struct sockaddr*)&server, sizeof(server));
+	listen(listener, 1);
+	getsockname(listener, (struct sockaddr*)&server, &len);
+
+	std::thread sender([&](){
+		int client = accept(listener, nullptr, nullptr);
+		std::string data;
+		for(int i = 0; i < requests; i++){
+			data += request;
+		}
+		for(size_t sent = 0; sent < data.size();){
+			ssize_t n = send(client, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+			if(n <= 0){
+				break;
+			}
+			sent += n;
+		}
+		shutdown(client, SHUT_WR);
+		close(client);
+	});
+
+	socket_t s(AF_INET, SOCK_STREAM, 0);
+	s.connect("127.0.0.1", ntohs(server.sin_port));
+
+	auto start = std::chrono::steady_clock::now();
+	int parsed = 0;
+	size_t bytes = 0;
+	while(parsed < requests){
+		std::string line = s.recvLine();
+		bytes += line.size();
+		if(line.empty()){
+			parsed++;
+		}
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	sender.join();
+	close(listener);
+
+	spdlog::info("{}: {:.3f} recv calls/request, {:.0f} requests/s, {:.2f} MB/s",
+		name, double(s.getRecvCalls()) / requests, requests / elapsed, bytes / 1e6 / elapsed);
+}
+
+int main(int argc, char *argv[]){
+	int requests = argc > 1 ? std::stoi(argv[1]) : 20000;
+	run<bytesocket>("one byte per recv", requests);
+	run<tcpsocket>("buffered", requests);
+	return 0;
+}
@@ -0,0 +1,126 @@
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include <network/tlssocket.hpp>
+
+using namespace network;
+
+// every message is a 8 byte length followed by that many bytes, the server acknowledges each with one byte
+class sink : public tlsconnection{
+public:
+	sink(int handle, tlscontext &context) : tlsconnection(handle, context){}
+
+	size_t onDecrypted(std::string_view data) override{
+		size_t consumed = 0;
+		while(consumed < data.size()){
+			if(remaining == 0){
+				if(data.size() - consumed < sizeof(remaining)){
+					break;
+				}
+				memcpy(&remaining, data.data() + consumed, sizeof(remaining));
+				consumed += sizeof(remaining);
+				remaining++;	// +1 so an empty message is pending too
+			}
+			size_t len = std::min<size_t>(remaining - 1, data.size() - consumed);
+			consumed += len;
+			remaining -= len;
+			if(remaining == 1){
+				remaining = 0;
+				send("k");
+			}
+		}
+		return consumed;
+	}
+
+private:
+	uint64_t remaining = 0;
+};
+
+static bool message(tlssocket &socket, uint64_t size, std::string_view chunk){
+	if(!socket.send(std::string_view(reinterpret_cast<const char*>(&size), sizeof(size)))){
+		return false;
+	}
+	while(size > 0){
+		std::string_view part = chunk.substr(0, std::min<uint64_t>(size, chunk.size()));
+		if(!socket.send(part)){
+			return false;
+		}
+		size -= part.size();
+	}
+	return socket.readExact(1).has_value();
+}
+
+static std::string readFile(const std::string &path){
+	std::ifstream file(path, std::ios::binary);
+	std::stringstream content;
+	content << file.rdbuf();
+	return content.str();
+}
+
+static double handshakes(tlscontext &client, unsigned short port, int count){
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < count; i++){
+		tlssocket socket(client);
+		if(!socket.connect("127.0.0.1", port) || !message(socket, 0, {})){
+			spdlog::error("handshake {} failed", i);
+			return 0;
+		}
+	}
+	return count / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]){
+	std::string certificate = argc > 2 ? argv[1] : "/tmp/bench_tls_cert.pem";
+	std::string key = argc > 2 ? argv[2] : "/tmp/bench_tls_key.pem";
+	int count = argc > 3 ? std::stoi(argv[3]) : 200;
+	size_t megabytes = argc > 4 ? std::stoul(argv[4]) : 256;
+
+	if(argc <= 2 && std::system(("openssl req -x509 -newkey rsa:2048 -nodes -days 1 -subj /CN=localhost -keyout " + key + " -out " + certificate + " 2> /dev/null").c_str()) != 0){
+		spdlog::error("usage: bench_tls <certificate.pem> <key.pem> [handshakes] [megabytes], or have openssl generate a self-signed pair");
+		return 1;
+	}
+
+	// sessions are only resumed with TLS 1.2, so one TLS 1.3 server and two TLS 1.2 servers, with and without session cache
+	tlscontext tls13(readFile(certificate), readFile(key)), cached(readFile(certificate), readFile(key), tlscontext::TLS12), uncached(readFile(certificate), readFile(key), tlscontext::TLS12, 0);
+	std::vector<std::unique_ptr<eventloop>> servers;
+	for(tlscontext *context : {&tls13, &cached, &uncached}){
+		servers.emplace_back(new eventloop([context](int handle){
+			return std::unique_ptr<connection>(new sink(handle, *context));
+		}, 0, address::LoopBack, 1));
+		servers.back()->start();
+	}
+
+	tlscontext client;
+	client.insecureSkipVerify();
+	double rate13 = handshakes(client, servers[0]->getPort(), count);
+	double rate12 = handshakes(client, servers[2]->getPort(), count);
+	double rateResumed = handshakes(client, servers[1]->getPort(), count);
+	spdlog::info("TLS 1.3 full handshakes: {:.0f}/s", rate13);
+	spdlog::info("TLS 1.2 full handshakes: {:.0f}/s", rate12);
+	spdlog::info("TLS 1.2 resumed handshakes: {:.0f}/s ({:.1f}x), server resumed {} of {}", rateResumed, rateResumed / rate12, cached.resumedHandshakes(), cached.resumedHandshakes() + cached.fullHandshakes());
+
+	std::string chunk(64 * 1024, 'x');
+	tlssocket socket(client);
+	if(!socket.connect("127.0.0.1", servers[0]->getPort())){
+		spdlog::error("connection failed");
+		return 1;
+	}
+	auto start = std::chrono::steady_clock::now();
+	if(!message(socket, megabytes * 1024 * 1024, chunk)){
+		spdlog::error("bulk transfer failed");
+		return 1;
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	spdlog::info("bulk: {} MB in {:.2f}s, {:.0f} MB/s", megabytes, elapsed, megabytes / elapsed);
+
+	socket.disconnect();
+	for(auto &server : servers){
+		server->stop();
+	}
+	return 0;
+}
@@ -0,0 +1,186 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include <spdlog/spdlog.h>
+
+#include <network/eventloop.hpp>
+
+using namespace network;
+
+class pong : public connection{
+public:
+	using connection::connection;
+
+	size_t onData(std::string_view data) override{
+		size_t consumed = 0, end;
+		while((end = data.find('\n', consumed)) != std::string_view::npos){
+			send("pong\n");
+			consumed = end + 1;
+		}
+		return consumed;
+	}
+};
+
+static double seconds(std::chrono::steady_clock::time_point start){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// every thread connects, exchanges one ping and closes with a reset so no TIME_WAIT piles up
+static size_t churn(unsigned short port, int threads, double duration){
+	std::atomic<size_t> total = 0;
+	std::vector<std::thread> workers;
+	for(int i = 0; i < threads; i++){
+		workers.emplace_back([&](){
+			struct sockaddr_in server = {AF_INET, htons(port), {htonl(address::LoopBack)}, {}};
+			struct linger reset = {1, 0};
+			char buffer[16];
+			size_t count = 0;
+			auto start = std::chrono::steady_clock::now();
+			while(seconds(start) < duration){
+				int fd = socket(AF_INET, SOCK_STREAM, 0);
+				setsockopt(fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+				if(connect(fd, (struct sockaddr*)&server, sizeof(server)) == 0 && ::send(fd, "ping\n", 5, MSG_NOSIGNAL) == 5 && recv(fd, buffer, 5, MSG_WAITALL) == 5){
+					count++;
+				}
+				close(fd);
+			}
+			total += count;
+		});
+	}
+	for(std::thread &t : workers){
+		t.join();
+	}
+	return total;
+}
+
+// persistent connections, every client keeps exactly one request in flight
+static size_t pingpong(unsigned short port, int clients, double duration){
+	struct sockaddr_in server = {AF_INET, htons(port), {htonl(address::LoopBack)}, {}};
+	int epoll = epoll_create1(0);
+	std::vector<int> sockets;
+	for(int i = 0; i < clients; i++){
+		int fd = socket(AF_INET, SOCK_STREAM, 0);
+		if(connect(fd, (struct sockaddr*)&server, sizeof(server)) < 0){
+			close(fd);
+			break;
+		}
+		fcntl(fd, F_SETFL, O_NONBLOCK);
+		struct epoll_event event = {EPOLLIN, {.fd = fd}};
+		epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event);
+		::send(fd, "ping\n", 5, MSG_NOSIGNAL);
+		sockets.push_back(fd);
+	}
+
+	size_t requests = 0;
+	struct epoll_event events[1024];
+	char buffer[4096];
+	auto start = std::chrono::steady_clock::now();
+	while(seconds(start) < duration){
+		int n = epoll_wait(epoll, events, 1024, 100);
+		for(int i = 0; i < n; i++){
+			ssize_t len = recv(events[i].data.fd, buffer, sizeof(buffer), 0);
+			if(len > 0){
+				requests += len / 5;
+				::send(events[i].data.fd, "ping\n", 5, MSG_NOSIGNAL);
+			}
+		}
+	}
+	for(int fd : sockets){
+		close(fd);
+	}
+	close(epoll);
+	return requests;
+}
+
+struct measurement{
+	double rate, cpu, switches;	// per second, server cpu microseconds and context switches per operation
+};
+
+// the load runs in a child process, so the rusage of this process only covers the server
+template<typename Load>
+static measurement measure(Load load, double duration){
+	int channel[2];
+	if(pipe(channel) < 0){
+		return {};
+	}
+	struct rusage before, after;
+	getrusage(RUSAGE_SELF, &before);
+	auto start = std::chrono::steady_clock::now();
+	pid_t child = fork();
+	if(child == 0){
+		size_t count = load();
+		_exit(write(channel[1], &count, sizeof(count)) == sizeof(count) ? 0 : 1);
+	}
+	size_t count = 0;
+	if(child < 0 || read(channel[0], &count, sizeof(count)) != sizeof(count)){
+		spdlog::error("load generator failed");
+	}
+	waitpid(child, nullptr, 0);
+	double elapsed = seconds(start);
+	getrusage(RUSAGE_SELF, &after);
+	close(channel[0]);
+	close(channel[1]);
+
+	auto micros = [](const struct rusage &usage){
+		return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e6 + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+	};
+	double ops = std::max<size_t>(count, 1);
+	return {
+		count / std::min(elapsed, duration),
+		(micros(after) - micros(before)) / ops,
+		(after.ru_nvcsw + after.ru_nivcsw - before.ru_nvcsw - before.ru_nivcsw) / ops,
+	};
+}
+
+int main(int argc, char *argv[]){
+	std::string which = argc > 1 ? argv[1] : "both";
+	int clients = argc > 2 ? std::stoi(argv[2]) : 1000;
+	double duration = argc > 3 ? std::stod(argv[3]) : 3.0;
+	unsigned threads = argc > 4 ? std::stoi(argv[4]) : 1;
+	int churners = argc > 5 ? std::stoi(argv[5]) : 4;
+	if(which != "both" && which != "epoll" && which != "uring"){
+		spdlog::error("usage: bench_uring [both|epoll|uring] [clients] [seconds] [loop threads] [churn threads]");
+		return 1;
+	}
+
+	struct rlimit limit;
+	getrlimit(RLIMIT_NOFILE, &limit);
+	limit.rlim_cur = limit.rlim_max;
+	setrlimit(RLIMIT_NOFILE, &limit);
+
+	std::vector<eventloop::backends> backends;
+	if(which != "uring"){
+		backends.push_back(eventloop::Epoll);
+	}
+	if(which != "epoll"){
+		backends.push_back(eventloop::IoUring);
+	}
+
+	for(eventloop::backends backend : backends){
+		eventloop loop([](int handle){
+			return std::unique_ptr<connection>(new pong(handle));
+		}, 0, address::LoopBack, threads, backend);
+		loop.start();
+		const char *name = loop.getBackend() == eventloop::IoUring ? "io_uring" : "epoll";
+		unsigned short port = loop.getPort();
+
+		measurement c = measure([&](){
+			return churn(port, churners, duration);
+		}, duration);
+		spdlog::info("{:>8} churn: {:>8.0f} connections/s, server {:.2f} us cpu and {:.3f} context switches per connection", name, c.rate, c.cpu, c.switches);
+
+		measurement p = measure([&](){
+			return pingpong(port, clients, duration);
+		}, duration);
+		spdlog::info("{:>8} {} clients: {:>8.0f} requests/s, server {:.2f} us cpu and {:.3f} context switches per request", name, clients, p.rate, p.cpu, p.switches);
+
+		loop.stop();
+	}
+	return 0;
+}
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+
+#include <spdlog/fmt/fmt.h>
+
+#include <chunkgeometry.hpp>
+#include <rigidbody.hpp>
+#include <world.hpp>
+
+#include <utils/profiler.hpp>
+
+// moves at a constant speed, digging a tunnel around itself if it should
+class Walker : public Entity {
+public:
+	Walker(vec2 pos, float speed, int digRadius) : speed(speed), digRadius(digRadius) {
+		this->pos = vec3(pos, 0.0f);
+	}
+
+	void update(float time, float dt, WorldContainer &world) override {
+		pos.x += speed * dt;
+		lvec2 center = world.getTileIndex(pos.xy);
+		for(int y = -digRadius; y <= digRadius && digRadius > 0; y++) {
+			for(int x = -digRadius; x <= digRadius; x++) {
+				// only tiles that change make their chunk dirty
+				if(x * x + y * y <= digRadius * digRadius && std::as_const(world).at(center + lvec2(x, y)).type != Tile::null) {
+					world[center + lvec2(x, y)] = Tile(Tile::null);
+				}
+			}
+		}
+		Entity::update(time, dt, world);
+	}
+
+private:
+	float speed;
+	int digRadius;
+};
+
+struct Phase {
+	const char *name;
+	std::vector<double> samples;	// ms per tick
+};
+
+struct Scenario {
+	std::string name;
+	std::vector<Phase> phases;
+};
+
+// what a renderer would rebuild, the geometry of every chunk that was replaced or whose revision changed
+class Mesher {
+public:
+	void update(const WorldContainer &world) {
+		for(auto &[pos, chunk] : world.chunks()) {
+			Entry &entry = geometries[pos];
+			// a chunk evicted and loaded again starts over with its revision, only the same chunk can be skipped
+			if(entry.built.lock() != chunk || entry.revision != chunk->getRevision()) {
+				entry.built = chunk;
+				entry.revision = chunk->getRevision();
+				entry.geometry.build(std::as_const(*chunk));
+			}
+		}
+		std::erase_if(geometries, [&](const auto &entry) {
+			return !world.chunks().count(entry.first);
+		});
+	}
+
+private:
+	struct Entry {
+		ChunkGeometry geometry;
+		std::weak_ptr<const Chunk> built;
+		unsigned revision = 0;
+	};
+
+	std::map<lvec2, Entry> geometries;
+};
+
+// the scopes of DynamicWorld and ChunkGeometry summed by the profiler, read after every tick
+class Scopes {
+public:
+	Scopes() {
+		photon::profiler::enableTotals(true);
+		read(last);
+	}
+
+	~Scopes() {
+		photon::profiler::enableTotals(false);
+	}
+
+	// ms spent in each scope since the last call
+	std::map<std::string, double> tick() {
+		std::map<std::string, int64_t> current;
+		read(current);
+		std::map<std::string, double> result;
+		for(auto &[name, time] : current) {
+			result[name] = (time - last[name]) / 1e6;
+		}
+		last = std::move(current);
+		return result;
+	}
+
+private:
+	static void read(std::map<std::string, int64_t> &out) {
+		std::array<photon::profiler::total, 64> totals;
+		size_t count = std::min(photon::profiler::totals(totals), totals.size());
+		for(size_t i = 0; i < count; i++) {
+			out[totals[i].name] = totals[i].time;
+		}
+	}
+
+	std::map<std::string, int64_t> last;
+};
+
+static Scenario run(const std::string &name, unsigned seed, int ticks, const std::function<void(DynamicWorld<>&, std::mt19937&)> &setup) {
+	const float dt = 1.0f / 60.0f;
+	std::srand(seed);
+	std::mt19937 rng(seed);
+
+	Scenario scenario = {name, {{"tick", {}}, {"generation", {}}, {"chunk update", {}}, {"meshing", {}}, {"physics", {}}, {"particles", {}}}};
+	Scopes scopes;
+	Mesher mesher;
+	DynamicWorld<> world;
+	world.initGenerator(vec2(1.0f));
+	setup(world, rng);
+
+	for(int tick = 0; tick < ticks; tick++) {
+		auto start = std::chrono::steady_clock::now();
+		world.update(tick * dt, dt);
+		mesher.update(world);
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		auto times = scopes.tick();
+		double generation = times["DynamicWorld::loadChunk"];
+		std::array<double, 6> values = {
+			ms,
+			generation,
+			std::max(times["DynamicWorld::updateChunks"] - generation, 0.0),
+			times["ChunkGeometry::build"],
+			times["DynamicWorld::updateMainEntity"] + times["DynamicWorld::updateEntities"],
+			times["DynamicWorld::updateParticles"],
+		};
+		for(size_t i = 0; i < values.size(); i++) {
+			scenario.phases[i].samples.push_back(values[i]);
+		}
+	}
+	return scenario;
+}
+
+static std::string json(const Phase &phase) {
+	std::vector<double> sorted = phase.samples;
+	std::sort(sorted.begin(), sorted.end());
+	auto percentile = [&](double p) {
+		return sorted[std::min(size_t(p * sorted.size()), sorted.size() - 1)];
+	};
+	double total = 0.0;
+	for(double sample : sorted) {
+		total += sample;
+	}
+	return fmt::format("\"{}\": {{\"total_ms\": {:.3f}, \"mean_ms\": {:.4f}, \"p50_ms\": {:.4f}, \"p90_ms\": {:.4f}, \"p99_ms\": {:.4f}, \"max_ms\": {:.4f}}}",
+		phase.name, total, total / sorted.size(), percentile(0.5), percentile(0.9), percentile(0.99), sorted.back());
+}
+
+int main(int argc, char *argv[]) {
+	unsigned seed = argc > 1 ? std::stoul(argv[1]) : 1;
+	int chunks = argc > 2 ? std::stoi(argv[2]) : 32;	// walked and dug through
+	int ticks = argc > 3 ? std::stoi(argv[3]) : 600;
+	int particles = argc > 4 ? std::stoi(argv[4]) : 100000;
+	int bodies = argc > 5 ? std::stoi(argv[5]) : 10000;
+
+	const float chunkWidth = Chunk::size * Tile::resolution;
+	const float speed = chunks * chunkWidth / (ticks / 60.0f);
+	std::vector<Scenario> scenarios;
+
+	// through the air above the surface, every chunk is generated once
+	scenarios.push_back(run("walk", seed, ticks, [&](DynamicWorld<> &world, std::mt19937&) {
+		world.setMainEntity(std::make_shared<Walker>(vec2(chunkWidth * 0.5f), speed, 0));
+	}));
+
+	// through the ground below the surface, every chunk along the way is modified and meshed again
+	scenarios.push_back(run("dig", seed, ticks, [&](DynamicWorld<> &world, std::mt19937&) {
+		world.setMainEntity(std::make_shared<Walker>(vec2(chunkWidth * 0.5f, -chunkWidth * 0.5f), speed, 3));
+	}));
+
+	// the world keeps its rain going, the particles fall on the surface and slide off it
+	scenarios.push_back(run("rain", seed, ticks, [&](DynamicWorld<> &world, std::mt19937 &rng) {
+		std::uniform_real_distribution<float> x(-4.0f * chunkWidth, 5.0f * chunkWidth), y(0.0f, chunkWidth), fall(-112.0f, -96.0f);
+		ParticleSystem &system = world.getParticleSystem();
+		for(int i = 0; i < particles; i++) {
+			system.spawn(Particle::rain, vec2(x(rng), y(rng)), vec2(0.0f, fall(rng)), vec2(0.0f, -1.0f), vec2(1.0f, 8.0f), 0.0f, 0.0f);
+		}
+	}));
+
+	// dropped onto the surface, most of them come to rest within the run
+	scenarios.push_back(run("bodies", seed, ticks, [&](DynamicWorld<> &world, std::mt19937 &rng) {
+		std::uniform_real_distribution<float> x(-4.0f * chunkWidth, 5.0f * chunkWidth), y(chunkWidth * 0.1f, chunkWidth * 0.9f);
+		for(int i = 0; i < bodies; i++) {
+			auto body = world.createEntity<RigidBody>(std::shared_ptr<TiledTexture>());
+			body->pos = vec2(x(rng), y(rng));
+		}
+	}));
+
+	std::string out = fmt::format("{{\n\t\"seed\": {}, \"chunks\": {}, \"ticks\": {}, \"particles\": {}, \"bodies\": {},\n\t\"scenarios\": {{", seed, chunks, ticks, particles, bodies);
+	for(size_t i = 0; i < scenarios.size(); i++) {
+		out += fmt::format("{}\n\t\t\"{}\": {{", i ? "," : "", scenarios[i].name);
+		for(size_t j = 0; j < scenarios[i].phases.size(); j++) {
+			out += fmt::format("{}\n\t\t\t{}", j ? "," : "", json(scenarios[i].phases[j]));
+		}
+		out += "\n\t\t}";
+	}
+	out += "\n\t}\n}\n";
+	std::cout << out;
+	return 0;
+}
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <random>
+
+#include <spdlog/spdlog.h>
+
+#include <world.hpp>
+#include <worlddb.hpp>
+
+class BenchWorld : public WorldContainer {
+protected:
+	std::shared_ptr<Chunk> loadChunk(lvec2 pos) override {
+		return getChunkAbsolute(pos);
+	}
+};
+
+static double seconds(std::chrono::steady_clock::duration duration) {
+	return std::chrono::duration<double>(duration).count();
+}
+
+int main(int argc, char *argv[]) {
+	int radius = argc > 1 ? std::stoi(argv[1]) : 16;
+	int edits = argc > 2 ? std::stoi(argv[2]) : 64;	// per chunk
+	std::string path = argc > 3 ? argv[3] : "bench_worlddb";
+	std::filesystem::remove_all(path);
+
+	BenchWorld container;
+	WorldGenerator generator(container, vec2(1.0f));
+	std::mt19937 rng(1337);
+
+	std::vector<std::shared_ptr<Chunk>> chunks;
+	for(int64_t y = -radius; y < radius; y++) {
+		for(int64_t x = -radius; x < radius; x++) {
+			auto chunk = generator.getChunk(lvec2(x, y));
+			for(int i = 0; i < edits; i++) {
+				chunk->at(ivec2(rng() % Chunk::size, rng() % Chunk::size)) = Tile(rng() % 8 + 1, rng() % 16);
+			}
+			chunks.push_back(chunk);
+		}
+	}
+	size_t rawBytes = chunks.size() * sizeof(Tile) * Chunk::size * Chunk::size;
+
+	auto start = std::chrono::steady_clock::now();
+	{
+		WorldDB db(path);
+		for(auto &chunk : chunks) {
+			db.save(*chunk, *generator.getChunk(chunk->getPos()));
+		}
+		db.sync();
+	}
+	double saveTime = seconds(std::chrono::steady_clock::now() - start);
+
+	size_t diskBytes = 0;
+	for(auto &entry : std::filesystem::directory_iterator(path)) {
+		diskBytes += entry.file_size();
+	}
+
+	start = std::chrono::steady_clock::now();
+	size_t loaded = 0;
+	{
+		WorldDB db(path);
+		for(auto &chunk : chunks) {
+			auto loadedChunk = generator.getChunk(chunk->getPos());
+			loaded += db.load(*loadedChunk);
+			if(!std::ranges::equal(std::as_const(*loadedChunk).data(), std::as_const(*chunk).data())) {
+				spdlog::error("chunk ({}, {}) doesn't match after loading", chunk->getPos().x, chunk->getPos().y);
+				return 1;
+			}
+		}
+	}
+	double loadTime = seconds(std::chrono::steady_clock::now() - start);
+
+	if(loaded != chunks.size()) {
+		spdlog::error("loaded {} of {} chunks", loaded, chunks.size());
+		return 1;
+	}
+
+	spdlog::info("chunks: {}, edits per chunk: {}, raw: {:.2f} MB, on disk: {:.2f} kB", chunks.size(), edits, rawBytes / 1e6, diskBytes / 1e3);
+	spdlog::info("save: {:.0f} chunks/s, {:.2f} MB/s", chunks.size() / saveTime, rawBytes / 1e6 / saveTime);
+	spdlog::info("load: {:.0f} chunks/s, {:.2f} MB/s", chunks.size() / loadTime, rawBytes / 1e6 / loadTime);
+
+	std::filesystem::remove_all(path);
+	return 0;
+}
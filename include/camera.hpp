@@ -16,11 +16,12 @@ struct Camera {
 
 	mat4 proj() const;
 	mat4 view() const;
+	mat4 projInverse() const;
 
 	tvec3<float> pos, rot;
 	tvec2<float> res;
 	float fov, znear, zfar;
 
 private:
-	mat4 m_proj, m_view;
+	mat4 m_proj, m_view, m_projInverse;
 };
\ No newline at end of file
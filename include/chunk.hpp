@@ -1,36 +1,37 @@
 #pragma once
 
 #include <array>
+#include <span>
 
 #include <math/matrix.hpp>
 #include <math/vector.hpp>
 
-#include <opengl/mesh.hpp>
-#include <opengl/vertex.hpp>
-
 #include "tile.hpp"
 
 #include <atomic>
 #include <memory>
-#include <mutex>
 
 using namespace math;
 
 class WorldContainer;
 class Chunk {
 public:
-	using Vertex = opengl::Vertex<vec3, vec2>;
-	using Mesh = opengl::IndexedMesh<vec3, vec2>;
-
 	Chunk(const WorldContainer &container, lvec2 pos, vec2 tileScale);
 
 	void fill(uint64_t tile);
 
-	void build();
 	void update(float time, float dt);
-	void render();
 
 	lvec2 getPos();
+	vec2 getTileScale() const;
+	// changes whenever the tiles may have been modified, renderers rebuild their geometry when it does
+	unsigned getRevision() const;
+
+	std::span<Tile> data();
+	std::span<const Tile> data() const;
+
+	bool isModified() const;
+	void setModified(bool modified);
 
 	Tile& operator[](ivec2 pos);
 	const Tile& operator[](ivec2 pos) const;
@@ -47,11 +48,6 @@ private:
 	vec2 tileScale;
 	std::array<Tile, size * size> tiles;
 
-	std::unique_ptr<Mesh> mesh;
-	std::vector<Vertex> vertices;
-	std::vector<unsigned> indices;
-
-	std::mutex meshMutex;
-	std::atomic<bool> rebuild = false;
-	std::atomic<bool> sync = false;
+	std::atomic<unsigned> revision = 0;
+	std::atomic<bool> modified = false;
 };
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "chunk.hpp"
+
+//	edits of a chunk relative to its generated baseline, stored as runs of changed tiles.
+//	serialized form (all integers are LEB128 varints):
+//		runCount {skip, length, {type, variant, custom} * length} * runCount
+//	skip is the number of unchanged tiles since the end of the previous run.
+class ChunkDelta {
+public:
+	struct Run {
+		uint16_t begin;
+		std::vector<Tile> tiles;
+	};
+
+	ChunkDelta() = default;
+	ChunkDelta(const Chunk &baseline, const Chunk &chunk);
+
+	void apply(Chunk &chunk) const;
+	void set(unsigned index, const Tile &tile);
+
+	bool empty() const;
+	size_t size() const;	// number of changed tiles
+	const std::vector<Run>& runs() const;
+
+	std::vector<uint8_t> serialize() const;
+	static bool deserialize(std::span<const uint8_t> data, ChunkDelta &delta);
+
+private:
+	std::vector<Run> m_runs;
+};
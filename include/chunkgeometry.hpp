@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+#include <math/vector.hpp>
+
+#include <opengl/vertex.hpp>
+
+#include "chunk.hpp"
+
+using namespace math;
+
+// the tile quads of a chunk, built without gl so they can be measured headless, ChunkMesh uploads them
+class ChunkGeometry {
+public:
+	using Vertex = opengl::Vertex<vec3, vec2>;
+
+	void build(const Chunk &chunk);
+
+	const std::vector<Vertex>& getVertices() const;
+	const std::vector<unsigned>& getIndices() const;
+
+private:
+	std::vector<Vertex> vertices;
+	std::vector<unsigned> indices;
+};
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <math/vector.hpp>
+
+#include <network/udpsocket.hpp>
+#include <utils/metrics.hpp>
+#include <utils/serialization.hpp>
+
+#include "chunk.hpp"
+#include "replication.hpp"
+
+using namespace math;
+
+class WorldContainer;
+
+//	palette and run length coding of the tiles of a chunk (all integers are LEB128 varints):
+//		paletteSize {type, variant, custom} * paletteSize {length, index} * runs
+//	tiles are in row order, the runs cover all of them.
+class ChunkCodec {
+public:
+	// every tile in its own palette entry and run, with the widest values
+	static constexpr size_t maxSize = varintSize(Chunk::size * Chunk::size)
+		+ Chunk::size * Chunk::size * (varintSize(UINT32_MAX) * 2 + varintSize(UINT64_MAX) + varintSize(Chunk::size * Chunk::size) * 2);
+
+	static std::vector<uint8_t> encode(std::span<const Tile> tiles);
+	static bool decode(std::span<const uint8_t> data, std::span<Tile> tiles);
+	// identifies encoded chunks, equal content has an equal hash
+	static uint64_t hash(std::span<const uint8_t> data);
+};
+
+//	streams the chunks around each client's camera over udp, nearest first and rate limited per client.
+//	only chunks the server has loaded (or recently encoded) are sent, clients never make it load or generate any,
+//	and the radius a client asks for is capped at maxRadius.
+//	chunks are sent encoded (ChunkCodec) in slices of at most sliceSize bytes, slices that aren't acked
+//	in time are sent again. the server remembers which content the client has cached, a chunk with the
+//	same hash is only referenced. a client that doesn't have a referenced chunk anymore reports it as missing.
+//	datagrams use the header of replication.hpp (sequence u16, ack u16, ackBits u32, type u8), then:
+//		chunks: records until the end, kind u8, x, y (zigzag varints, absolute chunk positions), hash u64
+//			slice: size (varint, encoded chunk), index (varint), min(sliceSize, size - index * sliceSize) bytes
+//			cached: nothing else
+//		interest: camera x, y f32 (absolute, in chunks), radius u8, cacheSize u16, missingCount u16, x, y (zigzag varints) * missingCount
+class ChunkStreamServer {
+public:
+	static constexpr size_t sliceSize = 1024;
+
+	// rate is in bytes per second per client
+	ChunkStreamServer(WorldContainer &world, unsigned short port = 0, size_t rate = 256 * 1024, size_t maxClients = 64, uint8_t maxRadius = 16);
+
+	// receives interest and acks, then sends what the rate allows, call once per simulation tick
+	void update(float dt);
+
+	unsigned short getPort() const;
+	size_t getClientCount() const;
+	size_t getBytesSent() const;		// udp payload sent to all clients
+	size_t getChunksSent() const;		// chunks completely delivered as data
+	size_t getChunksReferenced() const;	// chunks delivered by reference to the client's cache
+	size_t getSlicesResent() const;
+
+private:
+	struct Encoded {
+		std::weak_ptr<const Chunk> source;
+		unsigned revision = 0;
+		uint64_t hash = 0;
+		std::vector<uint8_t> data;
+		double used = 0.0;
+	};
+
+	struct Record {
+		lvec2 pos;
+		uint64_t hash;
+		int32_t slice;	// -1 -> cached
+	};
+
+	struct SentPacket {
+		uint16_t sequence;
+		double time;
+		bool acked;
+		std::vector<Record> records;
+	};
+
+	enum SliceState : uint8_t {
+		Pending,
+		InFlight,
+		Acked,
+	};
+
+	// delivery of one chunk, a reference has a single slice
+	struct Transfer {
+		uint64_t hash;
+		bool cached;
+		std::vector<uint8_t> slices;
+		size_t acked = 0;
+	};
+
+	// per client on the metrics endpoint, labelled with the peer
+	struct ClientMetrics {
+		metrics::Counter bytesSent, slicesResent;
+		metrics::Gauge rtt;
+	};
+
+	struct Client {
+		struct sockaddr_in peer;
+		PacketSequence sequence;
+		double lastReceived = 0.0;
+		vec2 camera;
+		uint8_t radius = 0;
+		size_t cacheSize = 0;
+		double tokens = 0.0;
+		double rtt = 0.2;
+
+		std::vector<SentPacket> packets;
+		std::vector<uint16_t> unacked;	// in send order
+		std::map<lvec2, uint64_t> delivered;
+		std::map<lvec2, Transfer> transfers;
+		std::map<uint64_t, double> cache;	// hashes the client should have, with the time they were last used
+		std::unique_ptr<ClientMetrics> stats;
+	};
+
+	void receive();
+	void receive(Client &client, std::span<const uint8_t> datagram);
+	void acked(Client &client, uint16_t sequence);
+	void lost(Client &client, const SentPacket &packet);
+	void send(Client &client, float dt);
+	void remember(Client &client, uint64_t hash);
+	const Encoded* encode(lvec2 pos);
+
+	WorldContainer &world;
+	network::udpsocket socket;
+	size_t rate, maxClients;
+	uint8_t maxRadius;
+	std::vector<Client> clients;
+	std::map<lvec2, Encoded> encoded;
+	double time = 0.0;
+	size_t bytesSent = 0, chunksSent = 0, chunksReferenced = 0, slicesResent = 0;
+};
+
+class ChunkStreamClient {
+public:
+	// cacheSize is the number of encoded chunks kept for when the camera comes back, chunks in range are kept beyond it
+	ChunkStreamClient(const std::string &host, unsigned short port, size_t cacheSize = 256);
+	ChunkStreamClient(const ChunkStreamClient &other) = delete;
+	~ChunkStreamClient();
+
+	ChunkStreamClient& operator=(const ChunkStreamClient &other) = delete;
+
+	// absolute position in chunks, the server sends every chunk within radius of it
+	void setCamera(vec2 camera, uint8_t radius);
+	// receives chunks and acks them
+	void update(float dt);
+	// writes the chunks that arrived since the last call into the world
+	void apply(WorldContainer &world, vec2 tileScale = vec2(1.0f));
+
+	// the newest content of the chunk at an absolute position, false if it isn't known
+	bool get(lvec2 pos, std::span<Tile> tiles) const;
+	bool has(lvec2 pos, uint64_t hash) const;
+	size_t getChunkCount() const;
+	size_t getBytesReceived() const;
+
+private:
+	struct Assembly {
+		lvec2 pos;
+		size_t size, arrived = 0;
+		std::vector<uint8_t> data;
+		std::vector<bool> slices;
+	};
+
+	struct Cached {
+		std::vector<uint8_t> data;
+		uint64_t used;
+	};
+
+	bool receive(std::span<const uint8_t> datagram);
+	void place(lvec2 pos, uint64_t hash);
+	void store(uint64_t hash, std::vector<uint8_t> data);
+	void send(uint8_t type);
+
+	network::udpsocket socket;
+	struct sockaddr_in server;
+	PacketSequence sequence;
+	size_t cacheSize;
+	vec2 camera;
+	uint8_t radius = 0;
+	std::map<uint64_t, Assembly> assemblies;
+	std::map<uint64_t, Cached> cache;
+	std::map<lvec2, uint64_t> chunks;	// content of the positions in range
+	std::set<lvec2> pending, missing;
+	uint64_t uses = 0;
+	float sinceSent = 0.0f;
+	size_t bytesReceived = 0;
+};
@@ -2,15 +2,9 @@
 
 #include <array>
 
-#include <math/matrix.hpp>
+#include <math/affine.hpp>
 #include <math/vector.hpp>
 
-#include <opengl/mesh.hpp>
-#include <opengl/program.hpp>
-#include <opengl/texture.hpp>
-#include <opengl/uniform.hpp>
-#include <opengl/vertex.hpp>
-
 #include "chunk.hpp"
 #include "resources.hpp"
 #include "tile.hpp"
@@ -19,6 +13,14 @@ using namespace math;
 
 class WorldContainer;
 
+// replicated part of an entity, see replication.hpp
+struct EntityState {
+	vec2 pos, speed;
+	uint8_t frame = 0;	// sprite tile, y * 16 + x
+	uint8_t state = 0;
+	bool flipped = false;
+};
+
 class Entity {
 public:
 	Entity(std::shared_ptr<TiledTexture> texture = {});
@@ -30,14 +32,17 @@ public:
 
 	virtual void shift(ivec2 dir);
 
-	mat4 getTransform();
-	mat4 getUVTransform();
+	virtual void saveState(EntityState &state) const;
+	virtual void loadState(const EntityState &state);
+
+	affine2 getTransform();
+	affine2 getUVTransform();
 	void setTexturePtr(std::shared_ptr<TiledTexture> texture);
 	TiledTexture* getTexturePtr();
 
-	vec3 pos, rot, scale = vec3(1);
+	vec3 pos, rot, scale = vec3(1);	// entities are flat, only rot.z is used
 
 protected:
-	mat4 transform, uvtransform;
+	affine2 transform, uvtransform;
 	std::shared_ptr<TiledTexture> texture;
 };
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "player.hpp"
+#include "world.hpp"
+
+//	the inputs of every frame of a platformer session, enough to play it again on a fresh world with the same seed.
+//	serialized form (varints are LEB128, tile indices zigzag encoded):
+//		"PHIL" version seed frameCount {dt: float32, move: int8, flags: uint8, [x, y]} * frameCount
+//	the tile index is only stored for frames that place or remove a tile.
+class InputLog {
+public:
+	static constexpr uint32_t version = 1;
+
+	struct Frame {
+		enum Flags : uint8_t {
+			jump = 1 << 0,
+			dash = 1 << 1,
+			walk = 1 << 2,
+			gravityDown = 1 << 3,
+			place = 1 << 4,
+			remove = 1 << 5,
+			respawn = 1 << 6,
+		};
+
+		float dt = 0.0f;
+		float move = 0.0f;
+		uint8_t flags = 0;
+		lvec2 tile;	// of the edit
+
+		// feeds the inputs to the player and edits the world, in the order the game handles them
+		void apply(Player &player, WorldContainer &world) const;
+	};
+
+	InputLog(uint32_t seed = 0);
+
+	uint32_t getSeed() const;
+	const std::vector<Frame>& getFrames() const;
+	void push(const Frame &frame);
+
+	std::vector<uint8_t> serialize() const;
+	static bool deserialize(std::span<const uint8_t> data, InputLog &log);
+
+	// throw std::runtime_error if the file can't be accessed or isn't a log
+	void save(const std::string &path) const;
+	static InputLog load(const std::string &path);
+
+private:
+	uint32_t seed;
+	std::vector<Frame> frames;
+};
+
+// the stone platforms around the spawn point, part of every session
+void buildStartArea(WorldContainer &world);
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+
+#include "math.hpp"
+#include "matrix.hpp"
+#include "vector.hpp"
+
+namespace math {
+	// 2d affine transform, the columns of the upper 2x3 part of a 3x3 matrix
+	//	| x.x y.x t.x |
+	//	| x.y y.y t.y |
+	template<typename type>
+	class taffine2 {
+	public:
+		taffine2() : x(1, 0), y(0, 1), t(0, 0) {}
+		taffine2(const tvec2<type> &x, const tvec2<type> &y, const tvec2<type> &t) : x(x), y(y), t(t) {}
+
+		static taffine2<type> translation(const tvec2<type> &vec) {
+			return taffine2<type>(tvec2<type>(1, 0), tvec2<type>(0, 1), vec);
+		}
+		static taffine2<type> rotation(type angle) {
+			type c = std::cos(angle), s = std::sin(angle);
+			return taffine2<type>(tvec2<type>(c, s), tvec2<type>(-s, c), tvec2<type>(0, 0));
+		}
+		static taffine2<type> scaling(const tvec2<type> &vec) {
+			return taffine2<type>(tvec2<type>(vec.x, 0), tvec2<type>(0, vec.y), tvec2<type>(0, 0));
+		}
+
+		// like the tmat4 ones, these apply before the transform so far
+		taffine2<type> translate(const tvec2<type> &vec) const {
+			return taffine2<type>(x, y, x * vec.x + y * vec.y + t);
+		}
+		taffine2<type> rotate(type angle) const {
+			type c = std::cos(angle), s = std::sin(angle);
+			return taffine2<type>(x * c + y * s, y * c - x * s, t);
+		}
+		taffine2<type> scale(const tvec2<type> &vec) const {
+			return taffine2<type>(x * vec.x, y * vec.y, t);
+		}
+
+		taffine2<type> operator*(const taffine2<type> &other) const {
+			return taffine2<type>(direction(other.x), direction(other.y), (*this) * other.t);
+		}
+		taffine2<type>& operator*=(const taffine2<type> &other) {
+			return (*this = (*this) * other);
+		}
+		tvec2<type> operator*(const tvec2<type> &point) const {
+			return x * point.x + y * point.y + t;
+		}
+		// without the translation
+		tvec2<type> direction(const tvec2<type> &dir) const {
+			return x * dir.x + y * dir.y;
+		}
+
+		type determinant() const {
+			return x.x * y.y - y.x * x.y;
+		}
+		taffine2<type> inverse() const {
+			type det = determinant();
+			if(det == 0) {
+				return taffine2<type>();
+			}
+			tvec2<type> ix = tvec2<type>(y.y, -x.y) / det, iy = tvec2<type>(-y.x, x.x) / det;
+			return taffine2<type>(ix, iy, -(ix * t.x + iy * t.y));
+		}
+
+		// the same transform in the xy plane, z passes through
+		tmat4<type> toMat4() const {
+			tmat4<type> out;
+			out[0].xy = x;
+			out[1].xy = y;
+			out[3].xy = t;
+			return out;
+		}
+		// the two rows (x.x, y.x, t.x, 0) and (x.y, y.y, t.y, 0), as std140 vec4[2] for the shaders
+		std::array<tvec4<type>, 2> pack() const {
+			return {tvec4<type>(x.x, y.x, t.x, 0), tvec4<type>(x.y, y.y, t.y, 0)};
+		}
+
+		tvec2<type> x, y, t;
+	};
+
+	typedef taffine2<float> affine2;
+}
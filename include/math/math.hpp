@@ -5,6 +5,12 @@
 #include <cstdlib>
 #include <cstdlib>
 
+// sse is part of every x86-64 target, tvec4<float> and tmat4<float> use it unless MATH_NO_SIMD is defined
+#if !defined(MATH_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+	#define MATH_SSE
+	#include <xmmintrin.h>
+#endif
+
 namespace math{
 	const float pi = 3.14159;
 	const float e = 2.71828;
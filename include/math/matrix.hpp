@@ -277,7 +277,7 @@ namespace math{
 		type& at(unsigned col, unsigned row) { return m_data[col][row]; }
 		const type& at(unsigned col, unsigned row) const { return m_data[col][row]; }
 
-		tmat4<type> transpose() {
+		tmat4<type> transpose() const {
 			return tmat4<type>(	m_data[0][0], m_data[0][1], m_data[0][2], m_data[0][3],
 								m_data[1][0], m_data[1][1], m_data[1][2], m_data[1][3],
 								m_data[2][0], m_data[2][1], m_data[2][2], m_data[2][3],
@@ -311,18 +311,45 @@ namespace math{
 		bool invertible() const {
 			return determinant() != 0;
 		}
+		// the identity if the matrix isn't invertible
 		tmat4<type> inverse() const {
-			tmat4<type> m;
-			type det = determinant();
-			if(invertible()) {
-				for(unsigned col = 0; col < 4; col++) {
-					for(unsigned row = 0; row < 4; row++) {
-						type c = cofactor(col, row);
-						m[col][row] = c / det;
-					}
-				}
+			// aRC is row R, column C; the 2x2 determinants of the upper (s) and lower (c) two rows
+			const type a00 = at(0, 0), a01 = at(1, 0), a02 = at(2, 0), a03 = at(3, 0);
+			const type a10 = at(0, 1), a11 = at(1, 1), a12 = at(2, 1), a13 = at(3, 1);
+			const type a20 = at(0, 2), a21 = at(1, 2), a22 = at(2, 2), a23 = at(3, 2);
+			const type a30 = at(0, 3), a31 = at(1, 3), a32 = at(2, 3), a33 = at(3, 3);
+			const type s0 = a00 * a11 - a10 * a01, s1 = a00 * a12 - a10 * a02, s2 = a00 * a13 - a10 * a03;
+			const type s3 = a01 * a12 - a11 * a02, s4 = a01 * a13 - a11 * a03, s5 = a02 * a13 - a12 * a03;
+			const type c5 = a22 * a33 - a32 * a23, c4 = a21 * a33 - a31 * a23, c3 = a21 * a32 - a31 * a22;
+			const type c2 = a20 * a33 - a30 * a23, c1 = a20 * a32 - a30 * a22, c0 = a20 * a31 - a30 * a21;
+
+			type det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			if(det == 0) {
+				return tmat4<type>();
 			}
-			return m.transpose();
+			type i = type(1) / det;
+			return tmat4<type>(
+				( a11 * c5 - a12 * c4 + a13 * c3) * i, (-a01 * c5 + a02 * c4 - a03 * c3) * i, ( a31 * s5 - a32 * s4 + a33 * s3) * i, (-a21 * s5 + a22 * s4 - a23 * s3) * i,
+				(-a10 * c5 + a12 * c2 - a13 * c1) * i, ( a00 * c5 - a02 * c2 + a03 * c1) * i, (-a30 * s5 + a32 * s2 - a33 * s1) * i, ( a20 * s5 - a22 * s2 + a23 * s1) * i,
+				( a10 * c4 - a11 * c2 + a13 * c0) * i, (-a00 * c4 + a01 * c2 - a03 * c0) * i, ( a30 * s4 - a31 * s2 + a33 * s0) * i, (-a20 * s4 + a21 * s2 - a23 * s0) * i,
+				(-a10 * c3 + a11 * c1 - a12 * c0) * i, ( a00 * c3 - a01 * c1 + a02 * c0) * i, (-a30 * s3 + a31 * s1 - a32 * s0) * i, ( a20 * s3 - a21 * s1 + a22 * s0) * i
+			);
+		}
+		// inverse of a matrix without projection, its last row is (0 0 0 1)
+		tmat4<type> affineInverse() const {
+			tvec3<type> c0 = m_data[0].xyz, c1 = m_data[1].xyz, c2 = m_data[2].xyz, t = m_data[3].xyz;
+			tvec3<type> r0 = cross(c1, c2), r1 = cross(c2, c0), r2 = cross(c0, c1);
+			type det = dot(c0, r0);
+			if(det == 0) {
+				return tmat4<type>();
+			}
+			r0 = r0 / det, r1 = r1 / det, r2 = r2 / det;
+			return tmat4<type>(
+				r0.x, r0.y, r0.z, -dot(r0, t),
+				r1.x, r1.y, r1.z, -dot(r1, t),
+				r2.x, r2.y, r2.z, -dot(r2, t),
+				0, 0, 0, 1
+			);
 		}
 
 		tmat4<type> operator*(const tmat4<type>& mat) const {
@@ -373,27 +400,17 @@ namespace math{
 				0,0,0,1
 			);
 		}
+		// z * y * x, each rotating around its axis
 		static tmat4<type> rotation(const tvec3<type> &vec) {
-			tmat4<type> x(
-				1,0,0,0,
-				0,cos(vec.x),-sin(vec.x),0,
-				0,sin(vec.x), cos(vec.x),0,
-				0,0,0,1
-			);
-			tmat4<type> y(
-				cos(vec.y),0,sin(vec.y),0,
-				0,1,0,0,
-				-sin(vec.y),0,cos(vec.y),0,
-				0,0,0,1
-			);
-			tmat4<type> z(
-				cos(vec.z),-sin(vec.z),0,0,
-				sin(vec.z), cos(vec.z),0,0,
-				0,0,1,0,
-				0,0,0,1
+			type cx = std::cos(vec.x), sx = std::sin(vec.x);
+			type cy = std::cos(vec.y), sy = std::sin(vec.y);
+			type cz = std::cos(vec.z), sz = std::sin(vec.z);
+			return tmat4<type>(
+				cz*cy, cz*sy*sx - sz*cx, cz*sy*cx + sz*sx, 0,
+				sz*cy, sz*sy*sx + cz*cx, sz*sy*cx - cz*sx, 0,
+				-sy, cy*sx, cy*cx, 0,
+				0, 0, 0, 1
 			);
-
-			return z*y*x;
 		}
 		static tmat4<type> scaling(const tvec3<type> &vec) {
 			return tmat4<type>(
@@ -425,9 +442,17 @@ namespace math{
 			return tmat4<type>();
 		}
 
-		tmat4<type> translate(const tvec3<type> &vec) const { return (*this) * translation(vec); }
+		tmat4<type> translate(const tvec3<type> &vec) const {
+			tmat4<type> m = *this;
+			m[3] = m_data[0] * vec.x + m_data[1] * vec.y + m_data[2] * vec.z + m_data[3];
+			return m;
+		}
 		tmat4<type> rotate(const tvec3<type> &vec) const { return (*this) * rotation(vec); }
-		tmat4<type> scale(const tvec3<type> &vec) const { return (*this) * scaling(vec); }
+		tmat4<type> scale(const tvec3<type> &vec) const {
+			tmat4<type> m = *this;
+			m[0] *= vec.x, m[1] *= vec.y, m[2] *= vec.z;
+			return m;
+		}
 		tmat4<type> shear(type xy, type xz, type yx, type yz, type zx, type zy) const { return (*this) * shearing(xy, xz, yx, yz, zx, zy); }
 
 		type* data() {
@@ -445,6 +470,139 @@ namespace math{
 		tvec4<col_t> m_data;
 	};
 
+#if defined(MATH_SSE)
+	namespace simd {
+		// the columns weighted by the components of v
+		inline __m128 combine(const __m128 (&cols)[4], __m128 v) {
+			__m128 r = _mm_mul_ps(cols[0], _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+			r = _mm_add_ps(r, _mm_mul_ps(cols[1], _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+			r = _mm_add_ps(r, _mm_mul_ps(cols[2], _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+			return _mm_add_ps(r, _mm_mul_ps(cols[3], _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+		}
+
+		// a 2x2 matrix is (m00 m01 m10 m11)
+		inline __m128 mul2(__m128 a, __m128 b) {
+			return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+				_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+		}
+		// adjugate(a) * b
+		inline __m128 adjMul2(__m128 a, __m128 b) {
+			return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+				_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+		}
+		// a * adjugate(b)
+		inline __m128 mulAdj2(__m128 a, __m128 b) {
+			return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+				_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+		}
+
+		inline __m128 cross(__m128 a, __m128 b) {
+			return _mm_sub_ps(
+				_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2))),
+				_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1))));
+		}
+		// the sum of all components in every component
+		inline __m128 sum(__m128 v) {
+			v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+		}
+	}
+
+	template <>
+	inline tmat4<float> tmat4<float>::operator*(const tmat4<float> &mat) const {
+		const __m128 cols[4] = {simd::load(m_data[0]), simd::load(m_data[1]), simd::load(m_data[2]), simd::load(m_data[3])};
+		tmat4<float> m;
+		for(unsigned col = 0; col < 4; col++) {
+			_mm_storeu_ps(&m.m_data[col].x, simd::combine(cols, simd::load(mat.m_data[col])));
+		}
+		return m;
+	}
+
+	template <>
+	inline tvec4<float> tmat4<float>::operator*(const tvec4<float> &vec) const {
+		const __m128 cols[4] = {simd::load(m_data[0]), simd::load(m_data[1]), simd::load(m_data[2]), simd::load(m_data[3])};
+		return simd::store(simd::combine(cols, simd::load(vec)));
+	}
+
+	template <>
+	inline tmat4<float> tmat4<float>::transpose() const {
+		__m128 c0 = simd::load(m_data[0]), c1 = simd::load(m_data[1]), c2 = simd::load(m_data[2]), c3 = simd::load(m_data[3]);
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+		tmat4<float> m;
+		_mm_storeu_ps(&m.m_data[0].x, c0);
+		_mm_storeu_ps(&m.m_data[1].x, c1);
+		_mm_storeu_ps(&m.m_data[2].x, c2);
+		_mm_storeu_ps(&m.m_data[3].x, c3);
+		return m;
+	}
+
+	// blockwise with 2x2 matrices, on the columns as rows which gives the transposed inverse of the transpose
+	template <>
+	inline tmat4<float> tmat4<float>::inverse() const {
+		__m128 c0 = simd::load(m_data[0]), c1 = simd::load(m_data[1]), c2 = simd::load(m_data[2]), c3 = simd::load(m_data[3]);
+		__m128 a = _mm_movelh_ps(c0, c1), b = _mm_movehl_ps(c1, c0);
+		__m128 c = _mm_movelh_ps(c2, c3), d = _mm_movehl_ps(c3, c2);
+
+		// (|a| |b| |c| |d|)
+		__m128 dets = _mm_sub_ps(
+			_mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(3, 1, 3, 1))),
+			_mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(2, 0, 2, 0))));
+		__m128 detA = _mm_shuffle_ps(dets, dets, _MM_SHUFFLE(0, 0, 0, 0)), detB = _mm_shuffle_ps(dets, dets, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 detC = _mm_shuffle_ps(dets, dets, _MM_SHUFFLE(2, 2, 2, 2)), detD = _mm_shuffle_ps(dets, dets, _MM_SHUFFLE(3, 3, 3, 3));
+
+		__m128 dc = simd::adjMul2(d, c), ab = simd::adjMul2(a, b);
+		__m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), simd::mul2(b, dc));
+		__m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), simd::mul2(c, ab));
+		__m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), simd::mulAdj2(d, ab));
+		__m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), simd::mulAdj2(a, dc));
+
+		__m128 det = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+		det = _mm_sub_ps(det, simd::sum(_mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0)))));
+		if(_mm_cvtss_f32(det) == 0.0f) {
+			return tmat4<float>();
+		}
+		__m128 scale = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+		x = _mm_mul_ps(x, scale), y = _mm_mul_ps(y, scale);
+		z = _mm_mul_ps(z, scale), w = _mm_mul_ps(w, scale);
+
+		tmat4<float> m;
+		_mm_storeu_ps(&m.m_data[0].x, _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+		_mm_storeu_ps(&m.m_data[1].x, _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+		_mm_storeu_ps(&m.m_data[2].x, _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+		_mm_storeu_ps(&m.m_data[3].x, _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+		return m;
+	}
+
+	template <>
+	inline tmat4<float> tmat4<float>::affineInverse() const {
+		// w of the columns is 0, so is w of their cross products
+		__m128 c0 = simd::load(m_data[0]), c1 = simd::load(m_data[1]), c2 = simd::load(m_data[2]);
+		__m128 r0 = simd::cross(c1, c2), r1 = simd::cross(c2, c0), r2 = simd::cross(c0, c1);
+		__m128 det = simd::sum(_mm_mul_ps(c0, r0));
+		if(_mm_cvtss_f32(det) == 0.0f) {
+			return tmat4<float>();
+		}
+		det = _mm_div_ps(_mm_set1_ps(1.0f), det);
+		r0 = _mm_mul_ps(r0, det), r1 = _mm_mul_ps(r1, det), r2 = _mm_mul_ps(r2, det);
+
+		// the rows of the inverse rotation and scale, their w is 0 and becomes the last row
+		__m128 r3 = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		__m128 t = simd::load(m_data[3]);
+		__m128 translation = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(r0, _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0))),
+			_mm_mul_ps(r1, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1)))),
+			_mm_mul_ps(r2, _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2))));
+
+		tmat4<float> m;
+		_mm_storeu_ps(&m.m_data[0].x, r0);
+		_mm_storeu_ps(&m.m_data[1].x, r1);
+		_mm_storeu_ps(&m.m_data[2].x, r2);
+		_mm_storeu_ps(&m.m_data[3].x, _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), translation));
+		return m;
+	}
+#endif
+
 	typedef tmat2<float> mat2;
 	typedef tmat3<float> mat3;
 	typedef tmat4<float> mat4;
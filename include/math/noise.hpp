@@ -4,8 +4,8 @@
 #include <cmath>
 #include <random>
 #include <algorithm>
-#include <memory>
 #include <numeric>
+#include <span>
 
 #include "math.hpp"
 #include "vector.hpp"
@@ -15,6 +15,13 @@ namespace math{
 	public:
 		perlin(uint64_t seed = 0);
 		double noise(double x, double y, double z = 0.0f) const;
+		// batched in float, out[i] = noise(pos[i])
+		void noise(std::span<const vec2> pos, std::span<float> out) const;
+		void noise(std::span<const vec3> pos, std::span<float> out) const;
+		// out[y * size.x + x] = noise(origin + step * (x, y)), precise for any origin
+		void grid(dvec2 origin, dvec2 step, ivec2 size, std::span<float> out) const;
+		// out[(z * size.y + y) * size.x + x] = noise(origin + step * (x, y, z))
+		void grid(dvec3 origin, dvec3 step, ivec3 size, std::span<float> out) const;
 
 		inline double at(double x, double y, double z = 0.0f) const {
 			return noise(x, y, z);
@@ -24,7 +31,7 @@ namespace math{
 		static double fade(double t);
 		static double grad(int hash, double x, double y, double z);
 
-		std::vector<int> permutation;
+		std::array<int, 512> permutation;
 	};
 
 	// actually Open Simplex Noise
@@ -33,9 +40,14 @@ namespace math{
 	public:
 		simplex(uint64_t seed = 0);
 
-		double noise2d(math::dvec2 pos);
-		double noise3d(math::dvec3 pos);
-		double noise4d(math::dvec4 pos);
+		double noise2d(math::dvec2 pos) const;
+		double noise3d(math::dvec3 pos) const;
+		double noise4d(math::dvec4 pos) const;
+
+		// batched in float, out[i] = noise2d(pos[i])
+		void noise2d(std::span<const vec2> pos, std::span<float> out) const;
+		// out[y * size.x + x] = noise2d(origin + step * (x, y)), precise for any origin
+		void grid2d(dvec2 origin, dvec2 step, ivec2 size, std::span<float> out) const;
 
 	protected:
 		using Grad2 = math::dvec2;
@@ -49,7 +61,7 @@ namespace math{
 			LatticePoint2D() = default;
 			LatticePoint2D(const LatticePoint2D &other) = default;
 
-			inline LatticePoint2D(int xsv, int ysv) : xsv(xsv), ysv(ysv) {
+			constexpr LatticePoint2D(int xsv, int ysv) : xsv(xsv), ysv(ysv) {
 				double ssv = double(xsv + ysv) * -0.211324865405187;
 				dx = double(-xsv) - ssv;
 				dy = double(-ysv) - ssv;
@@ -60,12 +72,12 @@ namespace math{
 		struct LatticePoint3D {
 			double dxr, dyr, dzr;
 			int xrv, yrv, zrv;
-			std::shared_ptr<LatticePoint3D> nextOnFailure = {}, nextOnSuccess = {};
+			int nextOnFailure = -1, nextOnSuccess = -1;	// indices into lookup3D, -1 ends the chain
 
 			LatticePoint3D() = default;
 			LatticePoint3D(const LatticePoint3D &other) = default;
 
-			inline LatticePoint3D(int xrv, int yrv, int zrv, int lattice)
+			constexpr LatticePoint3D(int xrv, int yrv, int zrv, int lattice)
 			: dxr(-xrv + lattice * 0.5), dyr(-yrv + lattice * 0.5), dzr(-zrv + lattice * 0.5),
 			  xrv(xrv + lattice * 1024), yrv(yrv + lattice * 1024), zrv(zrv + lattice * 1024)
 			{}
@@ -82,7 +94,7 @@ namespace math{
 			LatticePoint4D() = default;
 			LatticePoint4D(const LatticePoint4D &other) = default;
 
-			inline LatticePoint4D(int xsv, int ysv, int zsv, int wsv)
+			constexpr LatticePoint4D(int xsv, int ysv, int zsv, int wsv)
 			: xsv(xsv + 409), ysv(ysv + 409), zsv(zsv + 409), wsv(wsv + 409),
 			  xsi(0.2 - xsv), ysi(0.2 - ysv), zsi(0.2 - zsv), wsi(0.2 - wsv),
 			  ssiDelta((0.8 - xsv - ysv - zsv - wsv) * 0.309016994374947)
@@ -100,9 +112,9 @@ namespace math{
 			return x < xi ? xi - 1 : xi;
 		}
 
-		double noise2dBase(math::dvec2 pos);
-		double noise3dBCC(math::dvec3 pos);
-		double noise4dBase(math::dvec4 pos);
+		double noise2dBase(math::dvec2 pos) const;
+		double noise3dBCC(math::dvec3 pos) const;
+		double noise4dBase(math::dvec4 pos) const;
 
 		static constexpr int size = 2048;
 		static constexpr int mask = 2047;
@@ -120,8 +132,12 @@ namespace math{
 		static const std::array<Grad3, size> gradients3D;
 		static const std::array<Grad4, size> gradients4D;
 
+		// built at compile time, lookup3D holds the 8 points of each octant in a row
+		static constexpr std::array<LatticePoint3D, 64> buildLookup3D();
+		static constexpr std::array<LatticePoint4D, 16> buildVertices4D();
+
 		static const std::array<LatticePoint2D, 4> lookup2D;
-		static const std::array<std::shared_ptr<LatticePoint3D>, 8> lookup3D;
+		static const std::array<LatticePoint3D, 64> lookup3D;
 		static const std::array<LatticePoint4D, 16> vertices4D;
 	};
 }
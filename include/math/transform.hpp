@@ -0,0 +1,25 @@
+#pragma once
+
+#include <span>
+
+#include "matrix.hpp"
+#include "vector.hpp"
+
+namespace math{
+	// spans at least this long are split across threads if parallel is set. the threads are started for every call,
+	// which costs tens of microseconds each, so every thread gets at least a quarter of this, milliseconds of work
+	constexpr size_t parallelTransformSize = 1 << 20;
+
+	// every overload throws std::invalid_argument if one of the other spans is shorter than the first input
+
+	// out[i] = m * in[i], in and out may be the same span but must not overlap otherwise
+	void transform_points(std::span<const vec4> in, const mat4 &m, std::span<vec4> out, bool parallel = false);
+	// the points (x, y, 0, 1) through a matrix without projection, out gets xy
+	void transform_points(std::span<const vec2> in, const mat4 &m, std::span<vec2> out, bool parallel = false);
+
+	// structure of arrays, point i is (x[i], y[i], z[i], w[i])
+	void transform_points(std::span<const float> x, std::span<const float> y, std::span<const float> z, std::span<const float> w, const mat4 &m,
+		std::span<float> outX, std::span<float> outY, std::span<float> outZ, std::span<float> outW, bool parallel = false);
+	// structure of arrays, the points (x[i], y[i], 0, 1) through a matrix without projection
+	void transform_points(std::span<const float> x, std::span<const float> y, const mat4 &m, std::span<float> outX, std::span<float> outY, bool parallel = false);
+}
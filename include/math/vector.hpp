@@ -63,19 +63,12 @@ namespace math {
 
 		bool operator==(const tvec2<type> &other) const {return x == other.x && y == other.y;}
 
+		// out of range indices give x
 		type& operator[](unsigned i) {
-			switch(i) {
-				case 0: return x;
-				case 1: return y;
-			}
-			return x;
+			return (&x)[i < 2 ? i : 0];
 		}
 		const type& operator[](unsigned i) const {
-			switch(i) {
-				case 0: return x;
-				case 1: return y;
-			}
-			return x;
+			return (&x)[i < 2 ? i : 0];
 		}
 
 		union {
@@ -140,21 +133,12 @@ namespace math {
 
 		bool operator==(const tvec3<type> &other) const {return x == other.x && y == other.y && z == other.z;}
 
+		// out of range indices give x
 		type& operator[](unsigned i) {
-			switch(i) {
-				case 0: return x;
-				case 1: return y;
-				case 2: return z;
-			}
-			return x;
+			return (&x)[i < 3 ? i : 0];
 		}
 		const type& operator[](unsigned i) const {
-			switch(i) {
-				case 0: return x;
-				case 1: return y;
-				case 2: return z;
-			}
-			return x;
+			return (&x)[i < 3 ? i : 0];
 		}
 
 		auto operator<=>(const tvec3<type> &other) const {
@@ -240,23 +224,12 @@ namespace math {
 
 		bool operator==(const tvec4<type> &other) const {return x == other.x && y == other.y && z == other.z && w == other.w;}
 
+		// out of range indices give x
 		type& operator[](unsigned i) {
-			switch(i) {
-				case 0: return x;
-				case 1: return y;
-				case 2: return z;
-				case 3: return w;
-			}
-			return x;
+			return (&x)[i < 4 ? i : 0];
 		}
 		const type& operator[](unsigned i) const {
-			switch(i) {
-				case 0: return x;
-				case 1: return y;
-				case 2: return z;
-				case 3: return w;
-			}
-			return x;
+			return (&x)[i < 4 ? i : 0];
 		}
 
 		auto operator<=>(const tvec3<type> &other) const {
@@ -315,6 +288,62 @@ namespace math {
 		return *this;
 	}
 
+#if defined(MATH_SSE)
+	namespace simd {
+		inline __m128 load(const tvec4<float> &v) {
+			return _mm_loadu_ps(&v.x);
+		}
+		inline tvec4<float> store(__m128 value) {
+			tvec4<float> v;
+			_mm_storeu_ps(&v.x, value);
+			return v;
+		}
+	}
+
+	template <>
+	inline tvec4<float> tvec4<float>::operator-() const {
+		// flips the sign bit like the scalar -x, so -0 and 0 stay apart
+		return simd::store(_mm_xor_ps(simd::load(*this), _mm_set1_ps(-0.0f)));
+	}
+	template <>
+	inline tvec4<float> tvec4<float>::operator+(const tvec4<float> &other) const {
+		return simd::store(_mm_add_ps(simd::load(*this), simd::load(other)));
+	}
+	template <>
+	inline tvec4<float> tvec4<float>::operator-(const tvec4<float> &other) const {
+		return simd::store(_mm_sub_ps(simd::load(*this), simd::load(other)));
+	}
+	template <>
+	inline tvec4<float> tvec4<float>::operator*(const tvec4<float> &other) const {
+		return simd::store(_mm_mul_ps(simd::load(*this), simd::load(other)));
+	}
+	template <>
+	inline tvec4<float> tvec4<float>::operator/(const tvec4<float> &other) const {
+		return simd::store(_mm_div_ps(simd::load(*this), simd::load(other)));
+	}
+
+	template <>
+	inline tvec4<float>& tvec4<float>::operator+=(const tvec4<float> &other) {
+		_mm_storeu_ps(&x, _mm_add_ps(simd::load(*this), simd::load(other)));
+		return *this;
+	}
+	template <>
+	inline tvec4<float>& tvec4<float>::operator-=(const tvec4<float> &other) {
+		_mm_storeu_ps(&x, _mm_sub_ps(simd::load(*this), simd::load(other)));
+		return *this;
+	}
+	template <>
+	inline tvec4<float>& tvec4<float>::operator*=(const tvec4<float> &other) {
+		_mm_storeu_ps(&x, _mm_mul_ps(simd::load(*this), simd::load(other)));
+		return *this;
+	}
+	template <>
+	inline tvec4<float>& tvec4<float>::operator/=(const tvec4<float> &other) {
+		_mm_storeu_ps(&x, _mm_div_ps(simd::load(*this), simd::load(other)));
+		return *this;
+	}
+#endif
+
 	template<typename type>	tvec2<type>::tvec2(const tvec2<type> &other) : x(other.x), y(other.y) {}
 	template<typename type>	tvec2<type>::tvec2(const tvec3<type> &other) : x(other.x), y(other.y) {}
 	template<typename type>	tvec2<type>::tvec2(const tvec4<type> &other) : x(other.x), y(other.y) {}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "tcpsocket.hpp"
+#include "uring.hpp"
+
+namespace network{
+	// one non-blocking connection, owned and driven by the loop thread that accepted it
+	class connection{
+	public:
+		enum states{
+			Reading,
+			Closing,	// close once all queued output was sent
+			Closed,
+		};
+
+		connection(int handle);
+		connection(const connection &other) = delete;
+		virtual ~connection();
+
+		connection& operator=(const connection &other) = delete;
+
+		// called with all input that hasn't been consumed yet, returns the number of consumed bytes
+		virtual size_t onData(std::string_view data) = 0;
+		virtual void onClose(){}
+
+		// virtual so that wrappers like tlsconnection see every write and the close, even through a connection&
+		virtual void send(std::string_view data);
+		// gathered into a single sendmsg while nothing else is queued, only what doesn't fit into the socket is copied
+		virtual void send(std::initializer_list<std::string_view> parts);
+		// queues len bytes of file via sendfile, takes ownership of the file descriptor
+		virtual void sendFile(int file, off_t offset, size_t len);
+		virtual void close();
+
+		// bytes that had to be copied into outbound queues, over all connections
+		static size_t copiedBytes();
+
+		int getHandle() const;
+		states getState() const;
+
+	private:
+		friend class eventloop;
+
+		// both drain the socket until it would block, false -> connection is done
+		bool readable();
+		bool writable();
+		void received(std::string_view data);
+		// sends the front file segment, 1 -> done, 0 -> socket is full, -1 -> failed
+		int writeFile();
+
+		// outbound queue entry, either owned bytes or a file range
+		struct segment{
+			std::string data;
+			int file = -1;
+			off_t offset = 0;
+			size_t size = 0;
+		};
+
+		void queue(std::string_view data);
+
+		int handle;
+		states state = Reading;
+		std::string input;
+		std::deque<segment> output;
+		size_t outputOffset = 0;	// sent bytes of the front data segment
+
+		// io_uring: output is sent by the loop, the first sending segments are in flight until their sends complete
+		bool deferred = false, polling = false, failed = false, cancelled = false;
+		size_t sending = 0;
+		unsigned pending = 0;	// submitted operations that haven't completed
+	};
+
+	// loop threads, each with its own SO_REUSEPORT listener so the kernel spreads new connections across them
+	class eventloop{
+	public:
+		using factory = std::function<std::unique_ptr<connection>(int handle)>;
+
+		enum backends{
+			Epoll,
+			// multishot accept and receive into provided buffers, linked sends, one syscall per batch of completions
+			// falls back to Epoll if the kernel doesn't support it, connections don't survive a stop()
+			IoUring,
+		};
+
+		eventloop(factory create, unsigned short port, address addr = address::Any, unsigned threads = 0, backends backend = Epoll);
+		eventloop(const eventloop &other) = delete;
+		~eventloop();
+
+		eventloop& operator=(const eventloop &other) = delete;
+
+		void start();
+		void stop();
+
+		unsigned short getPort() const;
+		size_t connections() const;
+		backends getBackend() const;
+
+	private:
+		struct worker{
+			int epoll = -1, listener = -1, wake = -1;
+			std::unique_ptr<uring> ring;
+			std::unordered_map<int, std::unique_ptr<connection>> connections;
+			std::thread thread;
+		};
+
+		void run(worker &w);
+		void accept(worker &w);
+		void update(worker &w, connection &c, uint32_t events);
+		void remove(worker &w, connection &c);
+
+		void runUring(worker &w);
+		void accepted(worker &w, int result, uint32_t flags);
+		void completed(worker &w, connection &c, uint64_t operation, int result, uint32_t flags);
+		bool receive(worker &w, connection &c);
+		void transmit(worker &w, connection &c);
+		void shut(worker &w, connection &c);
+
+		factory create;
+		unsigned short port;
+		backends backend;
+		std::vector<std::unique_ptr<worker>> workers;
+		std::atomic<size_t> openConnections = 0;
+		bool running = false;
+	};
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "eventloop.hpp"
+#include "statuscodes.hpp"
+
+namespace network{
+	namespace http{
+		struct header{
+			std::string_view name, value;
+		};
+
+		// all views point into the connection's input (or the parser for chunked bodies) and are valid until the request was handled
+		struct request{
+			std::string_view method, target, version;
+			std::vector<header> headers;
+			std::string_view body;
+			bool keepAlive = true;
+
+			std::string_view get(std::string_view name) const;	// case insensitive, empty if missing
+		};
+
+		struct response{
+			int status = HttpStatus_OK;
+			std::vector<header> headers;	// names and values have to outlive the handler call
+			std::string body;
+
+			// a file body is sent with sendfile instead of body, the connection takes ownership of the descriptor
+			int file = -1;
+			size_t fileSize = 0;
+
+			void set(std::string_view name, std::string_view value);
+			bool sendFile(const std::string &path);	// false if it's not a readable regular file
+			void clear();
+		};
+
+		// parses one request at a time from the start of the unconsumed input, picking up where the last call stopped
+		class parser{
+		public:
+			enum status{
+				Incomplete,
+				Complete,
+				Error,
+			};
+
+			static constexpr size_t maxHeaderSize = 64 * 1024;
+			static constexpr size_t maxBodySize = 16 * 1024 * 1024;
+
+			status parse(std::string_view data);
+			void reset();
+
+			const request& get() const;	// only valid after Complete, until the next call
+			size_t consumed() const;	// size of the complete request
+			int error() const;			// status code to answer an Error with
+
+		private:
+			// the input can move between calls, so the head is kept as offsets from the start of the request until it's complete
+			struct range{
+				size_t offset, size;
+			};
+
+			status fail(int code);
+			bool parseHead(std::string_view head);
+			status parseChunked(std::string_view data);
+			void resolve(std::string_view data);
+
+			request m_request;
+			range method, target, version;
+			std::vector<std::pair<range, range>> headers;
+			size_t scanned = 0, headerSize = 0, bodySize = 0, m_consumed = 0;
+			bool chunked = false;
+			size_t chunkPos = 0;
+			std::string chunkedBody;
+			int m_error = 0;
+		};
+
+		// writes status line and headers into head, the body is sent alongside without being copied
+		void serialize(const response &res, bool keepAlive, std::string &head);
+
+		using handler = std::function<void(const request&, response&)>;
+
+		// GET/HEAD handler for the files below root
+		handler serveDirectory(const std::string &root);
+		// GET/HEAD handler for the metrics registry, /metrics in prometheus text format, /metrics.json as json
+		handler serveMetrics();
+
+		class server{
+		public:
+			using handler = http::handler;
+
+			server(handler callback, unsigned short port = 80, address addr = address::Any, unsigned threads = 0, eventloop::backends backend = eventloop::Epoll);
+
+			void start();
+			void stop();
+
+			unsigned short getPort() const;
+			size_t connections() const;
+
+		private:
+			handler callback;
+			eventloop loop;
+		};
+	}
+}
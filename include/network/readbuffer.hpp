@@ -0,0 +1,27 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string_view>
+
+namespace network{
+	// receive buffer that hands out views of buffered bytes, unread data is moved to the front only when space runs out
+	class readbuffer{
+	public:
+		readbuffer(size_t capacity = 16 * 1024);
+
+		// unread bytes, valid until the next prepare()
+		std::string_view data() const;
+		size_t size() const;
+		bool empty() const;
+		void consume(size_t len);
+
+		// free space for at least len bytes, filled bytes have to be committed afterwards
+		std::span<char> prepare(size_t len);
+		void commit(size_t len);
+
+	private:
+		std::unique_ptr<char[]> buffer;
+		size_t capacity, head = 0, tail = 0;
+	};
+}
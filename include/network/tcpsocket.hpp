@@ -13,16 +13,22 @@
 	#include <netinet/in.h>
 	#include <netdb.h>
 	#include <arpa/inet.h>
-	#include <sys/select.h>
+	#include <poll.h>
+	#include <sys/uio.h>
 	#include <fcntl.h>
 #endif
 
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <span>
+#include <optional>
 #include <limits>
 
 #include <spdlog/spdlog.h>
 
+#include "readbuffer.hpp"
+
 #define CHUNK_SIZE 512
 
 namespace network{
@@ -67,13 +73,41 @@ namespace network{
 		virtual void disconnect();
 
 		bool isConnected();
+		// disables nagle, for protocols that already send complete messages
+		void setNoDelay(bool enable = true);
 		std::string getError();
 		std::string getClientIP();
 
-		virtual bool send(std::string data);
+		// all send functions block until everything was sent or the connection failed
+		virtual bool send(std::string_view data);
+		#if !defined(WINDOWS)
+			virtual bool send(std::span<const struct iovec> parts);
+			virtual bool sendFile(int file, off_t offset, size_t len);
+		#endif
 		virtual std::string recv(int len);
 		virtual std::string recvLine(char delim = '\n', size_t maxlen = 1024*1024);
+
+		// buffered reads, the returned views stay valid until the next read
+		std::optional<std::string_view> readUntil(char delim, size_t maxlen = 1024*1024);
+		std::optional<std::string_view> readLine(size_t maxlen = 1024*1024);	// without "\r\n"
+		std::optional<std::string_view> readExact(size_t len);
+
+		size_t getRecvCalls() const;
+	protected:
+		// raw, unbuffered receive
+		virtual int read(char *data, size_t len);
+
+		// creates the socket for an accepted connection
+		#if defined(WINDOWS)
+			virtual tcpsocket* wrap(SOCKET s, SOCKADDR_IN addr);
+		#else
+			virtual tcpsocket* wrap(int handle, struct sockaddr_in addr);
+		#endif
 	private:
+		bool fill(size_t len);
+
+		readbuffer input;
+		size_t recvCalls = 0;
 		bool connected = false;
 		#if defined(WINDOWS)
 			SOCKET handle;
@@ -81,7 +115,6 @@ namespace network{
 		#else
 			int handle;
 			struct sockaddr_in client;
-			fd_set master, readfds;
 		#endif
 	};
 }
\ No newline at end of file
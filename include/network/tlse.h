@@ -191,6 +191,7 @@ typedef struct TLSContext TLS;
 typedef struct TLSCertificate Certificate;
 
 typedef int (*tls_validation_function)(struct TLSContext *context, struct TLSCertificate **certificate_chain, int len);
+typedef int (*tls_session_lookup_function)(struct TLSContext *context, const unsigned char *session_id, unsigned int session_id_len, void *cache);
 
 /*
   Global initialization. Optional, as it will be called automatically;
@@ -332,6 +333,21 @@ void tls_make_exportable(struct TLSContext *context, unsigned char exportable_fl
 
 int tls_export_context(struct TLSContext *context, unsigned char *buffer, unsigned int buf_len, unsigned char small_version);
 struct TLSContext *tls_import_context(const unsigned char *buffer, unsigned int buf_len);
+
+/*
+  TLS 1.2 session resumption via session ids (abbreviated handshake).
+  tls_export_session() serializes the session of an established connection (returns the
+  needed size if buffer is NULL). Clients import a session before tls_client_connect() to
+  offer it, TLS 1.3 client hellos carry it as legacy session id; a server context's lookup
+  function (inherited by tls_accept()) imports the session matching session_id and
+  returns 1, or 0 for a full handshake.
+ */
+int tls_export_session(struct TLSContext *context, unsigned char *buffer, unsigned int buf_len);
+int tls_import_session(struct TLSContext *context, const unsigned char *buffer, unsigned int buf_len);
+void tls_set_session_cache(struct TLSContext *context, tls_session_lookup_function lookup, void *cache);
+const unsigned char *tls_session_id(struct TLSContext *context, unsigned int *len);
+int tls_session_resumed(struct TLSContext *context);
+
 int tls_is_broken(struct TLSContext *context);
 int tls_request_client_certificate(struct TLSContext *context);
 int tls_client_verified(struct TLSContext *context);
@@ -1,7 +1,145 @@
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "eventloop.hpp"
 #include "tcpsocket.hpp"
 
+struct TLSContext;
+struct TLSCertificate;
+
 namespace network{
-	class tlssocket{};
+	// certificates and resumable sessions shared by all connections of one side, safe to use from several threads
+	// tlse only resumes TLS 1.2 sessions (session ids), TLS 1.3 connections always do a full handshake
+	class tlscontext{
+	public:
+		enum versions{
+			TLS12,
+			TLS13,
+		};
+
+		// client side, server certificates are verified against the loaded root certificates, without any the handshake fails
+		tlscontext(versions maxVersion = TLS13, size_t sessionCapacity = 1024);
+		// server side, pem encoded certificate chain and private key
+		tlscontext(std::string_view certificate, std::string_view key, versions maxVersion = TLS13, size_t sessionCapacity = 1024);
+		tlscontext(const tlscontext &other) = delete;
+		~tlscontext();
+
+		tlscontext& operator=(const tlscontext &other) = delete;
+
+		void loadRootCertificates(std::string_view pem);
+		// accepts any server certificate, only for self-signed test endpoints
+		void insecureSkipVerify(bool skip = true);
+
+		bool isServer() const;
+		size_t fullHandshakes() const;
+		size_t resumedHandshakes() const;
+
+	private:
+		friend class tlssocket;
+		friend class tlsconnection;
+
+		// new connection state, clients offer the session cached for peer
+		TLSContext* create(const std::string &peer = "");
+		// counts the handshake and caches its session, clients by peer and servers by session id
+		void established(TLSContext *connection, const std::string &peer = "");
+		// certificate verification for tls_consume_stream, nullptr for servers and skipped verification
+		int (*verifier())(TLSContext*, TLSCertificate**, int);
+
+		static int lookup(TLSContext *connection, const unsigned char *id, unsigned int len, void *self);
+
+		TLSContext *server = nullptr;
+		unsigned short version;
+		std::string roots;
+		bool skipVerify = false;
+		size_t capacity;
+		std::mutex mutex;
+		std::unordered_map<std::string, std::string> sessions;
+		std::deque<std::string> order;	// oldest first
+		std::atomic<size_t> full = 0, resumed = 0;
+	};
+
+	// blocking TLS on top of tcpsocket, the buffered reads of tcpsocket return decrypted data
+	class tlssocket : public tcpsocket{
+	public:
+		tlssocket(tlscontext &context);
+
+		#if defined(WINDOWS)
+			tlssocket(tlscontext &context, SOCKET s, SOCKADDR_IN addr);
+		#else
+			tlssocket(tlscontext &context, int handle, struct sockaddr_in addr);
+		#endif
+
+		~tlssocket();
+
+		// accepted connections are returned after a successful handshake
+		tcpsocket* accept(struct timeval timeout) override;
+		bool connect(std::string host, unsigned short port = 443) override;
+		void disconnect() override;
+
+		// plaintext is packed into full records, consecutive records go out with one send
+		bool send(std::string_view data) override;
+		#if !defined(WINDOWS)
+			bool send(std::span<const struct iovec> parts) override;
+			// read and encrypted in user space, the kernel can't encrypt for tlse
+			bool sendFile(int file, off_t offset, size_t len) override;
+		#endif
+
+		bool handshake();
+		bool isResumed() const;
+
+	protected:
+		int read(char *data, size_t len) override;
+
+		#if defined(WINDOWS)
+			tcpsocket* wrap(SOCKET s, SOCKADDR_IN addr) override;
+		#else
+			tcpsocket* wrap(int handle, struct sockaddr_in addr) override;
+		#endif
+
+	private:
+		bool receive();
+		bool flush();
+
+		tlscontext &context;
+		TLSContext *tls = nullptr;
+		std::string peer;
+	};
+
+	// TLS on top of an eventloop connection, the handshake is driven by the loop without blocking it
+	class tlsconnection : public connection{
+	public:
+		tlsconnection(int handle, tlscontext &context);
+		~tlsconnection();
+
+		// called with all decrypted input that hasn't been consumed yet, returns the number of consumed bytes
+		virtual size_t onDecrypted(std::string_view data) = 0;
+		virtual void onHandshake(){}
+
+		size_t onData(std::string_view data) final;
+
+		// everything is encrypted, close sends a close_notify first
+		void send(std::string_view data) override;
+		void send(std::initializer_list<std::string_view> parts) override;
+		// read and encrypted right away, takes ownership of the file descriptor
+		void sendFile(int file, off_t offset, size_t len) override;
+		void close() override;
+
+		bool isEstablished() const;
+		bool isResumed() const;
+
+	private:
+		void flush();
+
+		tlscontext &context;
+		TLSContext *tls;
+		std::string input;
+		bool established = false;
+	};
 }
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <string>
+
+#include "tcpsocket.hpp"
+
+namespace network{
+	// non-blocking datagram socket, one socket serves any number of peers
+	class udpsocket{
+	public:
+		udpsocket(address addr = address::Any, unsigned short port = 0);
+		udpsocket(const udpsocket &other) = delete;
+		~udpsocket();
+
+		udpsocket& operator=(const udpsocket &other) = delete;
+
+		static std::optional<struct sockaddr_in> resolve(const std::string &host, unsigned short port);
+		// ip:port
+		static std::string toString(const struct sockaddr_in &peer);
+
+		// false if the datagram couldn't be sent right away, udp doesn't retry anyway
+		bool sendTo(std::span<const uint8_t> data, const struct sockaddr_in &peer);
+		// size of the received datagram, -1 if none is pending
+		int recvFrom(std::span<uint8_t> buffer, struct sockaddr_in &peer);
+
+		unsigned short getPort() const;
+
+	private:
+		int handle;
+	};
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <linux/io_uring.h>
+
+namespace network{
+	// io_uring on raw syscalls, submission and completion queue plus one ring of provided receive buffers
+	// owned by the thread that creates it, submissions and completions are only handled by that thread
+	class uring{
+	public:
+		static constexpr uint16_t bufferGroup = 0;
+
+		// bufferCount has to be a power of two
+		uring(unsigned entries, unsigned bufferCount, unsigned bufferSize);
+		uring(const uring &other) = delete;
+		~uring();
+
+		uring& operator=(const uring &other) = delete;
+
+		// the kernel allows io_uring and supports everything used here (multishot accept/receive, buffer rings, deferred task work)
+		static bool supported();
+
+		// cleared submission entry, nullptr if the queue is still full after submitting
+		struct io_uring_sqe* next();
+		// submits early if fewer than count entries are free, so a chain of linked entries isn't split
+		void reserve(unsigned count);
+		// submits everything queued and waits for at least one completion
+		bool wait();
+
+		// oldest unhandled completion or nullptr, seen() hands its slot back to the kernel
+		struct io_uring_cqe* peek();
+		void seen();
+
+		// provided buffer a receive completion picked, recycle makes it available for receives again
+		char* buffer(unsigned id);
+		void recycle(unsigned id);
+
+	private:
+		bool submit(unsigned wait);
+		void release();
+
+		int fd = -1;
+		void *ring = nullptr, *sqeMemory = nullptr;
+		size_t ringSize = 0, sqeSize = 0;
+
+		unsigned *sqHead, *sqTail, sqMask, sqEntries, sqLocalTail = 0;
+		struct io_uring_sqe *sqes;
+		unsigned *cqHead, *cqTail, cqMask;
+		struct io_uring_cqe *cqes;
+
+		struct io_uring_buf_ring *buffers = nullptr;
+		char *bufferMemory = nullptr;
+		unsigned bufferCount, bufferSize;
+		uint16_t bufferTail = 0;
+	};
+}
@@ -5,7 +5,25 @@
 
 #include <glad/glad.h>
 
+#include <utils/metrics.hpp>
+
 namespace opengl {
+	// bytes given to buffers and textures, for the metrics endpoint
+	metrics::Counter& uploadBytes();
+	// draw calls and the triangles they rasterize, points and lines count as none
+	metrics::Counter& drawCalls();
+	metrics::Counter& drawnTriangles();
+
+	inline void countDraw(GLenum mode, size_t count) {
+		drawCalls().add();
+		if(mode == GL_TRIANGLES) {
+			drawnTriangles().add(count / 3);
+		}
+		else if((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count > 2) {
+			drawnTriangles().add(count - 2);
+		}
+	}
+
 	template<typename T>
 	class Buffer {
 	public:
@@ -121,6 +139,7 @@ namespace opengl {
 			glBindBuffer(type, handle);
 			glBufferData(type, data.size() * sizeof(T), data.data(), usage);
 			glBindBuffer(type, 0);
+			uploadBytes().add(data.size() * sizeof(T));
 		}
 
 		void setData(const T &data, GLenum usage) {
@@ -129,6 +148,7 @@ namespace opengl {
 			glBindBuffer(type, handle);
 			glBufferData(type, sizeof(T), &data, usage);
 			glBindBuffer(type, 0);
+			uploadBytes().add(sizeof(T));
 		}
 
 		void update(const std::vector<T> &data) {
@@ -136,6 +156,7 @@ namespace opengl {
 				glBindBuffer(type, handle);
 				glBufferSubData(type, 0, m_size * sizeof(T), data.data());
 				glBindBuffer(type, 0);
+				uploadBytes().add(m_size * sizeof(T));
 			}
 		}
 
@@ -144,6 +165,7 @@ namespace opengl {
 				glBindBuffer(type, handle);
 				glBufferSubData(type, 0, sizeof(T), &data);
 				glBindBuffer(type, 0);
+				uploadBytes().add(sizeof(T));
 			}
 		}
 
@@ -70,6 +70,7 @@ namespace opengl {
 			vao.bind();
 			glDrawElements(mode, indexBuffer.size(), GL_UNSIGNED_INT, offset);
 			vao.unbind();
+			countDraw(mode, indexBuffer.size());
 		}
 
 	private:
@@ -118,6 +119,7 @@ namespace opengl {
 			vao.bind();
 			glDrawArrays(mode, offset, vertexBuffer.size());
 			vao.unbind();
+			countDraw(mode, vertexBuffer.size());
 		}
 
 	private:
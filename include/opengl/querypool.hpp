@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <utils/profiler.hpp>
+
+namespace opengl {
+	//	times render passes on the gpu while the profiler captures. passes are marked with GL_TIMESTAMP queries,
+	//	which unlike GL_TIME_ELAPSED can nest. the results of a frame are read frames later once they are available,
+	//	never waiting for them, and recorded on the gpu track of the profiler in the cpu clock.
+	class QueryPool {
+	public:
+		QueryPool(size_t frames = 4, size_t queriesPerFrame = 64);
+		QueryPool(const QueryPool &other) = delete;
+		~QueryPool();
+
+		QueryPool& operator=(const QueryPool &other) = delete;
+
+		// the pool of the current context, created on first use and never destroyed
+		static QueryPool& get();
+
+		// call before the first pass of a frame, records the frames whose results arrived
+		void beginFrame();
+		// false if the pass isn't measured, because there's no capture or no query left
+		bool begin(const char *name);
+		void end();
+
+		// measures the passes within its lifetime, the name has to outlive the capture
+		class Scope {
+		public:
+			Scope(const char *name) : active(photon::profiler::capturing() && get().begin(name)) {}
+			Scope(const Scope &other) = delete;
+
+			~Scope() {
+				if(active) {
+					get().end();
+				}
+			}
+
+			Scope& operator=(const Scope &other) = delete;
+
+		private:
+			bool active;
+		};
+
+	private:
+		struct Pass {
+			const char *name;
+			size_t begin, end;	// into queries
+		};
+
+		struct Frame {
+			std::vector<GLuint> queries;
+			std::vector<Pass> passes;
+			std::vector<size_t> open;
+			size_t used = 0;
+			GLint64 offset = 0;	// cpu minus gpu clock
+			bool recording = false, pending = false;
+		};
+
+		void collect(Frame &frame);
+
+		std::vector<Frame> frames;
+		size_t current = 0;
+		bool supported;
+		photon::profiler::track track = photon::profiler::track("gpu");
+	};
+}
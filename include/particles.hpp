@@ -1,22 +1,12 @@
 #pragma once
 
-#include <memory>
 #include <atomic>
-#include <string>
 #include <vector>
-#include <fstream>
 
 #include <math/matrix.hpp>
 #include <math/vector.hpp>
 
-#include <opengl/buffer.hpp>
-#include <opengl/program.hpp>
-#include <opengl/texture.hpp>
-#include <opengl/uniform.hpp>
-#include <opengl/vao.hpp>
-
 #include "chunk.hpp"
-#include "resources.hpp"
 #include "tile.hpp"
 
 using namespace math;
@@ -42,23 +32,24 @@ struct Particle {
 	void update(float time, float dt, const WorldContainer &world);
 };
 
+// particle simulation, drawn by ParticleRenderer (worldrenderer.hpp)
 class ParticleSystem {
 public:
-	ParticleSystem(std::shared_ptr<TiledTexture> texture = {});
+	ParticleSystem() = default;
 
 	void update(float time, float dt, const WorldContainer &world);
-	void render(mat4 transform);
 
 	void shift(ivec2 dir);
 
-	void setTexture(const std::shared_ptr<TiledTexture> &texture);
-
 	template <typename ...Args>
 	Particle& spawn(Args ...args) {
 		return particles.emplace_back(args...);
 	}
 
 	size_t size();
+	const std::vector<Particle>& data() const;
+	// changes with every update, renderers upload the particles again when it does
+	unsigned getRevision() const;
 
 	Particle& operator[](size_t index);
 	const Particle& operator[](size_t index) const;
@@ -69,15 +60,10 @@ public:
 	template<typename func_t>
 	void erase(func_t func) {
 		std::erase_if(particles, func);
+		revision++;
 	}
 
 private:
 	std::vector<Particle> particles;
-	std::atomic<bool> changed;
-
-	std::shared_ptr<TiledTexture> texture;
-	opengl::Buffer<Particle> buffer;
-	opengl::UniformBuffer<mat4> transformUBO;
-	opengl::VertexArray vao;
-	opengl::Program prog;
+	std::atomic<unsigned> revision = 0;
 };
\ No newline at end of file
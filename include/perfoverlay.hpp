@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include <math/vector.hpp>
+
+#include <utils/profiler.hpp>
+
+#include "gui.hpp"
+
+using namespace math;
+
+// frame times, scope times and renderer counters, collected into fixed rings every frame and drawn with GuiSystem
+class PerfOverlay {
+public:
+	static constexpr size_t history = 1024;	// frames for the lows
+	static constexpr size_t graphFrames = 240;
+	static constexpr size_t maxScopes = 16;
+
+	void toggle();
+	bool isVisible() const;
+
+	// once per frame with the time since the last one
+	void update(float dt);
+	// between GuiSystem::beginFrame and endFrame, pos is the top left corner
+	void render(GuiSystem &gui, vec2 pos);
+
+private:
+	struct Scope {
+		const char *name;
+		int64_t last;
+		float ms;	// per frame, smoothed
+	};
+
+	// frame time that the given share of the frames is slower than
+	float low(float share);
+
+	bool visible = false;
+	std::array<float, history> frameTimes = {};
+	std::array<float, history> sorted;
+	size_t next = 0, frames = 0;
+
+	std::array<photon::profiler::total, maxScopes> totals;
+	std::array<Scope, maxScopes> scopes = {};
+	size_t scopeCount = 0;
+
+	uint64_t drawCalls = 0, triangles = 0, uploadBytes = 0;
+	float frameDrawCalls = 0.0f, frameTriangles = 0.0f, frameUploadBytes = 0.0f;
+};
@@ -14,13 +14,18 @@
 #include "tile.hpp"
 #include "chunk.hpp"
 #include "gui.hpp"
+#include "perfoverlay.hpp"
 #include "world.hpp"
+#include "worldrenderer.hpp"
 #include "resources.hpp"
 #include "entity.hpp"
 #include "player.hpp"
+#include "inputlog.hpp"
 
+#include <atomic>
 #include <sstream>
 #include <iomanip>
+#include <mutex>
 #include <thread>
 
 //#define MULTITHREADING
@@ -42,8 +47,14 @@ public:
 	using Vertex = opengl::Vertex<vec3, vec2>;
 	using Mesh = opengl::Mesh<vec3, vec2>;
 
+	struct Options {
+		std::string record, replay;	// input log paths, both start on a fresh world without storage
+		float fixedDt = 0.0f;	// replaces the recorded dt if set
+		bool vsync = true;
+	};
 
 	Game();
+	Game(const Options &options);
 
 	// gameloop
 	int exec() override;
@@ -70,14 +81,30 @@ public:
 	void onFramebufferResized(ivec2 size) override;
 
 private:
-	double time = 0, dt = 0;
+	bool replayFinished() const;
+	void finishSession();
+
+	double time = 0, dt = 0, elapsed = 0;
 	Camera cam = Camera(vec3(0, 0, -128), vec3(), vec2(1080, 720), 90, 2, 256);
 
-	DynamicWorld<> world;
+	RenderedWorld<> world;
 	std::shared_ptr<TileCursor> cursor;
 	std::shared_ptr<Player> player;
 	ResourceCache<TiledTexture> textures;
 	GuiSystem gui;
+	PerfOverlay overlay;
+
+	Options options;
+	InputLog log;
+	// sampled by updateInputs on the main thread, update takes it into frame on the simulation thread,
+	// so recording and replay stay in lockstep with the ticks with or without MULTITHREADING
+	std::mutex inputMutex;
+	InputLog::Frame input;
+	lvec2 cursorTile;
+	bool respawnClicked = false;	// main thread only
+	InputLog::Frame frame;	// of the current tick
+	std::atomic<size_t> replayed = 0;
+	std::vector<float> frameTimes;	// of the replay, in ms
 };
 
 int main(int argc, const char *argv[]);
@@ -75,6 +75,9 @@ public:
 	void setInput(uint8_t action, float value);
 	void playAnimation(uint8_t animation);
 
+	void saveState(EntityState &state) const override;
+	void loadState(const EntityState &state) override;
+
 protected:
 	bool inputStarted(uint8_t action) const;
 	bool inputStopped(uint8_t action) const;
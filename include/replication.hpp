@@ -0,0 +1,171 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <network/udpsocket.hpp>
+#include <utils/metrics.hpp>
+
+#include "entity.hpp"
+
+class WorldContainer;
+
+//	entity replication over udp. the server sends a snapshot of all entities of a WorldContainer every tick,
+//	entities are identified by their index in WorldContainer::entities().
+//	states are quantized (positions to 1/8 pixel, speeds to 1/4 pixel per second, relative to the world origin)
+//	and delta encoded against the newest snapshot the client acknowledged completely. positions are predicted
+//	from the baseline speed, so an entity that keeps moving at the same speed costs a single bit.
+//	datagrams (little endian, at most 1200 bytes):
+//		sequence u16, ack u16, ackBits u32, type u8
+//		snapshot: tick u32, baseline u8 (ticks back, 0 = none), tickRate u8, part u16, parts u16, first u16, count u16, total u16, bit packed entities
+//	every datagram acks the newest received sequence and the 32 before it in ackBits.
+struct QuantizedState {
+	int32_t pos[2] = {}, speed[2] = {};
+	uint8_t frame = 0, state = 0;
+	bool flipped = false;
+};
+
+// sequence numbers of the own datagrams and the ones that arrived from the peer
+class PacketSequence {
+public:
+	static constexpr size_t headerSize = 9;
+
+	uint16_t next();
+	// sequence, ack, ackBits and type of a new datagram
+	void writeHeader(uint8_t *out, uint8_t type);
+
+	// neither received yet nor too old to be acked anymore
+	bool isNew(uint16_t sequence) const;
+	void received(uint16_t sequence);
+
+	uint16_t ack() const;
+	uint32_t ackBits() const;
+
+	// wrapping comparison, a was sent after b
+	static bool newer(uint16_t a, uint16_t b);
+
+private:
+	uint16_t local = 0, remote = 0;
+	uint32_t bits = 0;
+	bool any = false;
+};
+
+class ReplicationServer {
+public:
+	ReplicationServer(const WorldContainer &world, unsigned short port = 0, uint8_t tickRate = 60, size_t maxClients = 64);
+
+	// captures the entities and sends the snapshot to every client, call once per simulation tick
+	void tick();
+	// handles acks, new clients and timeouts, never blocks
+	void receive();
+
+	unsigned short getPort() const;
+	size_t getClientCount() const;
+	size_t getBytesSent() const;	// udp payload sent to all clients
+	uint32_t getTick() const;
+
+private:
+	struct SentPacket {
+		uint16_t sequence;
+		uint32_t tick;
+		bool acked;
+	};
+
+	struct SentTick {
+		uint32_t tick;
+		uint16_t parts, acked;
+	};
+
+	// per client on the metrics endpoint, labelled with the peer
+	struct ClientMetrics {
+		metrics::Counter bytesSent;
+	};
+
+	struct Client {
+		struct sockaddr_in peer;
+		PacketSequence sequence;
+		std::vector<SentPacket> packets;
+		std::vector<SentTick> ticks;
+		std::optional<uint32_t> baseline;	// newest tick the client has completely
+		std::chrono::steady_clock::time_point lastReceived;
+		std::unique_ptr<ClientMetrics> stats;
+	};
+
+	struct Snapshot {
+		uint32_t tick;
+		std::vector<QuantizedState> states;
+	};
+
+	void capture(Snapshot &snapshot) const;
+	void send(Client &client, const Snapshot &snapshot);
+	void acked(Client &client, uint16_t sequence);
+
+	const WorldContainer &world;
+	network::udpsocket socket;
+	uint8_t tickRate;
+	size_t maxClients;
+	uint32_t currentTick = 1;
+	std::vector<Snapshot> history;
+	std::vector<Client> clients;
+	std::vector<std::vector<uint8_t>> packets;
+	size_t bytesSent = 0;
+};
+
+class ReplicationClient {
+public:
+	// delay is how far the interpolated states lag behind the newest snapshot, a few ticks hide lost datagrams
+	ReplicationClient(const std::string &host, unsigned short port, float delay = 0.1f);
+	ReplicationClient(const ReplicationClient &other) = delete;
+	~ReplicationClient();
+
+	ReplicationClient& operator=(const ReplicationClient &other) = delete;
+
+	// receives and acks snapshots, then advances the interpolation by dt
+	void update(float dt);
+	// loads the interpolated states into the entities with the same index
+	void apply(WorldContainer &world) const;
+
+	// interpolated states, positions relative to the world origin
+	const std::vector<EntityState>& getStates() const;
+	// server time of the interpolated states in seconds
+	double getTime() const;
+	bool isSynchronized() const;
+	size_t getBytesReceived() const;
+
+private:
+	struct Received {
+		uint32_t tick = 0;
+		uint16_t parts = 0, arrived = 0;
+		std::vector<bool> part;
+		std::vector<QuantizedState> states;
+	};
+
+	struct Frame {
+		uint32_t tick;
+		std::vector<EntityState> states;
+	};
+
+	bool receive(std::span<const uint8_t> datagram);
+	void complete(const Received &snapshot);
+	void interpolate(float dt);
+	void send(uint8_t type);
+
+	network::udpsocket socket;
+	struct sockaddr_in server;
+	PacketSequence sequence;
+	float delay;
+	uint8_t tickRate = 0;
+	std::vector<Received> snapshots;
+	std::deque<Frame> frames;
+	std::vector<EntityState> states;
+	uint32_t newest = 0;
+	double time = 0.0;	// in ticks
+	float sinceSent = 0.0f;
+	size_t bytesReceived = 0;
+};
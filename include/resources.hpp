@@ -4,7 +4,7 @@
 #include <vector>
 
 #include <math/vector.hpp>
-#include <math/matrix.hpp>
+#include <math/affine.hpp>
 #include <opengl/texture.hpp>
 #include <utils/image.hpp>
 
@@ -15,13 +15,21 @@ public:
 	TiledTexture(const std::string &path, ivec2 size);
 	TiledTexture(const Image &img);
 
-	vec2 scale() const;
-	ivec2 size() const;
-	ivec2 textureSize() const;
+	// the tile math is inline, simulation code can use it without linking gl
+	vec2 scale() const {
+		return vec2(1.0f) / vec2(m_size);
+	}
 
-	void activate();
+	ivec2 size() const {
+		return m_size;
+	}
 
-	mat4 getUVTransform(ivec2 pos) const;
+	affine2 getUVTransform(ivec2 pos) const {
+		return affine2().scale(scale()).translate(vec2(pos));
+	}
+
+	ivec2 textureSize() const;
+	void activate();
 
 private:
 	opengl::Texture texture;
@@ -34,6 +34,10 @@ public:
 
 	void shift(ivec2 dir) override;
 
+	void saveState(EntityState &state) const override;
+	// replaces the simulation, positions are snapped the same way update does it
+	void loadState(const EntityState &state) override;
+
 	bool checkGround(const WorldContainer &world, float &groundY);
 	bool checkCeiling(const WorldContainer &world, float &ceilingY);
 	bool checkLeft(const WorldContainer &world, float &leftX);
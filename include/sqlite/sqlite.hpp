@@ -3,35 +3,94 @@
 #include "sqlite3.h"
 #include <vector>
 #include <string>
+#include <string_view>
+#include <span>
 #include <array>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <memory>
 #include <variant>
+#include <stdexcept>
+#include <tuple>
 #include <cassert>
 #include <cstring>
 
 namespace sqlite{
 	typedef std::variant<std::monostate, int, double, std::string, std::vector<unsigned char>> variant;
+	typedef std::span<const unsigned char> blob;
 
 	class database;
 
+	// bound string_views and blobs are not copied (SQLITE_STATIC), they have to stay valid until clear() or the next bind()
 	class stmt{
 	public:
-		stmt(std::string querry, database *db, std::vector<variant> values);
+		stmt(std::string_view querry, database *db);
+		stmt(std::string querry, database *db, const std::vector<variant> &values);
+		stmt(const stmt &other) = delete;
 		~stmt();
 
-		void setArgs(std::vector<variant> values);
+		stmt& operator=(const stmt &other) = delete;
+
+		void setArgs(const std::vector<variant> &values);
+
+		template<typename ...Args>
+		stmt& bind(const Args &...args){
+			clear();
+			int i = 1;
+			(bindValue(i++, args), ...);
+			return *this;
+		}
+
+		void bindValue(int i, std::monostate);
+		void bindValue(int i, int value);
+		void bindValue(int i, int64_t value);
+		void bindValue(int i, double value);
+		void bindValue(int i, std::string_view value);
+		void bindValue(int i, const char *value);
+		void bindValue(int i, const std::string &value);
+		void bindValue(int i, blob value);
+		void bindValue(int i, const std::vector<unsigned char> &value);
+		void bindValue(int i, const variant &value);
+
 		inline void reset(){
 			sqlite3_reset(handle);
 			m_status = SQLITE_ROW;
 		}
 
-		template<int n = 0>
-		std::array<variant, n> next(){
+		// reset() keeps the bindings, this drops them as well
+		inline void clear(){
+			reset();
+			sqlite3_clear_bindings(handle);
+		}
+
+		inline int step(){
 			m_status = sqlite3_step(handle);
-			std::string error = sqlite3_errmsg(this->db);
-			if(error != "not an error" && error != "another row available" && error != "column index out of range"){
+			if(m_status != SQLITE_ROW && m_status != SQLITE_DONE){
+				throw std::runtime_error(std::string("sqlite: ") + sqlite3_errmsg(db));
 			}
+			return m_status;
+		}
+
+		// steps once and clears, so the statement doesn't keep pointing into the bound views
+		inline int run(){
+			try{
+				step();
+			}
+			catch(...){
+				clear();
+				throw;
+			}
+			int status = m_status;
+			clear();
+			return status;
+		}
+
+		template<int n = 0>
+		std::array<variant, n> next(){
+			step();
 			std::array<variant, n> row;
-			if(sqlite3_column_count(handle) == n){
+			if(m_status == SQLITE_ROW && sqlite3_column_count(handle) == n){
 				for(int i = 0; i < n; i++){
 					int type = sqlite3_column_type(handle, i);
 					switch(type){
@@ -45,11 +104,8 @@ namespace sqlite{
 							row[i] = std::string(reinterpret_cast<const char*>(sqlite3_column_text(handle, i)));
 						} break;
 						case SQLITE_BLOB:{
-							const void *raw = sqlite3_column_blob(handle, i);
-							int size = sqlite3_column_bytes(handle, i);
-							std::vector<unsigned char> data(size, '\0');
-							memcpy(&data[0], raw, size);
-							row[i] = data;
+							const unsigned char *raw = static_cast<const unsigned char*>(sqlite3_column_blob(handle, i));
+							row[i] = std::vector<unsigned char>(raw, raw + sqlite3_column_bytes(handle, i));
 						} break;
 						case SQLITE_NULL:{
 							row[i] = std::monostate();
@@ -59,17 +115,16 @@ namespace sqlite{
 					}
 				}
 			}
-			else{
-			}
-			error = sqlite3_errmsg(db);
-			if(error != "not an error" && error != "another row available" && error != "column index out of range"){
-			}
 			return row;
 		}
 
 		inline int status(){
 			return m_status;
 		}
+
+		inline sqlite3_stmt* get(){
+			return handle;
+		}
 	private:
 		sqlite3_stmt *handle = nullptr;
 		sqlite3* db;
@@ -77,28 +132,153 @@ namespace sqlite{
 	};
 
 	template<>
-	std::array<variant, 0> stmt::next<0>(){
-		m_status = sqlite3_step(handle);
-		std::string error = sqlite3_errmsg(db);
-		if(error != "not an error" && error != "another row available" && error != "column index out of range"){
-		}
+	inline std::array<variant, 0> stmt::next<0>(){
+		step();
 		return {};
 	}
 
+	// typed column access, text and blob views are only valid until the next step
+	template<typename T>
+	T column(sqlite3_stmt *handle, int i);
+
+	template<>
+	inline int column<int>(sqlite3_stmt *handle, int i){
+		return sqlite3_column_int(handle, i);
+	}
+	template<>
+	inline int64_t column<int64_t>(sqlite3_stmt *handle, int i){
+		return sqlite3_column_int64(handle, i);
+	}
+	template<>
+	inline double column<double>(sqlite3_stmt *handle, int i){
+		return sqlite3_column_double(handle, i);
+	}
+	template<>
+	inline std::string_view column<std::string_view>(sqlite3_stmt *handle, int i){
+		const char *text = reinterpret_cast<const char*>(sqlite3_column_text(handle, i));
+		return std::string_view(text, text ? sqlite3_column_bytes(handle, i) : 0);
+	}
+	template<>
+	inline std::string column<std::string>(sqlite3_stmt *handle, int i){
+		return std::string(column<std::string_view>(handle, i));
+	}
+	template<>
+	inline blob column<blob>(sqlite3_stmt *handle, int i){
+		const unsigned char *data = static_cast<const unsigned char*>(sqlite3_column_blob(handle, i));
+		return blob(data, data ? sqlite3_column_bytes(handle, i) : 0);
+	}
+	template<>
+	inline std::span<const std::byte> column<std::span<const std::byte>>(sqlite3_stmt *handle, int i){
+		return std::as_bytes(column<blob>(handle, i));
+	}
+
+	// the current row of a cursor, columns are read when accessed
+	template<typename ...Ts>
+	class row{
+	public:
+		row(sqlite3_stmt *handle) : handle(handle){}
+
+		template<size_t i>
+		std::tuple_element_t<i, std::tuple<Ts...>> get() const{
+			return column<std::tuple_element_t<i, std::tuple<Ts...>>>(handle, i);
+		}
+
+		std::tuple<Ts...> tuple() const{
+			return tuple(std::index_sequence_for<Ts...>());
+		}
+	private:
+		template<size_t ...i>
+		std::tuple<Ts...> tuple(std::index_sequence<i...>) const{
+			return {get<i>()...};
+		}
+
+		sqlite3_stmt *handle;
+	};
+
+	// single pass range over the results of a statement: for(auto [x, y, data] : db.query<int64_t, int64_t, blob>(...))
+	template<typename ...Ts>
+	class cursor{
+	public:
+		class iterator{
+		public:
+			using difference_type = std::ptrdiff_t;
+			using value_type = row<Ts...>;
+
+			iterator(stmt *s = nullptr) : s(s){}
+
+			row<Ts...> operator*() const{
+				return row<Ts...>(s->get());
+			}
+			iterator& operator++(){
+				if(s->step() != SQLITE_ROW){
+					s = nullptr;
+				}
+				return *this;
+			}
+			void operator++(int){
+				++*this;
+			}
+			bool operator==(std::default_sentinel_t) const{
+				return s == nullptr;
+			}
+		private:
+			stmt *s;
+		};
+
+		cursor(stmt &s) : s(s){}
+		cursor(const cursor &other) = delete;
+		~cursor(){
+			s.clear();
+		}
+
+		cursor& operator=(const cursor &other) = delete;
+
+		iterator begin(){
+			assert(sqlite3_column_count(s.get()) >= int(sizeof...(Ts)));
+			return iterator(s.step() == SQLITE_ROW ? &s : nullptr);
+		}
+		std::default_sentinel_t end(){
+			return {};
+		}
+	private:
+		stmt &s;
+	};
+
 	class database{
 	public:
 		database(std::string fileName);
+		database(const database &other) = delete;
 		~database();
 
+		database& operator=(const database &other) = delete;
+
+		// WAL journal, relaxed fsyncs (durable on checkpoint) and a bigger page cache
+		void enableWAL();
+
+		// runs one or more statements without results, e.g. pragmas
+		void execute(const std::string &querry);
+
+		// statements are prepared once per distinct querry and reused afterwards
+		stmt& prepare(std::string_view querry);
+
+		int changes();
+		int64_t lastInsertRowid();
+
+		// runs on the cached statement, so the same querry can't be nested inside its own loop
+		template<typename ...Ts, typename ...Args>
+		cursor<Ts...> query(std::string_view querry, const Args &...args){
+			return cursor<Ts...>(prepare(querry).bind(args...));
+		}
+
 		template<int n = 0>
-		std::vector<std::array<variant, n>> exec(std::string querry, std::vector<variant> values = {}, int *changes = nullptr){
-			stmt s(querry, this, values);
+		std::vector<std::array<variant, n>> exec(std::string_view querry, const std::vector<variant> &values = {}, int *changes = nullptr){
+			stmt &s = prepare(querry);
+			s.setArgs(values);
 			std::vector<std::array<variant, n>> result;
 			std::array<variant, n> row = s.next<n>();
 			while(s.status() != SQLITE_DONE){
 				result.push_back(row);
 				row = s.next<n>();
-				assert(s.status() != SQLITE_ERROR);
 			}
 			if(changes)
 				*changes = sqlite3_changes(handle);
@@ -107,18 +287,44 @@ namespace sqlite{
 
 	private:
 		sqlite3 *handle = nullptr;
+		std::map<std::string, std::unique_ptr<stmt>, std::less<>> statements;
 		friend class stmt;
 	};
 
 	template<>
-	std::vector<std::array<variant, 0>> database::exec<0>(std::string querry, std::vector<variant> values, int *changes){
-		stmt s(querry, this, values);
+	inline std::vector<std::array<variant, 0>> database::exec<0>(std::string_view querry, const std::vector<variant> &values, int *changes){
+		stmt &s = prepare(querry);
+		s.setArgs(values);
 		while(s.status() != SQLITE_DONE){
 			s.next<0>();
-			assert(s.status() != SQLITE_ERROR);
 		}
 		if(changes)
 			*changes = sqlite3_changes(handle);
 		return {};
 	}
+
+	// rolls back unless commit() was called
+	class transaction{
+	public:
+		transaction(database &db);
+		transaction(const transaction &other) = delete;
+		~transaction();
+
+		transaction& operator=(const transaction &other) = delete;
+
+		void commit();
+	private:
+		database &db;
+		bool done = false;
+	};
+}
+
+namespace std{
+	template<typename ...Ts>
+	struct tuple_size<sqlite::row<Ts...>> : integral_constant<size_t, sizeof...(Ts)>{};
+
+	template<size_t i, typename ...Ts>
+	struct tuple_element<i, sqlite::row<Ts...>>{
+		using type = tuple_element_t<i, tuple<Ts...>>;
+	};
 }
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <math/vector.hpp>
+#include <sqlite/sqlite.hpp>
+
+#include "chunk.hpp"
+#include "chunkdelta.hpp"
+
+using namespace math;
+
+//	drop-in alternative to WorldDB keeping the chunk deltas in a single sqlite database.
+//	writes are buffered and committed in one transaction per flush(), which DynamicWorld calls once per tick.
+//	entities aren't stored, they are created by the game and only known by their index in the world.
+class SqliteWorldDB {
+public:
+	SqliteWorldDB(const std::string &path);
+	SqliteWorldDB(const SqliteWorldDB &other) = delete;
+	~SqliteWorldDB();
+
+	SqliteWorldDB& operator=(const SqliteWorldDB &other) = delete;
+
+	bool read(lvec2 pos, std::vector<uint8_t> &data);
+	void write(lvec2 pos, std::vector<uint8_t> &&data);
+	void erase(lvec2 pos);
+
+	// chunk has to contain the generated baseline, its stored edits are applied on top of it
+	bool load(Chunk &chunk);
+	void save(Chunk &chunk, const Chunk &baseline);
+
+	// func(lvec2 pos, std::span<const uint8_t> data) for every stored chunk in [min, max], the view is only valid during the call
+	template<typename func_t>
+	void scanChunks(lvec2 min, lvec2 max, func_t func) {
+		flush();
+		for(auto [x, y, data] : db.query<int64_t, int64_t, sqlite::blob>("SELECT x, y, data FROM chunks WHERE x BETWEEN ? AND ? AND y BETWEEN ? AND ?", min.x, max.x, min.y, max.y)) {
+			func(lvec2(x, y), data);
+		}
+	}
+
+	void flush();
+	void sync();
+
+	size_t pendingWrites();
+
+private:
+	using Payload = std::shared_ptr<const std::vector<uint8_t>>;
+
+	bool select(std::string_view querry, lvec2 pos, std::vector<uint8_t> &data);
+
+	std::string path;
+	sqlite::database db;
+
+	std::map<lvec2, Payload> pendingChunks;
+};
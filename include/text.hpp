@@ -60,6 +60,7 @@ private:
 	opengl::UniformBuffer<mat4> transformUBO;
 
 	std::vector<Vertex> vertices;
+	std::vector<vec4> corners;	// of the object being built
 	std::vector<unsigned> indices;
 	std::atomic<bool> changed;
 	std::mutex objectMutex;
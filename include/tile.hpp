@@ -22,6 +22,7 @@ public:
 	Tile(const Tile &other) = default;
 
 	Tile& operator=(const Tile &other) = default;
+	bool operator==(const Tile &other) const = default;
 
 	void init(uint32_t type);
 	void update(float time, float dt, ivec2 pos, const Chunk &chunk);
@@ -3,6 +3,8 @@
 #include <string>
 #include <vector>
 
+// only for GLFWimage, the gl headers come from glad
+#define GLFW_INCLUDE_NONE
 #include <glfw/glfw3.h>
 
 #include <stb/stb_image.h>
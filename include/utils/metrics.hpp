@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+//	counters and histograms accumulate into a block of slots owned by the calling thread, only that thread
+//	writes them, so an update is a relaxed load and store without any locked instruction or shared cache line.
+//	a scrape sums the slots of all threads, blocks of threads that exited are folded into a shared one.
+//	metrics register themselves when they are constructed and disappear from scrapes when they are destroyed.
+namespace metrics {
+	using Labels = std::vector<std::pair<std::string, std::string>>;
+
+	namespace detail {
+		static constexpr size_t maxSlots = 2048;
+		static constexpr size_t allocationSlot = 0;	// counted before any metric can be constructed
+
+		extern constinit thread_local std::atomic<uint64_t> *localBlock;
+		std::atomic<uint64_t>* attach();
+
+		inline std::atomic<uint64_t>* block() {
+			return localBlock ? localBlock : attach();
+		}
+
+		inline void add(size_t slot, uint64_t value) {
+			std::atomic<uint64_t> *block = detail::block();
+			block[slot].store(block[slot].load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		}
+
+		inline uint64_t local(size_t slot) {
+			return localBlock ? localBlock[slot].load(std::memory_order_relaxed) : 0;
+		}
+	}
+
+	class Metric {
+	public:
+		enum Type {
+			CounterType,
+			GaugeType,
+			HistogramType,
+		};
+
+		Metric(const std::string &name, const std::string &help, const Labels &labels, Type type, size_t slots);
+		Metric(const Metric &other) = delete;
+		virtual ~Metric();
+
+		Metric& operator=(const Metric &other) = delete;
+
+		const std::string& getName() const;
+
+	protected:
+		friend class Registry;
+		friend struct Detacher;
+
+		// reserved slots, for the counter of allocations
+		Metric(const std::string &name, const std::string &help, Type type, size_t slot);
+
+		std::string name, help;
+		Labels labels;
+		Type type;
+		size_t slot, slots;
+		// what the slots already held when they were reserved. threads write their slots without locking,
+		// so released slots are never zeroed, sums subtract this instead
+		std::vector<uint64_t> base;
+
+		// sums at the start of the current and the last rate window, for rates and recent quantiles
+		std::vector<uint64_t> older, newer;
+		double olderTime = 0.0, newerTime = 0.0;
+	};
+
+	class Counter : public Metric {
+	public:
+		Counter(const std::string &name, const std::string &help, const Labels &labels = {});
+
+		void add(uint64_t value = 1) {
+			detail::add(slot, value);
+		}
+
+		// over all threads, takes the registry lock
+		uint64_t value() const;
+		// only what the calling thread added, without any locking
+		uint64_t threadValue() const {
+			return detail::local(slot);
+		}
+
+	private:
+		friend Counter& allocations();
+		Counter(const std::string &name, const std::string &help, size_t slot);
+	};
+
+	// a value that is set rather than accumulated, one atomic shared by all threads
+	class Gauge : public Metric {
+	public:
+		Gauge(const std::string &name, const std::string &help, const Labels &labels = {});
+
+		void set(double value) {
+			current.store(value, std::memory_order_relaxed);
+		}
+
+		void add(double value) {
+			current.fetch_add(value, std::memory_order_relaxed);
+		}
+
+		double value() const {
+			return current.load(std::memory_order_relaxed);
+		}
+
+	private:
+		std::atomic<double> current = 0.0;
+	};
+
+	// observations are counted in buckets below each bound, quantiles are interpolated within the buckets
+	class Histogram : public Metric {
+	public:
+		Histogram(const std::string &name, const std::string &help, const std::vector<double> &bounds, const Labels &labels = {});
+
+		void observe(double value);
+
+		// count bounds, growing by factor from start
+		static std::vector<double> exponential(double start, double factor, size_t count);
+
+	private:
+		friend class Registry;
+
+		std::vector<double> bounds;
+	};
+
+	class Registry {
+	public:
+		static Registry& get();
+
+		// prometheus text exposition format 0.0.4
+		std::string prometheus();
+		// counters with their rate and histograms with quantiles, both over the last 10 to 20 seconds
+		std::string json();
+
+	private:
+		friend class Metric;
+		friend class Counter;
+		friend std::atomic<uint64_t>* detail::attach();
+		friend struct Detacher;
+
+		Registry();
+
+		size_t reserve(size_t count);
+		void release(size_t slot, size_t count);
+		std::vector<uint64_t> sum(const Metric &metric) const;
+		void window(Metric &metric, double now);
+
+		std::mutex mutex;
+		std::vector<Metric*> metrics;
+		std::vector<std::atomic<uint64_t>*> blocks;
+		std::vector<uint64_t> retired;
+		std::vector<std::pair<size_t, size_t>> freeSlots;	// first, count
+	};
+
+	// heap allocations of all threads, only counted when built with METRICS_ALLOCATIONS
+	Counter& allocations();
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+
+//	while a capture runs, scopes record their begin and end into a buffer owned by the calling thread,
+//	stop() writes all buffers as chrome trace json, which chrome://tracing and ui.perfetto.dev open.
+//	totals sum the time of each scope name without a capture, for overlays.
+//	with neither of them a scope only loads one flag and branches on it.
+namespace photon::profiler {
+	struct Buffer;
+
+	namespace detail {
+		extern std::atomic<bool> capturing, active;	// active -> capturing or summing totals
+
+		void record(const char *name, int64_t begin, int64_t end);
+	}
+
+	// nanoseconds, the clock of all events
+	inline int64_t now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	inline bool capturing() {
+		return detail::capturing.load(std::memory_order_relaxed);
+	}
+
+	// the name has to outlive the capture, usually it is a literal
+	class scope {
+	public:
+		scope(const char *name) : name(name), begin(detail::active.load(std::memory_order_relaxed) ? now() : 0) {}
+		scope(const scope &other) = delete;
+
+		~scope() {
+			if(begin) {
+				detail::record(name, begin, now());
+			}
+		}
+
+		scope& operator=(const scope &other) = delete;
+
+	private:
+		const char *name;
+		int64_t begin;
+	};
+
+	// marks the start of a frame or tick, shown as a line across all threads
+	inline void frame() {
+		if(capturing()) {
+			int64_t time = now();
+			detail::record(nullptr, time, time);
+		}
+	}
+
+	// events measured somewhere else than on the recording thread, like on the gpu, shown on a track of their own.
+	// only one thread may record into a track at a time
+	class track {
+	public:
+		track(const char *name);
+		track(const track &other) = delete;
+		~track();
+
+		track& operator=(const track &other) = delete;
+
+		// begin and end are in the clock of now()
+		void record(const char *name, int64_t begin, int64_t end);
+
+	private:
+		Buffer *buffer;
+	};
+
+	struct total {
+		const char *name;
+		int64_t time;	// nanoseconds
+		uint64_t count;
+	};
+
+	// sums the time spent in the scopes of each name over all threads while enabled
+	void enableTotals(bool enabled);
+	// copies the totals since they were first enabled into out without allocating, returns how many there are
+	size_t totals(std::span<total> out);
+
+	void start();
+	// false if there was no capture or the file couldn't be written
+	bool stop(const std::string &path);
+	// stops a running capture into path, starts one otherwise
+	void toggle(const std::string &path);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// little endian integers and varints for the binary file and network formats
+
+inline void put16(uint8_t *out, uint16_t value) {
+	out[0] = value;
+	out[1] = value >> 8;
+}
+
+inline void put32(uint8_t *out, uint32_t value) {
+	put16(out, value);
+	put16(out + 2, value >> 16);
+}
+
+inline void put64(uint8_t *out, uint64_t value) {
+	put32(out, value);
+	put32(out + 4, value >> 32);
+}
+
+inline uint16_t get16(const uint8_t *in) {
+	return in[0] | in[1] << 8;
+}
+
+inline uint32_t get32(const uint8_t *in) {
+	return get16(in) | uint32_t(get16(in + 2)) << 16;
+}
+
+inline uint64_t get64(const uint8_t *in) {
+	return get32(in) | uint64_t(get32(in + 4)) << 32;
+}
+
+// 7 bits per byte, lowest first, the high bit marks that more follow
+inline void writeVarint(std::vector<uint8_t> &out, uint64_t value) {
+	while(value >= 0x80) {
+		out.push_back(uint8_t(value) | 0x80);
+		value >>= 7;
+	}
+	out.push_back(uint8_t(value));
+}
+
+constexpr size_t varintSize(uint64_t value) {
+	size_t size = 1;
+	while(value >= 0x80) {
+		value >>= 7;
+		size++;
+	}
+	return size;
+}
+
+// consumes the varint from the front of in, false if it is truncated or longer than 64 bits
+inline bool readVarint(std::span<const uint8_t> &in, uint64_t &value) {
+	value = 0;
+	for(unsigned shift = 0; shift < 64; shift += 7) {
+		if(in.empty()) {
+			return false;
+		}
+		uint8_t byte = in.front();
+		in = in.subspan(1);
+		value |= uint64_t(byte & 0x7f) << shift;
+		if(!(byte & 0x80)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// small magnitudes of either sign map to small varints: 0, -1, 1, -2, ...
+inline uint64_t zigzag(int64_t value) {
+	return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) {
+	return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
@@ -1,26 +1,22 @@
 #pragma once
 
-#include <array>
-#include <fstream>
+#include <chrono>
+#include <map>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include <math/matrix.hpp>
 #include <math/vector.hpp>
 
-#include <opengl/program.hpp>
-#include <opengl/texture.hpp>
-#include <opengl/uniform.hpp>
-
 #include <utils/image.hpp>
+#include <utils/metrics.hpp>
+#include <utils/profiler.hpp>
 
-#include "camera.hpp"
 #include "chunk.hpp"
 #include "entity.hpp"
 #include "particles.hpp"
-#include "resources.hpp"
-#include "text.hpp"
-
-#include <mutex>
+#include "worlddb.hpp"
 
 using namespace math;
 
@@ -87,51 +83,34 @@ public:
 	vec2 tileScale;
 };
 
-class WorldRenderer {
-public:
-	WorldRenderer(const WorldContainer &container, const Camera &cam, const std::shared_ptr<Entity> &mainEntity, const std::shared_ptr<TiledTexture> &texture);
-	virtual void render();
-
-	mat4 getCamTransform();
-	std::mutex& getCameraMutex();
-
-protected:
-	struct ModelInfo {
-		mat4 transform, uvtransform;
-	};
-
-	struct CameraInfo {
-		mat4 proj, view;
-	};
-
-	struct RenderInfo {
-		vec4 tint;
-		vec2 res;
-		float time, dt;
-	};
-
-private:
-	const WorldContainer &container;
-	const Camera &cam;
-
-	std::shared_ptr<Entity> mainEntity;
-
-	opengl::Program shader;
-	opengl::Mesh<vec3, vec2> unitplane;
-	opengl::UniformBuffer<ModelInfo> modelInfoUBO;
-	opengl::UniformBuffer<CameraInfo> cameraInfoUBO;
-	opengl::UniformBuffer<RenderInfo> renderInfoUBO;
-
-	std::shared_ptr<TiledTexture> texture;
-
-	std::mutex cameraMutex;
+// what DynamicWorld reports on the metrics endpoint, shared by all worlds
+struct WorldMetrics {
+	metrics::Histogram tickTime;
+#if defined(METRICS_ALLOCATIONS)
+	metrics::Histogram tickAllocations;
+#endif
+	metrics::Gauge chunks, loadQueue, entities, particles;
+	metrics::Counter chunksLoaded;
 };
 
-template<typename Generator_t = WorldGenerator, typename Renderer_t = WorldRenderer>
+WorldMetrics& worldMetrics();
+
+// the simulation of a world without anything that needs gl, RenderedWorld (worldrenderer.hpp) adds the rendering
+template<typename Generator_t = WorldGenerator, typename Storage_t = WorldDB>
 class DynamicWorld : public WorldContainer {
 public:
 	DynamicWorld(const std::shared_ptr<Entity> &mainEntity = {}) : mainEntity(mainEntity) {}
 
+	~DynamicWorld() {
+		if(storage) {
+			for(auto &[pos, chunk] : chunks()) {
+				if(chunk->isModified()) {
+					saveChunk(*chunk);
+				}
+			}
+		}
+	}
+
 	void setMainEntity(const std::shared_ptr<Entity> &mainEntity) {
 		this->mainEntity = mainEntity;
 	}
@@ -142,64 +121,85 @@ public:
 	}
 
 	template<typename ...Args>
-	void initRenderer(Args &&...args) {
-		renderer = std::unique_ptr<Renderer_t>(new Renderer_t(*this, args...));
-	}
-
-	void initParticleSystem(const std::shared_ptr<TiledTexture> texture = {}) {
-		particleSystem = std::unique_ptr<ParticleSystem>(new ParticleSystem(texture));
-	}
-
-	void initTextRenderer(freetype::Font &&font) {
-		textRenderer = std::unique_ptr<TextRenderer>(new TextRenderer(std::move(font)));
-		textRenderer->createObject("Hello World!", mat4().scale(0.2), vec4(1));
+	void initStorage(Args &&...args) {
+		storage = std::unique_ptr<Storage_t>(new Storage_t(args...));
 	}
 
 	void update(float time, float dt) {
+		photon::profiler::scope profile("DynamicWorld::update");
+		WorldMetrics &stats = worldMetrics();
+		auto start = std::chrono::steady_clock::now();
+#if defined(METRICS_ALLOCATIONS)
+		uint64_t allocations = metrics::allocations().threadValue();
+#endif
+
 		updateMainEntity(time, dt);
 		updateChunks(time, dt);
 
-		for(auto &entity : entities()) {
-			entity->update(time, dt, *this);
+		{
+			photon::profiler::scope profile("DynamicWorld::updateEntities");
+			for(auto &entity : entities()) {
+				entity->update(time, dt, *this);
+			}
 		}
 
 		updateParticles(time, dt);
-		textRenderer->update();
-	}
-
-	void render() {
-		mat4 transform = renderer->getCamTransform();
-		if(renderer) {
-			renderer->render();
-		}
 
-		particleSystem->render(transform);
-		textRenderer->render(transform);
+		stats.tickTime.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+#if defined(METRICS_ALLOCATIONS)
+		stats.tickAllocations.observe(metrics::allocations().threadValue() - allocations);
+#endif
+		stats.chunks.set(chunks().size());
+		stats.entities.set(entities().size());
+		stats.particles.set(particleSystem.size());
 	}
 
 	void shift(lvec2 offset) override {
 		WorldContainer::shift(offset);
-		particleSystem->shift(offset);
-		textRenderer->applyTransform(mat4().translate(vec3(vec2(offset) * Chunk::size * Tile::resolution)));
+		particleSystem.shift(offset);
+	}
+
+	ParticleSystem& getParticleSystem() {
+		return particleSystem;
+	}
+
+	const ParticleSystem& getParticleSystem() const {
+		return particleSystem;
 	}
 
 protected:
+	std::shared_ptr<Chunk> generateChunk(lvec2 pos) {
+		if(generator) {
+			return generator->getChunk(pos);
+		}
+		return std::shared_ptr<Chunk>(new Chunk(*this, pos, vec2(1.0f)));
+	}
+
+	// only the difference to the generated chunk gets stored
+	void saveChunk(Chunk &chunk) {
+		storage->save(chunk, *generateChunk(chunk.getPos()));
+	}
+
 	std::shared_ptr<Chunk> loadChunk(lvec2 pos) override {
 		auto chunk = std::as_const(*this).getChunkAbsolute(pos);
 		if(!chunk) {
-			if(generator) {
-				chunk = generator->getChunk(pos);
-			}
-			else {
-				chunk = std::shared_ptr<Chunk>(new Chunk(*this, pos, generator->tileScale));
+			photon::profiler::scope profile("DynamicWorld::loadChunk");
+			chunk = generateChunk(pos);
+			chunk->setModified(false);
+			if(storage) {
+				storage->load(*chunk);
 			}
 			setChunkAbsolute(pos, chunk);
 		}
 		return chunk;
 	}
 
-	void updateMainEntity(float time, float dt) {
-		renderer->getCameraMutex().lock();
+	// keeps the main entity in the center chunk, without one the world stays around its current offset
+	virtual void updateMainEntity(float time, float dt) {
+		if(!mainEntity) {
+			return;
+		}
+		photon::profiler::scope profile("DynamicWorld::updateMainEntity");
 		ivec2 shiftDir;
 
 		if(mainEntity->pos.x < 0.0f) {
@@ -220,11 +220,10 @@ protected:
 		mainEntity->shift(shiftDir);
 
 		mainEntity->update(time, dt, *this);
-
-		renderer->getCameraMutex().unlock();
 	}
 
 	void updateChunks(float time, float dt) {
+		photon::profiler::scope profile("DynamicWorld::updateChunks");
 		std::vector<lvec2> outOfRangeChunks;
 
 		for(auto &[pos, chunk] : chunks()) {
@@ -237,29 +236,46 @@ protected:
 		}
 
 		for(lvec2 pos : outOfRangeChunks) {
+			auto chunk = std::as_const(*this).getChunkAbsolute(pos);
+			if(storage && chunk->isModified()) {
+				saveChunk(*chunk);
+			}
 			eraseChunkAbsolute(pos);
 		}
 
+		// storages that batch their writes commit them once per tick
+		if constexpr(requires { storage->flush(); }) {
+			if(storage) {
+				storage->flush();
+			}
+		}
+
+		// chunks are generated right away, the queue is what this tick had to load
+		size_t loaded = 0;
 		for(int y = -4; y <= 4; y++) {
 			for(int x = -4; x <= 4; x++) {
 				if(!std::as_const(*this).getChunk(lvec2(x, y))) {
 					loadChunk(lvec2(x, y) + offset());
+					loaded++;
 				}
 			}
 		}
+		worldMetrics().loadQueue.set(loaded);
+		worldMetrics().chunksLoaded.add(loaded);
 	}
 
 	void updateParticles(float time, float dt) {
-		if(particleSystem->size() < 8192) {
+		photon::profiler::scope profile("DynamicWorld::updateParticles");
+		if(particleSystem.size() < 8192) {
 			for(unsigned i = 0; i < 16; i++) {
 				vec2 pos = vec2(rand(-1024.0f, 1536.0f), rand(256.0f, 512.0f)) - vec2(0, offset().y * Chunk::size * Tile::resolution);
 				vec2 scale = vec2(1, 8) * rand(0.8, 1.2);
 				vec2 speed = vec2(0.0, rand(-112.0f, -96.0f));
 				vec2 gravity = vec2(0, -1);
-				particleSystem->spawn(Particle::rain, pos, speed, gravity, scale, 0, 0);
+				particleSystem.spawn(Particle::rain, pos, speed, gravity, scale, 0, 0);
 			}
 		}
-		for(Particle &p : *particleSystem) {
+		for(Particle &p : particleSystem) {
 			switch(p.type) {
 				case Particle::rain: {
 					if(p.speed.y == 0.0f || p.pos.y < -512.0f) {
@@ -269,21 +285,20 @@ protected:
 				} break;
 			}
 		}
-		particleSystem->erase([](const Particle &p) -> bool {
+		particleSystem.erase([](const Particle &p) -> bool {
 			if(p.type == Particle::blood && p.lifetime > 10) {
 				return true;
 			}
 			return false;
 		});
 
-		particleSystem->update(time, dt, *this);
+		particleSystem.update(time, dt, *this);
 	}
 
 private:
-	std::unique_ptr<ParticleSystem> particleSystem;
-	std::unique_ptr<TextRenderer> textRenderer;
+	ParticleSystem particleSystem;
 	std::unique_ptr<Generator_t> generator;
-	std::unique_ptr<Renderer_t> renderer;
+	std::unique_ptr<Storage_t> storage;
 
 	std::shared_ptr<Entity> mainEntity;
 };
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <math/vector.hpp>
+
+#include "chunk.hpp"
+#include "chunkdelta.hpp"
+
+using namespace math;
+
+//	world directory: one region file per 8x8 chunks, named r.<x>.<y>.dat
+//	region file:
+//		header[4096]:
+//			magic[4] version[4] reserved[8]
+//			{offset[8], size[4], capacity[4]} * 64	(offset 0 -> chunk isn't stored)
+//		records, appended in write order:
+//			rawsize[4] zlib data[size - 4]
+//	a record is rewritten in place as long as it fits into its capacity, otherwise it gets appended.
+//	a region is compacted once more than half of it is unreachable.
+//	chunks are stored as serialized ChunkDeltas against their generated baseline, unmodified chunks aren't stored at all.
+
+class RegionFile {
+public:
+	static constexpr int64_t shift = 3;
+	static constexpr int64_t size = 1 << shift;
+	static constexpr size_t headerSize = 4096;
+	static constexpr size_t compactThreshold = 256 * 1024;
+
+	RegionFile(const std::string &path);
+	RegionFile(const RegionFile &other) = delete;
+	~RegionFile();
+
+	RegionFile& operator=(const RegionFile &other) = delete;
+
+	// func(std::span<const uint8_t>) is called with a view into the mapped file, which is only valid during the call
+	template<typename func_t>
+	bool read(unsigned index, func_t func) {
+		std::lock_guard<std::mutex> lock(mutex);
+		const Entry &entry = entries[index];
+		if(entry.offset == 0 || !map(entry.offset + entry.size)) {
+			return false;
+		}
+		return func(std::span<const uint8_t>(mapping + entry.offset, entry.size));
+	}
+
+	void write(unsigned index, std::span<const uint8_t> data);
+	void erase(unsigned index);
+	void compact();
+
+	size_t fileSize() const;
+	size_t deadSize() const;
+
+	static lvec2 region(lvec2 pos);
+	static unsigned index(lvec2 pos);
+
+private:
+	struct Entry {
+		uint64_t offset;
+		uint32_t size, capacity;
+	};
+
+	void open();
+	void close();
+	bool map(size_t size);
+	void writeEntry(unsigned index);
+
+	std::string path;
+	mutable std::mutex mutex;
+
+	int fd = -1;
+	const uint8_t *mapping = nullptr;
+	size_t mappedSize = 0, end = headerSize, dead = 0;
+	std::array<Entry, size * size> entries = {};
+};
+
+class WorldDB {
+public:
+	static constexpr int compressionLevel = 5;
+
+	WorldDB(const std::string &path);
+	WorldDB(const WorldDB &other) = delete;
+	~WorldDB();
+
+	WorldDB& operator=(const WorldDB &other) = delete;
+
+	// raw (uncompressed) chunk payloads; writes are compressed and stored by a background thread
+	bool read(lvec2 pos, std::vector<uint8_t> &data);
+	void write(lvec2 pos, std::vector<uint8_t> &&data);
+	void erase(lvec2 pos);
+
+	// chunk has to contain the generated baseline, its stored edits are applied on top of it
+	bool load(Chunk &chunk);
+	void save(Chunk &chunk, const Chunk &baseline);
+
+	// blocks until all pending writes reached the region files
+	void sync();
+
+	size_t pendingWrites();
+
+private:
+	using Payload = std::shared_ptr<const std::vector<uint8_t>>;
+
+	void run();
+	void store(lvec2 pos, const Payload &data);
+	// nullptr if the region has no file yet and create is false
+	RegionFile* region(lvec2 pos, bool create);
+
+	std::string path;
+
+	std::mutex regionMutex;
+	std::map<lvec2, std::unique_ptr<RegionFile>> regions;
+
+	std::mutex mutex;
+	std::condition_variable cv, idle;
+	std::map<lvec2, Payload> pending;
+	std::deque<lvec2> queue;
+	bool quit = false;
+
+	std::thread worker;
+};
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <math/affine.hpp>
+#include <math/matrix.hpp>
+#include <math/vector.hpp>
+
+#include <opengl/buffer.hpp>
+#include <opengl/mesh.hpp>
+#include <opengl/querypool.hpp>
+#include <opengl/program.hpp>
+#include <opengl/texture.hpp>
+#include <opengl/uniform.hpp>
+#include <opengl/vao.hpp>
+
+#include "camera.hpp"
+#include "chunk.hpp"
+#include "chunkgeometry.hpp"
+#include "entity.hpp"
+#include "particles.hpp"
+#include "resources.hpp"
+#include "text.hpp"
+#include "world.hpp"
+
+using namespace math;
+
+// tile geometry of one chunk, rebuilt on the update thread whenever the revision of the chunk changes.
+// only the finished geometry is handed to the render thread, under the mutex WorldRenderer passes in
+class ChunkMesh {
+public:
+	using Mesh = opengl::IndexedMesh<vec3, vec2>;
+
+	// update thread, the tiles are only read on the thread that writes them
+	void build(const std::shared_ptr<const Chunk> &chunk, std::mutex &mutex);
+	// render thread, with the mutex held
+	void render();
+
+	bool loaded = true;	// false once the chunk is gone, the render thread drops the mesh then
+
+private:
+	std::unique_ptr<Mesh> mesh;
+	ChunkGeometry building, ready;
+	bool sync = false;
+
+	std::weak_ptr<const Chunk> built;
+	unsigned revision = 0;
+};
+
+class ParticleRenderer {
+public:
+	ParticleRenderer(std::shared_ptr<TiledTexture> texture = {});
+
+	void render(const ParticleSystem &particles, mat4 transform);
+
+	void setTexture(const std::shared_ptr<TiledTexture> &texture);
+
+private:
+	std::shared_ptr<TiledTexture> texture;
+	opengl::Buffer<Particle> buffer;
+	opengl::UniformBuffer<mat4> transformUBO;
+	opengl::VertexArray vao;
+	opengl::Program prog;
+
+	unsigned revision = 0;
+};
+
+class WorldRenderer {
+public:
+	WorldRenderer(const WorldContainer &container, const Camera &cam, const std::shared_ptr<Entity> &mainEntity, const std::shared_ptr<TiledTexture> &texture);
+	virtual void render();
+	// update thread, builds the geometry of the chunks near the camera that changed
+	void build();
+
+	mat4 getCamTransform();
+	std::mutex& getCameraMutex();
+
+protected:
+	struct ModelInfo {
+		std::array<vec4, 2> transform, uvtransform;	// affine2::pack()
+	};
+
+	struct CameraInfo {
+		mat4 proj, view;
+	};
+
+	struct RenderInfo {
+		vec4 tint;
+		vec2 res;
+		float time, dt;
+	};
+
+private:
+	const WorldContainer &container;
+	const Camera &cam;
+
+	std::shared_ptr<Entity> mainEntity;
+
+	opengl::Program shader;
+	opengl::Mesh<vec3, vec2> unitplane;
+	opengl::UniformBuffer<ModelInfo> modelInfoUBO;
+	opengl::UniformBuffer<CameraInfo> cameraInfoUBO;
+	opengl::UniformBuffer<RenderInfo> renderInfoUBO;
+
+	std::shared_ptr<TiledTexture> texture;
+	std::map<lvec2, ChunkMesh> meshes;	// by absolute chunk position
+
+	std::mutex cameraMutex;
+	std::mutex meshMutex;	// guards meshes and the geometry handover
+};
+
+// DynamicWorld with everything that draws it, needs a current gl context
+template<typename Generator_t = WorldGenerator, typename Renderer_t = WorldRenderer, typename Storage_t = WorldDB>
+class RenderedWorld : public DynamicWorld<Generator_t, Storage_t> {
+public:
+	using Simulation = DynamicWorld<Generator_t, Storage_t>;
+
+	using Simulation::Simulation;
+
+	template<typename ...Args>
+	void initRenderer(Args &&...args) {
+		renderer = std::unique_ptr<Renderer_t>(new Renderer_t(*this, args...));
+	}
+
+	void initParticleRenderer(const std::shared_ptr<TiledTexture> texture = {}) {
+		particleRenderer = std::unique_ptr<ParticleRenderer>(new ParticleRenderer(texture));
+	}
+
+	void initTextRenderer(freetype::Font &&font) {
+		textRenderer = std::unique_ptr<TextRenderer>(new TextRenderer(std::move(font)));
+		textRenderer->createObject("Hello World!", mat4().scale(0.2), vec4(1));
+	}
+
+	void update(float time, float dt) {
+		Simulation::update(time, dt);
+		if(renderer) {
+			renderer->build();
+		}
+		if(textRenderer) {
+			textRenderer->update();
+		}
+	}
+
+	void render() {
+		if(!renderer) {
+			return;
+		}
+		mat4 transform = renderer->getCamTransform();
+		renderer->render();
+
+		if(particleRenderer) {
+			opengl::QueryPool::Scope pass("particles");
+			particleRenderer->render(this->getParticleSystem(), transform);
+		}
+		if(textRenderer) {
+			opengl::QueryPool::Scope pass("world text");
+			textRenderer->render(transform);
+		}
+	}
+
+	void shift(lvec2 offset) override {
+		Simulation::shift(offset);
+		if(textRenderer) {
+			textRenderer->applyTransform(mat4().translate(vec3(vec2(offset) * Chunk::size * Tile::resolution)));
+		}
+	}
+
+protected:
+	// the renderer reads the camera the main entity moves
+	void updateMainEntity(float time, float dt) override {
+		std::unique_lock<std::mutex> lock;
+		if(renderer) {
+			lock = std::unique_lock<std::mutex>(renderer->getCameraMutex());
+		}
+		Simulation::updateMainEntity(time, dt);
+	}
+
+private:
+	std::unique_ptr<Renderer_t> renderer;
+	std::unique_ptr<ParticleRenderer> particleRenderer;
+	std::unique_ptr<TextRenderer> textRenderer;
+};
@@ -5,7 +5,8 @@ Camera::Camera(vec3 pos, vec3 rot, vec2 res, float fov, float znear, float zfar)
 
 void Camera::update() {
 	m_proj = mat4::projection(d2r(fov), res.x / res.y, znear, zfar);
-	m_view = mat4().translate(pos).rotate(rot).inverse();
+	m_projInverse = m_proj.inverse();
+	m_view = mat4().translate(pos).rotate(rot).affineInverse();
 }
 
 mat4 Camera::proj() const {
@@ -15,3 +16,7 @@ mat4 Camera::proj() const {
 mat4 Camera::view() const {
 	return m_view;
 }
+
+mat4 Camera::projInverse() const {
+	return m_projInverse;
+}
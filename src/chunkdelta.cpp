@@ -0,0 +1,119 @@
+#include <chunkdelta.hpp>
+
+#include <algorithm>
+
+#include <utils/serialization.hpp>
+
+ChunkDelta::ChunkDelta(const Chunk &baseline, const Chunk &chunk) {
+	std::span<const Tile> base = baseline.data(), tiles = chunk.data();
+	for(unsigned i = 0; i < tiles.size(); i++) {
+		if(tiles[i] == base[i]) {
+			continue;
+		}
+		if(m_runs.empty() || m_runs.back().begin + m_runs.back().tiles.size() != i) {
+			m_runs.push_back({uint16_t(i), {}});
+		}
+		m_runs.back().tiles.push_back(tiles[i]);
+	}
+}
+
+void ChunkDelta::apply(Chunk &chunk) const {
+	std::span<Tile> tiles = chunk.data();
+	for(const Run &run : m_runs) {
+		std::copy(run.tiles.begin(), run.tiles.end(), tiles.begin() + run.begin);
+	}
+}
+
+void ChunkDelta::set(unsigned index, const Tile &tile) {
+	auto it = std::upper_bound(m_runs.begin(), m_runs.end(), index, [](unsigned index, const Run &run) {
+		return index < run.begin;
+	});
+
+	if(it != m_runs.begin()) {
+		Run &prev = *(it - 1);
+		if(index < prev.begin + prev.tiles.size()) {
+			prev.tiles[index - prev.begin] = tile;
+			return;
+		}
+		if(index == prev.begin + prev.tiles.size()) {
+			prev.tiles.push_back(tile);
+			if(it != m_runs.end() && it->begin == index + 1) {
+				prev.tiles.insert(prev.tiles.end(), it->tiles.begin(), it->tiles.end());
+				m_runs.erase(it);
+			}
+			return;
+		}
+	}
+
+	if(it != m_runs.end() && it->begin == index + 1) {
+		it->begin--;
+		it->tiles.insert(it->tiles.begin(), tile);
+		return;
+	}
+	m_runs.insert(it, {uint16_t(index), {tile}});
+}
+
+bool ChunkDelta::empty() const {
+	return m_runs.empty();
+}
+
+size_t ChunkDelta::size() const {
+	size_t count = 0;
+	for(const Run &run : m_runs) {
+		count += run.tiles.size();
+	}
+	return count;
+}
+
+const std::vector<ChunkDelta::Run>& ChunkDelta::runs() const {
+	return m_runs;
+}
+
+std::vector<uint8_t> ChunkDelta::serialize() const {
+	std::vector<uint8_t> out;
+	writeVarint(out, m_runs.size());
+
+	unsigned end = 0;
+	for(const Run &run : m_runs) {
+		writeVarint(out, run.begin - end);
+		writeVarint(out, run.tiles.size());
+		for(const Tile &tile : run.tiles) {
+			writeVarint(out, tile.type);
+			writeVarint(out, tile.variant);
+			writeVarint(out, tile.custom);
+		}
+		end = run.begin + run.tiles.size();
+	}
+	return out;
+}
+
+bool ChunkDelta::deserialize(std::span<const uint8_t> data, ChunkDelta &delta) {
+	constexpr uint64_t tileCount = Chunk::size * Chunk::size;
+	delta.m_runs.clear();
+
+	uint64_t runCount;
+	if(!readVarint(data, runCount) || runCount > tileCount) {
+		return false;
+	}
+
+	uint64_t end = 0;
+	delta.m_runs.resize(runCount);
+	for(Run &run : delta.m_runs) {
+		uint64_t skip, length;
+		if(!readVarint(data, skip) || !readVarint(data, length) || skip > tileCount || length > tileCount || end + skip + length > tileCount) {
+			return false;
+		}
+		run.begin = end + skip;
+		run.tiles.resize(length);
+		for(Tile &tile : run.tiles) {
+			uint64_t type, variant;
+			if(!readVarint(data, type) || !readVarint(data, variant) || !readVarint(data, tile.custom) || type > UINT32_MAX || variant > UINT32_MAX) {
+				return false;
+			}
+			tile.type = type;
+			tile.variant = variant;
+		}
+		end = run.begin + length;
+	}
+	return data.empty();
+}
@@ -0,0 +1,61 @@
+#include <chunkgeometry.hpp>
+
+#include <array>
+
+#include <utils/profiler.hpp>
+
+void ChunkGeometry::build(const Chunk &chunk) {
+	photon::profiler::scope profile("ChunkGeometry::build");
+	vertices.clear();
+	indices.clear();
+
+	auto addQuad = [&](std::array<Vertex, 4> quad) {
+		unsigned indexBase = vertices.size();
+		vertices.push_back(quad[0]);
+		vertices.push_back(quad[1]);
+		vertices.push_back(quad[2]);
+		vertices.push_back(quad[3]);
+
+		indices.push_back(indexBase + 0);
+		indices.push_back(indexBase + 1);
+		indices.push_back(indexBase + 2);
+		indices.push_back(indexBase + 2);
+		indices.push_back(indexBase + 3);
+		indices.push_back(indexBase + 0);
+	};
+
+	std::span<const Tile> tiles = chunk.data();
+	vec2 tileScale = chunk.getTileScale();
+	for(unsigned y = 0; y < Chunk::size; y++) {
+		for(unsigned x = 0; x < Chunk::size; x++) {
+			const Tile &current = tiles[y * Chunk::size + x];
+			if(current.visible()) {
+				vec2 bl = vec2(x, y) * Tile::resolution;
+				vec2 tr = bl + vec2(1) * Tile::resolution;
+				vec2 tl = vec2(bl.x, tr.y);
+				vec2 br = vec2(tr.x, bl.y);
+
+				vec2 uvtl = current.texture(svec2(x, y)) * tileScale;
+				vec2 uvbr = uvtl + tileScale;
+				uvtl += vec2(0.000001), uvbr -= vec2(0.000001);
+				vec2 uvbl = vec2(uvtl.x, uvbr.y);
+				vec2 uvtr = vec2(uvbr.x, uvtl.y);
+
+				addQuad({
+					Vertex { vec3(bl), uvbl },
+					Vertex { vec3(br), uvbr },
+					Vertex { vec3(tr), uvtr },
+					Vertex { vec3(tl), uvtl },
+				});
+			}
+		}
+	}
+}
+
+const std::vector<ChunkGeometry::Vertex>& ChunkGeometry::getVertices() const {
+	return vertices;
+}
+
+const std::vector<unsigned>& ChunkGeometry::getIndices() const {
+	return indices;
+}
@@ -0,0 +1,680 @@
+#include <chunkstream.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include <utils/serialization.hpp>
+
+#include <world.hpp>
+
+enum PacketType : uint8_t {
+	ChunksPacket = 0,
+	InterestPacket,
+	DisconnectPacket,
+};
+
+enum RecordKind : uint8_t {
+	SliceRecord = 0,
+	CachedRecord,
+};
+
+static constexpr unsigned sentPackets = 1024;	// datagrams per client that can still be acked
+static constexpr size_t maxPacketSize = 1200;	// below the mtu of most paths, nothing gets fragmented
+static constexpr size_t headerSize = PacketSequence::headerSize, recordSize = 1 + 2 * 5 + 8 + 2 * 3;	// largest record without its bytes
+static constexpr size_t maxMissing = 64;
+static constexpr float resendInterval = 0.1f;	// interest is sent at least this often, also serves as hello
+static constexpr double clientTimeout = 5.0;
+static constexpr double encodedLifetime = 10.0;	// encoded chunks no client asked for are dropped after this
+static constexpr int keepDistance = 2;	// chunks that left the radius by more than this are forgotten
+
+static void writePos(std::vector<uint8_t> &out, lvec2 pos) {
+	for(int64_t v : {int64_t(pos.x), int64_t(pos.y)}) {
+		writeVarint(out, zigzag(v));
+	}
+}
+
+static bool readPos(std::span<const uint8_t> &in, lvec2 &pos) {
+	uint64_t x, y;
+	if(!readVarint(in, x) || !readVarint(in, y)) {
+		return false;
+	}
+	pos = lvec2(unzigzag(x), unzigzag(y));
+	return true;
+}
+
+static float distance(vec2 camera, lvec2 pos) {
+	return length(vec2(pos) + vec2(0.5f) - camera);
+}
+
+static bool inRange(vec2 camera, uint8_t radius, lvec2 pos) {
+	return distance(camera, pos) <= radius + keepDistance;
+}
+
+static size_t sliceCount(size_t size) {
+	return std::max<size_t>((size + ChunkStreamServer::sliceSize - 1) / ChunkStreamServer::sliceSize, 1);
+}
+
+std::vector<uint8_t> ChunkCodec::encode(std::span<const Tile> tiles) {
+	std::vector<Tile> palette;
+	std::vector<std::pair<size_t, size_t>> runs;
+	for(size_t i = 0; i < tiles.size(); i++) {
+		if(i > 0 && tiles[i] == tiles[i - 1]) {
+			runs.back().first++;
+			continue;
+		}
+		size_t index = std::find(palette.begin(), palette.end(), tiles[i]) - palette.begin();
+		if(index == palette.size()) {
+			palette.push_back(tiles[i]);
+		}
+		runs.push_back({1, index});
+	}
+
+	std::vector<uint8_t> out;
+	writeVarint(out, palette.size());
+	for(const Tile &tile : palette) {
+		writeVarint(out, tile.type);
+		writeVarint(out, tile.variant);
+		writeVarint(out, tile.custom);
+	}
+	for(auto [length, index] : runs) {
+		writeVarint(out, length);
+		writeVarint(out, index);
+	}
+	return out;
+}
+
+bool ChunkCodec::decode(std::span<const uint8_t> data, std::span<Tile> tiles) {
+	uint64_t count;
+	if(!readVarint(data, count) || count > tiles.size()) {
+		return false;
+	}
+	std::vector<Tile> palette(count);
+	for(Tile &tile : palette) {
+		uint64_t type, variant;
+		if(!readVarint(data, type) || !readVarint(data, variant) || !readVarint(data, tile.custom) || type > UINT32_MAX || variant > UINT32_MAX) {
+			return false;
+		}
+		tile.type = type;
+		tile.variant = variant;
+	}
+
+	size_t i = 0;
+	while(i < tiles.size()) {
+		uint64_t length, index;
+		if(!readVarint(data, length) || !readVarint(data, index) || length == 0 || length > tiles.size() - i || index >= palette.size()) {
+			return false;
+		}
+		std::fill_n(tiles.begin() + i, length, palette[index]);
+		i += length;
+	}
+	return data.empty();
+}
+
+uint64_t ChunkCodec::hash(std::span<const uint8_t> data) {
+	// fnv-1a
+	uint64_t hash = 0xcbf29ce484222325;
+	for(uint8_t byte : data) {
+		hash = (hash ^ byte) * 0x100000001b3;
+	}
+	return hash;
+}
+
+ChunkStreamServer::ChunkStreamServer(WorldContainer &world, unsigned short port, size_t rate, size_t maxClients, uint8_t maxRadius)
+ : world(world), socket(network::address::Any, port), rate(std::max<size_t>(rate, maxPacketSize)), maxClients(maxClients), maxRadius(maxRadius) {}
+
+void ChunkStreamServer::update(float dt) {
+	time += dt;
+	receive();
+	for(Client &client : clients) {
+		send(client, dt);
+	}
+	std::erase_if(encoded, [&](const auto &entry) {
+		return time - entry.second.used > encodedLifetime;
+	});
+}
+
+void ChunkStreamServer::receive() {
+	std::array<uint8_t, maxPacketSize> buffer;
+	struct sockaddr_in peer;
+	int len;
+	while((len = socket.recvFrom(buffer, peer)) >= 0) {
+		if(len < int(headerSize)) {
+			continue;
+		}
+		auto it = std::find_if(clients.begin(), clients.end(), [&](const Client &client) {
+			return client.peer.sin_addr.s_addr == peer.sin_addr.s_addr && client.peer.sin_port == peer.sin_port;
+		});
+		if(buffer[8] == DisconnectPacket) {
+			if(it != clients.end()) {
+				clients.erase(it);
+			}
+			continue;
+		}
+		if(buffer[8] != InterestPacket) {
+			continue;
+		}
+		if(it == clients.end()) {
+			if(clients.size() >= maxClients) {
+				continue;
+			}
+			clients.push_back({});
+			it = clients.end() - 1;
+			it->peer = peer;
+			it->packets.resize(sentPackets);
+			metrics::Labels labels = {{"peer", network::udpsocket::toString(peer)}};
+			it->stats.reset(new ClientMetrics{
+				metrics::Counter("photon_chunkstream_bytes_sent_total", "chunk stream bytes sent to a client", labels),
+				metrics::Counter("photon_chunkstream_slices_resent_total", "chunk slices sent again after they were lost", labels),
+				metrics::Gauge("photon_chunkstream_rtt_seconds", "smoothed round trip time of a client", labels),
+			});
+		}
+		receive(*it, std::span(buffer.data(), len));
+	}
+
+	std::erase_if(clients, [&](const Client &client) {
+		return time - client.lastReceived > clientTimeout;
+	});
+}
+
+void ChunkStreamServer::receive(Client &client, std::span<const uint8_t> datagram) {
+	uint16_t sequence = get16(datagram.data());
+	if(!client.sequence.isNew(sequence) || datagram.size() < headerSize + 13) {
+		return;
+	}
+
+	std::span<const uint8_t> in = datagram.subspan(headerSize);
+	float camera[2];
+	std::memcpy(camera, in.data(), sizeof(camera));
+	uint8_t radius = std::min(in[8], maxRadius);
+	size_t cacheSize = get16(&in[9]), missingCount = get16(&in[11]);
+	in = in.subspan(13);
+	std::vector<lvec2> missing(std::min(missingCount, maxMissing));
+	for(lvec2 &pos : missing) {
+		if(!readPos(in, pos)) {
+			return;
+		}
+	}
+	if(!std::isfinite(camera[0]) || !std::isfinite(camera[1])) {
+		return;
+	}
+
+	client.sequence.received(sequence);
+	client.lastReceived = time;
+	// interest from datagrams that overtook this one is newer
+	if(!PacketSequence::newer(client.sequence.ack(), sequence)) {
+		client.camera = vec2(camera[0], camera[1]);
+		client.radius = radius;
+		client.cacheSize = cacheSize;
+	}
+
+	uint16_t ack = get16(&datagram[2]);
+	uint32_t ackBits = get32(&datagram[4]);
+	acked(client, ack);
+	for(unsigned i = 0; i < 32; i++) {
+		if(ackBits & (1u << i)) {
+			acked(client, ack - i - 1);
+		}
+	}
+
+	// the client evicted chunks it was told to take from its cache, they have to be sent as data
+	for(lvec2 pos : missing) {
+		auto it = client.delivered.find(pos);
+		if(it != client.delivered.end()) {
+			client.cache.erase(it->second);
+			client.delivered.erase(it);
+		}
+		auto transfer = client.transfers.find(pos);
+		if(transfer != client.transfers.end() && transfer->second.cached) {
+			client.cache.erase(transfer->second.hash);
+			client.transfers.erase(transfer);
+		}
+	}
+}
+
+void ChunkStreamServer::acked(Client &client, uint16_t sequence) {
+	SentPacket &packet = client.packets[sequence % sentPackets];
+	if(packet.sequence != sequence || packet.acked) {
+		return;
+	}
+	packet.acked = true;
+
+	double rtt = time - packet.time;
+	client.rtt += (rtt - client.rtt) / 8.0;
+	client.stats->rtt.set(client.rtt);
+
+	for(const Record &record : packet.records) {
+		auto it = client.transfers.find(record.pos);
+		if(it == client.transfers.end() || it->second.hash != record.hash || it->second.cached != (record.slice < 0)) {
+			continue;
+		}
+		Transfer &transfer = it->second;
+		uint8_t &slice = transfer.slices[std::max(record.slice, 0)];
+		if(slice == Acked) {
+			continue;
+		}
+		slice = Acked;
+		if(++transfer.acked == transfer.slices.size()) {
+			client.delivered[record.pos] = record.hash;
+			remember(client, record.hash);
+			(transfer.cached ? chunksReferenced : chunksSent)++;
+			client.transfers.erase(it);
+		}
+	}
+}
+
+void ChunkStreamServer::lost(Client &client, const SentPacket &packet) {
+	for(const Record &record : packet.records) {
+		auto it = client.transfers.find(record.pos);
+		if(it != client.transfers.end() && it->second.hash == record.hash && it->second.cached == (record.slice < 0)) {
+			uint8_t &slice = it->second.slices[std::max(record.slice, 0)];
+			if(slice == InFlight) {
+				slice = Pending;
+				slicesResent++;
+				client.stats->slicesResent.add();
+			}
+		}
+	}
+}
+
+void ChunkStreamServer::remember(Client &client, uint64_t hash) {
+	client.cache[hash] = time;
+	// mirrors the client's lru, an entry it evicted differently is reported as missing
+	while(client.cache.size() > client.cacheSize && !client.cache.empty()) {
+		client.cache.erase(std::min_element(client.cache.begin(), client.cache.end(), [](const auto &a, const auto &b) {
+			return a.second < b.second;
+		}));
+	}
+}
+
+const ChunkStreamServer::Encoded* ChunkStreamServer::encode(lvec2 pos) {
+	// clients only get what the simulation has loaded anyway, a chunk that got unloaded can't have changed since
+	std::shared_ptr<const Chunk> chunk = std::as_const(world).getChunkAbsolute(pos);
+	auto it = encoded.find(pos);
+	if(!chunk && it == encoded.end()) {
+		return nullptr;
+	}
+	if(it == encoded.end()) {
+		it = encoded.emplace(pos, Encoded()).first;
+	}
+
+	Encoded &entry = it->second;
+	if(chunk && (entry.source.lock() != chunk || entry.revision != chunk->getRevision() || entry.data.empty())) {
+		entry.source = chunk;
+		entry.revision = chunk->getRevision();
+		entry.data = ChunkCodec::encode(chunk->data());
+		entry.hash = ChunkCodec::hash(entry.data);
+	}
+	entry.used = time;
+	return &entry;
+}
+
+void ChunkStreamServer::send(Client &client, float dt) {
+	double timeout = std::max(client.rtt * 2.0, 0.05) + resendInterval;
+	auto first = client.unacked.begin();
+	for(; first != client.unacked.end(); first++) {
+		SentPacket &packet = client.packets[*first % sentPackets];
+		if(packet.sequence == *first && !packet.acked) {
+			if(time - packet.time < timeout) {
+				break;
+			}
+			lost(client, packet);
+			packet.acked = true;
+		}
+	}
+	client.unacked.erase(client.unacked.begin(), first);
+
+	std::erase_if(client.delivered, [&](const auto &entry) {
+		return !inRange(client.camera, client.radius, entry.first);
+	});
+	std::erase_if(client.transfers, [&](const auto &entry) {
+		return !inRange(client.camera, client.radius, entry.first);
+	});
+
+	// a burst of a tenth of a second, an idle client doesn't save up more
+	double burst = std::max(rate / 10.0, double(maxPacketSize));
+	client.tokens = std::min(client.tokens + rate * dt, burst);
+	if(client.tokens <= 0.0 || client.radius == 0) {
+		return;
+	}
+
+	std::vector<std::pair<float, lvec2>> wanted;
+	int radius = client.radius;
+	lvec2 center = lvec2(std::floor(client.camera.x), std::floor(client.camera.y));
+	for(int y = -radius; y <= radius; y++) {
+		for(int x = -radius; x <= radius; x++) {
+			lvec2 pos = center + lvec2(x, y);
+			float d = distance(client.camera, pos);
+			if(d <= radius) {
+				wanted.push_back({d, pos});
+			}
+		}
+	}
+	std::sort(wanted.begin(), wanted.end(), [](const auto &a, const auto &b) {
+		return a.first < b.first;
+	});
+
+	std::vector<uint8_t> packet;
+	std::vector<Record> records;
+	auto flush = [&]() {
+		if(records.empty()) {
+			return;
+		}
+		client.sequence.writeHeader(packet.data(), ChunksPacket);
+		uint16_t sequence = get16(packet.data());
+		SentPacket &sent = client.packets[sequence % sentPackets];
+		// the slot is reused, whatever wasn't acked in it by now won't be
+		if(!sent.acked) {
+			lost(client, sent);
+		}
+		sent = {sequence, time, false, std::move(records)};
+		client.unacked.push_back(sequence);
+		if(socket.sendTo(packet, client.peer)) {
+			bytesSent += packet.size();
+			client.stats->bytesSent.add(packet.size());
+		}
+		client.tokens -= packet.size();
+		records.clear();
+	};
+
+	for(auto [d, pos] : wanted) {
+		if(client.tokens <= 0.0) {
+			break;
+		}
+		const Encoded *entry = encode(pos);
+		if(!entry) {
+			continue;
+		}
+		auto delivered = client.delivered.find(pos);
+		if(delivered != client.delivered.end() && delivered->second == entry->hash) {
+			continue;
+		}
+
+		Transfer &transfer = client.transfers[pos];
+		if(transfer.slices.empty() || transfer.hash != entry->hash) {
+			bool cached = client.cache.contains(entry->hash);
+			transfer = {entry->hash, cached, std::vector<uint8_t>(cached ? 1 : sliceCount(entry->data.size()), Pending)};
+		}
+
+		for(size_t slice = 0; slice < transfer.slices.size() && client.tokens > 0.0; slice++) {
+			if(transfer.slices[slice] != Pending) {
+				continue;
+			}
+			size_t begin = slice * sliceSize, size = transfer.cached ? 0 : std::min(sliceSize, entry->data.size() - begin);
+			if(!packet.empty() && packet.size() + recordSize + size > maxPacketSize) {
+				flush();
+				packet.clear();
+				if(client.tokens <= 0.0) {
+					break;
+				}
+			}
+			if(packet.empty()) {
+				packet.resize(headerSize);
+			}
+
+			packet.push_back(transfer.cached ? CachedRecord : SliceRecord);
+			writePos(packet, pos);
+			packet.resize(packet.size() + 8);
+			put64(&packet[packet.size() - 8], entry->hash);
+			if(!transfer.cached) {
+				writeVarint(packet, entry->data.size());
+				writeVarint(packet, slice);
+				packet.insert(packet.end(), entry->data.begin() + begin, entry->data.begin() + begin + size);
+			}
+			records.push_back({pos, entry->hash, transfer.cached ? -1 : int32_t(slice)});
+			transfer.slices[slice] = InFlight;
+		}
+	}
+	flush();
+}
+
+unsigned short ChunkStreamServer::getPort() const {
+	return socket.getPort();
+}
+
+size_t ChunkStreamServer::getClientCount() const {
+	return clients.size();
+}
+
+size_t ChunkStreamServer::getBytesSent() const {
+	return bytesSent;
+}
+
+size_t ChunkStreamServer::getChunksSent() const {
+	return chunksSent;
+}
+
+size_t ChunkStreamServer::getChunksReferenced() const {
+	return chunksReferenced;
+}
+
+size_t ChunkStreamServer::getSlicesResent() const {
+	return slicesResent;
+}
+
+ChunkStreamClient::ChunkStreamClient(const std::string &host, unsigned short port, size_t cacheSize) : cacheSize(std::clamp<size_t>(cacheSize, 1, 0xffff)) {
+	auto address = network::udpsocket::resolve(host, port);
+	if(!address) {
+		throw std::runtime_error("ChunkStreamClient: couldn't resolve " + host);
+	}
+	server = *address;
+	send(InterestPacket);
+}
+
+ChunkStreamClient::~ChunkStreamClient() {
+	send(DisconnectPacket);
+}
+
+void ChunkStreamClient::setCamera(vec2 camera, uint8_t radius) {
+	bool moved = this->radius != radius || lvec2(std::floor(camera.x), std::floor(camera.y)) != lvec2(std::floor(this->camera.x), std::floor(this->camera.y));
+	this->camera = camera;
+	this->radius = radius;
+	std::erase_if(assemblies, [&](const auto &entry) {
+		return !inRange(camera, radius, entry.second.pos);
+	});
+	std::erase_if(missing, [&](lvec2 pos) {
+		return !inRange(camera, radius, pos);
+	});
+	// like the server, what comes into range again is looked up in the cache by its hash
+	std::erase_if(chunks, [&](const auto &entry) {
+		return !inRange(camera, radius, entry.first);
+	});
+	std::erase_if(pending, [&](lvec2 pos) {
+		return !chunks.contains(pos);
+	});
+	if(moved) {
+		send(InterestPacket);
+	}
+}
+
+void ChunkStreamClient::update(float dt) {
+	std::array<uint8_t, maxPacketSize> buffer;
+	struct sockaddr_in peer;
+	int len;
+	bool received = false;
+	while((len = socket.recvFrom(buffer, peer)) >= 0) {
+		if(peer.sin_addr.s_addr == server.sin_addr.s_addr && peer.sin_port == server.sin_port && receive(std::span(buffer.data(), len))) {
+			bytesReceived += len;
+			received = true;
+		}
+	}
+
+	sinceSent += dt;
+	if(received || sinceSent >= resendInterval) {
+		send(InterestPacket);
+	}
+}
+
+bool ChunkStreamClient::receive(std::span<const uint8_t> datagram) {
+	if(datagram.size() < headerSize || datagram[8] != ChunksPacket) {
+		return false;
+	}
+	uint16_t packetSequence = get16(datagram.data());
+	if(!sequence.isNew(packetSequence)) {
+		return false;
+	}
+
+	// checked completely before anything is used, only datagrams that were understood get acked
+	struct Slice {
+		RecordKind kind;
+		lvec2 pos;
+		uint64_t hash, size, index;
+		std::span<const uint8_t> data;
+	};
+	std::vector<Slice> slices;
+	std::span<const uint8_t> in = datagram.subspan(headerSize);
+	while(!in.empty()) {
+		Slice slice = {RecordKind(in[0]), {}, 0, 0, 0, {}};
+		in = in.subspan(1);
+		if(slice.kind > CachedRecord || !readPos(in, slice.pos) || in.size() < 8) {
+			return false;
+		}
+		slice.hash = get64(in.data());
+		in = in.subspan(8);
+		if(slice.kind == SliceRecord) {
+			// the size is checked before the assembly buffer is allocated for it
+			if(!readVarint(in, slice.size) || !readVarint(in, slice.index) || slice.size > ChunkCodec::maxSize || slice.index >= sliceCount(slice.size)) {
+				return false;
+			}
+			size_t begin = slice.index * ChunkStreamServer::sliceSize, size = std::min<size_t>(ChunkStreamServer::sliceSize, slice.size - begin);
+			if(in.size() < size) {
+				return false;
+			}
+			slice.data = in.subspan(0, size);
+			in = in.subspan(size);
+		}
+		slices.push_back(slice);
+	}
+	sequence.received(packetSequence);
+
+	for(const Slice &slice : slices) {
+		if(cache.contains(slice.hash)) {
+			place(slice.pos, slice.hash);
+			continue;
+		}
+		if(slice.kind == CachedRecord) {
+			missing.insert(slice.pos);
+			continue;
+		}
+
+		Assembly &assembly = assemblies[slice.hash];
+		if(assembly.size != slice.size || assembly.slices.empty()) {
+			assembly = {slice.pos, slice.size, 0, std::vector<uint8_t>(slice.size), std::vector<bool>(sliceCount(slice.size))};
+		}
+		assembly.pos = slice.pos;
+		if(assembly.slices[slice.index]) {
+			continue;
+		}
+		assembly.slices[slice.index] = true;
+		std::copy(slice.data.begin(), slice.data.end(), assembly.data.begin() + slice.index * ChunkStreamServer::sliceSize);
+		if(++assembly.arrived < assembly.slices.size()) {
+			continue;
+		}
+
+		std::array<Tile, Chunk::size * Chunk::size> tiles;
+		std::vector<uint8_t> data = std::move(assembly.data);
+		assemblies.erase(slice.hash);
+		if(ChunkCodec::hash(data) != slice.hash || !ChunkCodec::decode(data, tiles)) {
+			spdlog::error("ChunkStreamClient: chunk {} {} is corrupt", slice.pos.x, slice.pos.y);
+			missing.insert(slice.pos);
+			continue;
+		}
+		store(slice.hash, std::move(data));
+		place(slice.pos, slice.hash);
+	}
+	return true;
+}
+
+void ChunkStreamClient::place(lvec2 pos, uint64_t hash) {
+	cache[hash].used = ++uses;
+	auto it = chunks.find(pos);
+	if(it == chunks.end() || it->second != hash) {
+		chunks[pos] = hash;
+		pending.insert(pos);
+	}
+	missing.erase(pos);
+}
+
+void ChunkStreamClient::store(uint64_t hash, std::vector<uint8_t> data) {
+	cache[hash] = {std::move(data), ++uses};
+	if(cache.size() <= cacheSize) {
+		return;
+	}
+	// chunks in range are never evicted, the cache grows beyond cacheSize if it has to
+	std::set<uint64_t> visible;
+	for(auto &[pos, hash] : chunks) {
+		visible.insert(hash);
+	}
+	while(cache.size() > cacheSize) {
+		auto oldest = cache.end();
+		for(auto it = cache.begin(); it != cache.end(); it++) {
+			if(it->first != hash && !visible.contains(it->first) && (oldest == cache.end() || it->second.used < oldest->second.used)) {
+				oldest = it;
+			}
+		}
+		if(oldest == cache.end()) {
+			break;
+		}
+		cache.erase(oldest);
+	}
+}
+
+void ChunkStreamClient::send(uint8_t type) {
+	std::vector<uint8_t> packet(headerSize);
+	sequence.writeHeader(packet.data(), type);
+	if(type == InterestPacket) {
+		float pos[2] = {camera.x, camera.y};
+		packet.resize(headerSize + 13);
+		std::memcpy(&packet[headerSize], pos, sizeof(pos));
+		packet[headerSize + 8] = radius;
+		put16(&packet[headerSize + 9], cacheSize);
+		put16(&packet[headerSize + 11], std::min(missing.size(), maxMissing));
+		size_t count = 0;
+		for(lvec2 pos : missing) {
+			if(count++ == maxMissing) {
+				break;
+			}
+			writePos(packet, pos);
+		}
+	}
+	socket.sendTo(packet, server);
+	sinceSent = 0.0f;
+}
+
+void ChunkStreamClient::apply(WorldContainer &world, vec2 tileScale) {
+	for(lvec2 pos : pending) {
+		std::shared_ptr<Chunk> chunk = std::as_const(world).getChunkAbsolute(pos);
+		if(!chunk) {
+			chunk = std::shared_ptr<Chunk>(new Chunk(world, pos, tileScale));
+			world.setChunkAbsolute(pos, chunk);
+		}
+		if(get(pos, chunk->data())) {
+			chunk->setModified(false);
+		}
+	}
+	pending.clear();
+}
+
+bool ChunkStreamClient::get(lvec2 pos, std::span<Tile> tiles) const {
+	auto it = chunks.find(pos);
+	if(it == chunks.end()) {
+		return false;
+	}
+	auto cached = cache.find(it->second);
+	return cached != cache.end() && ChunkCodec::decode(cached->second.data, tiles);
+}
+
+bool ChunkStreamClient::has(lvec2 pos, uint64_t hash) const {
+	auto it = chunks.find(pos);
+	return it != chunks.end() && it->second == hash;
+}
+
+size_t ChunkStreamClient::getChunkCount() const {
+	return chunks.size();
+}
+
+size_t ChunkStreamClient::getBytesReceived() const {
+	return bytesReceived;
+}
@@ -5,7 +5,7 @@ Entity::Entity(std::shared_ptr<TiledTexture> texture) : texture(texture) {}
 Entity::~Entity() {}
 
 void Entity::update([[maybe_unused]] float time, [[maybe_unused]] float dt, [[maybe_unused]] WorldContainer &world) {
-	transform = mat4().translate(pos).rotate(rot).scale(scale);
+	transform = affine2().translate(pos.xy).rotate(rot.z).scale(scale.xy);
 }
 
 void Entity::render() {}
@@ -18,11 +18,20 @@ void Entity::shift(ivec2 dir) {
 	pos.xy += vec2(dir) * Chunk::size * Tile::resolution;
 }
 
-mat4 Entity::getTransform() {
+void Entity::saveState(EntityState &state) const {
+	state.pos = pos.xy;
+}
+
+void Entity::loadState(const EntityState &state) {
+	pos.xy = state.pos;
+	transform = affine2().translate(pos.xy).rotate(rot.z).scale(scale.xy);
+}
+
+affine2 Entity::getTransform() {
 	return transform;
 }
 
-mat4 Entity::getUVTransform() {
+affine2 Entity::getUVTransform() {
 	return uvtransform;
 }
 
@@ -1,5 +1,7 @@
 #include <gui.hpp>
 
+#include <opengl/querypool.hpp>
+
 void GuiStyleStack::pushStyle(const GuiStyle &style) {
 	styles.push_back(style);
 }
@@ -133,11 +135,15 @@ void GuiSystem::render(mat4 transform) {
 	glClear(GL_DEPTH_BUFFER_BIT);
 
 	transform = transform.translate(vec3(-1, 1, 0)).scale(vec3(vec2(1.0f) / frameBufferSize * 2.0f, 1.0f));
-	prog.use();
-	transformUBO.bindBase(0);
-	transformUBO.update(transform);
-	mesh.render();
+	{
+		opengl::QueryPool::Scope pass("gui");
+		prog.use();
+		transformUBO.bindBase(0);
+		transformUBO.update(transform);
+		mesh.render();
+	}
 
+	opengl::QueryPool::Scope pass("gui text");
 	textRenderer.render(transform);
 }
 
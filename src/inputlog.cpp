@@ -0,0 +1,140 @@
+#include <inputlog.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include <utils/serialization.hpp>
+
+static const char magic[4] = {'P', 'H', 'I', 'L'};
+
+void InputLog::Frame::apply(Player &player, WorldContainer &world) const {
+	player.setInput(Player::move, move);
+	if(flags & jump)
+		player.setInput(Player::jump, 1.0f);
+	if(flags & dash)
+		player.setInput(Player::dash, 1.0f);
+	if(flags & walk)
+		player.setInput(Player::walk, 1.0f);
+	player.gravity.y = (flags & gravityDown) ? std::abs(player.gravity.y) : -std::abs(player.gravity.y);
+
+	if(flags & respawn) {
+		player.pos = vec2(0);
+		player.speed = vec2(0);
+		world.shift(world.offset());
+	}
+
+	if(flags & place) {
+		world[tile] = Tile::stone;
+	}
+	else if(flags & remove) {
+		world[tile] = Tile::null;
+	}
+}
+
+InputLog::InputLog(uint32_t seed) : seed(seed) {}
+
+uint32_t InputLog::getSeed() const {
+	return seed;
+}
+
+const std::vector<InputLog::Frame>& InputLog::getFrames() const {
+	return frames;
+}
+
+void InputLog::push(const Frame &frame) {
+	frames.push_back(frame);
+}
+
+std::vector<uint8_t> InputLog::serialize() const {
+	std::vector<uint8_t> out(std::begin(magic), std::end(magic));
+	writeVarint(out, version);
+	writeVarint(out, seed);
+	writeVarint(out, frames.size());
+	for(const Frame &frame : frames) {
+		out.resize(out.size() + 4);
+		put32(&out[out.size() - 4], std::bit_cast<uint32_t>(frame.dt));
+		out.push_back(uint8_t(int8_t(std::lround(std::clamp(frame.move, -1.0f, 1.0f) * 127.0f))));
+		out.push_back(frame.flags);
+		if(frame.flags & (Frame::place | Frame::remove)) {
+			writeVarint(out, zigzag(frame.tile.x));
+			writeVarint(out, zigzag(frame.tile.y));
+		}
+	}
+	return out;
+}
+
+bool InputLog::deserialize(std::span<const uint8_t> data, InputLog &log) {
+	uint64_t logVersion, seed, count;
+	if(data.size() < sizeof(magic) || !std::equal(std::begin(magic), std::end(magic), data.begin())) {
+		return false;
+	}
+	data = data.subspan(sizeof(magic));
+	if(!readVarint(data, logVersion) || logVersion != version || !readVarint(data, seed) || !readVarint(data, count) || seed > UINT32_MAX) {
+		return false;
+	}
+
+	log = InputLog(seed);
+	// every frame takes at least 6 bytes, a corrupt count can't reserve more than the data holds
+	log.frames.reserve(std::min<uint64_t>(count, data.size() / 6));
+	for(uint64_t i = 0; i < count; i++) {
+		if(data.size() < 6) {
+			return false;
+		}
+		Frame frame;
+		frame.dt = std::bit_cast<float>(get32(data.data()));
+		if(!std::isfinite(frame.dt) || frame.dt < 0.0f) {
+			return false;
+		}
+		frame.move = int8_t(data[4]) / 127.0f;
+		frame.flags = data[5];
+		data = data.subspan(6);
+		if(frame.flags & (Frame::place | Frame::remove)) {
+			uint64_t x, y;
+			if(!readVarint(data, x) || !readVarint(data, y)) {
+				return false;
+			}
+			frame.tile = lvec2(unzigzag(x), unzigzag(y));
+		}
+		log.frames.push_back(frame);
+	}
+	return data.empty();
+}
+
+void InputLog::save(const std::string &path) const {
+	std::vector<uint8_t> data = serialize();
+	std::ofstream file(path, std::ios::binary);
+	if(!file.write(reinterpret_cast<const char*>(data.data()), data.size())) {
+		throw std::runtime_error("could not write input log " + path);
+	}
+}
+
+InputLog InputLog::load(const std::string &path) {
+	std::ifstream file(path, std::ios::binary);
+	if(!file) {
+		throw std::runtime_error("could not open input log " + path);
+	}
+	std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	InputLog log;
+	if(!deserialize(data, log)) {
+		throw std::runtime_error("input log " + path + " is truncated, corrupt or from another version");
+	}
+	return log;
+}
+
+void buildStartArea(WorldContainer &world) {
+	for(int i = 5; i < 128; i++) {
+		world[ivec2(i + 4, i)] = Tile::stone;
+		world[ivec2(i + 4, i - 1)] = Tile::stone;
+	}
+	for(int i = 0; i < 16; i++) {
+		world[ivec2(-i - 5, 8)] = Tile::stone;
+	}
+	world[ivec2(-5, 0)] = Tile::stone;
+	world[ivec2(-5, 1)] = Tile::stone;
+	world[ivec2(-5, 2)] = Tile::stone;
+	world[ivec2(-5, 3)] = Tile::stone;
+}
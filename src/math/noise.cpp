@@ -1,5 +1,11 @@
 #include <math/noise.hpp>
 
+// the integer parts of sse2 come with every x86-64 target
+#if defined(MATH_SSE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define NOISE_SSE2
+	#include <emmintrin.h>
+#endif
+
 namespace math{
 	static const std::vector<int> permutation_base = {
 			151,160,137,91,90,15,131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,
@@ -16,25 +22,141 @@ namespace math{
 			138,236,205,93,222,114,67,29,24,72,243,141,128,195,78,66,215,61,156,180
 	};
 
+#if defined(NOISE_SSE2)
+	static inline __m128 select(__m128 mask, __m128 a, __m128 b) {
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+
+	// valid for |x| < 2^31, sets xi to the same as an int
+	static inline __m128 floor4(__m128 x, __m128i &xi) {
+		__m128i truncated = _mm_cvttps_epi32(x);
+		__m128 t = _mm_cvtepi32_ps(truncated);
+		__m128 above = _mm_cmpgt_ps(t, x);
+		xi = _mm_add_epi32(truncated, _mm_castps_si128(above));
+		return _mm_sub_ps(t, _mm_and_ps(above, _mm_set1_ps(1.0f)));
+	}
+
+	static inline __m128 fade4(__m128 t) {
+		__m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+		return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+	}
+
+	static inline __m128 lerp4(__m128 a, __m128 b, __m128 t) {
+		return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+	}
+
+	// perlin::grad without branches
+	static inline __m128 grad4(const int *hash, __m128 x, __m128 y, __m128 z) {
+		__m128i h = _mm_and_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(hash)), _mm_set1_epi32(15));
+		__m128 u = select(_mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8))), x, y);
+		__m128 xz = select(_mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(h, _mm_set1_epi32(12)), _mm_cmpeq_epi32(h, _mm_set1_epi32(14)))), x, z);
+		__m128 v = select(_mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4))), y, xz);
+		u = _mm_xor_ps(u, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31)));
+		v = _mm_xor_ps(v, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30)));
+		return _mm_add_ps(u, v);
+	}
+
+	// four points relative to the integer base, z is ignored if flat
+	static __m128 perlin4(const int *p, __m128 x, __m128 y, __m128 z, const ivec3 &base, bool flat) {
+		__m128i xi, yi, zi = _mm_setzero_si128();
+		x = _mm_sub_ps(x, floor4(x, xi));
+		y = _mm_sub_ps(y, floor4(y, yi));
+		z = flat ? _mm_setzero_ps() : _mm_sub_ps(z, floor4(z, zi));
+
+		const __m128i byte = _mm_set1_epi32(255);
+		alignas(16) int X[4], Y[4], Z[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(X), _mm_and_si128(_mm_add_epi32(xi, _mm_set1_epi32(base.x)), byte));
+		_mm_store_si128(reinterpret_cast<__m128i*>(Y), _mm_and_si128(_mm_add_epi32(yi, _mm_set1_epi32(base.y)), byte));
+		_mm_store_si128(reinterpret_cast<__m128i*>(Z), _mm_and_si128(_mm_add_epi32(zi, _mm_set1_epi32(flat ? 0 : base.z)), byte));
+
+		// the hashes of the 8 corners, the gathers stay scalar
+		alignas(16) int h[8][4];
+		for(int lane = 0; lane < 4; lane++) {
+			int A = p[X[lane]] + Y[lane], AA = p[A] + Z[lane], AB = p[A + 1] + Z[lane];
+			int B = p[X[lane] + 1] + Y[lane], BA = p[B] + Z[lane], BB = p[B + 1] + Z[lane];
+			h[0][lane] = p[AA], h[1][lane] = p[BA], h[2][lane] = p[AB], h[3][lane] = p[BB];
+			h[4][lane] = p[AA + 1], h[5][lane] = p[BA + 1], h[6][lane] = p[AB + 1], h[7][lane] = p[BB + 1];
+		}
+
+		const __m128 one = _mm_set1_ps(1.0f);
+		__m128 u = fade4(x), v = fade4(y);
+		__m128 x1 = _mm_sub_ps(x, one), y1 = _mm_sub_ps(y, one);
+		__m128 res = lerp4(lerp4(grad4(h[0], x, y, z), grad4(h[1], x1, y, z), u), lerp4(grad4(h[2], x, y1, z), grad4(h[3], x1, y1, z), u), v);
+		if(!flat) {
+			__m128 z1 = _mm_sub_ps(z, one);
+			__m128 far = lerp4(lerp4(grad4(h[4], x, y, z1), grad4(h[5], x1, y, z1), u), lerp4(grad4(h[6], x, y1, z1), grad4(h[7], x1, y1, z1), u), v);
+			res = lerp4(res, far, fade4(z));
+		}
+		return _mm_mul_ps(_mm_add_ps(res, one), _mm_set1_ps(0.5f));
+	}
+
+	// four points in skewed coordinates relative to the integer base, see simplex::noise2dBase
+	static __m128 simplex4(const short *perm, const dvec2 *grads, int mask, __m128 x, __m128 y, const ivec2 &base) {
+		const float G = -0.211324865405187f;
+		__m128i xsb, ysb;
+		__m128 xsi = _mm_sub_ps(x, floor4(x, xsb)), ysi = _mm_sub_ps(y, floor4(y, ysb));
+		__m128 ssi = _mm_mul_ps(_mm_add_ps(xsi, ysi), _mm_set1_ps(G));
+		__m128 xi = _mm_add_ps(xsi, ssi), yi = _mm_add_ps(ysi, ssi);
+
+		// (0, 0) and (1, 1) always contribute, the third point is (0, 1) above the diagonal and (1, 0) below
+		__m128 upper = _mm_cmpge_ps(ysi, xsi);
+		alignas(16) int xb[4], yb[4], side[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(xb), _mm_add_epi32(xsb, _mm_set1_epi32(base.x)));
+		_mm_store_si128(reinterpret_cast<__m128i*>(yb), _mm_add_epi32(ysb, _mm_set1_epi32(base.y)));
+		_mm_store_si128(reinterpret_cast<__m128i*>(side), _mm_castps_si128(upper));
+
+		const __m128 one = _mm_set1_ps(1.0f);
+		__m128 value = _mm_setzero_ps();
+		for(int i = 0; i < 3; i++) {
+			__m128 xsv = i < 2 ? _mm_set1_ps(float(i)) : _mm_andnot_ps(upper, one);
+			__m128 ysv = i < 2 ? _mm_set1_ps(float(i)) : _mm_and_ps(upper, one);
+			__m128 ssv = _mm_mul_ps(_mm_add_ps(xsv, ysv), _mm_set1_ps(G));
+			__m128 dx = _mm_sub_ps(_mm_sub_ps(xi, xsv), ssv), dy = _mm_sub_ps(_mm_sub_ps(yi, ysv), ssv);
+
+			alignas(16) float gx[4], gy[4];
+			for(int lane = 0; lane < 4; lane++) {
+				int xo = i < 2 ? i : !side[lane], yo = i < 2 ? i : !!side[lane];
+				const dvec2 &grad = grads[perm[(xb[lane] + xo) & mask] ^ ((yb[lane] + yo) & mask)];
+				gx[lane] = float(grad.x), gy[lane] = float(grad.y);
+			}
+			__m128 attn = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(0.5f), _mm_mul_ps(dx, dx)), _mm_mul_ps(dy, dy));
+			attn = _mm_max_ps(attn, _mm_setzero_ps());
+			attn = _mm_mul_ps(attn, attn);
+			__m128 extrapolation = _mm_add_ps(_mm_mul_ps(_mm_load_ps(gx), dx), _mm_mul_ps(_mm_load_ps(gy), dy));
+			value = _mm_add_ps(value, _mm_mul_ps(_mm_mul_ps(attn, attn), extrapolation));
+		}
+		return value;
+	}
+
+	// the first n lanes, for the ends of rows and spans
+	static inline void storePartial(float *out, __m128 v, size_t n) {
+		alignas(16) float lanes[4];
+		_mm_store_ps(lanes, v);
+		std::copy(lanes, lanes + n, out);
+	}
+#endif
+
 	// Generate a new permutation vector based on the value of seed
-	perlin::perlin(uint64_t seed) : permutation(permutation_base) {
+	perlin::perlin(uint64_t seed) {
+		std::copy(permutation_base.begin(), permutation_base.end(), permutation.begin());
 		std::default_random_engine rng(seed);
-		std::shuffle(permutation.begin(), permutation.end(), rng);
+		std::shuffle(permutation.begin(), permutation.begin() + 256, rng);
 
 		// Duplicate the permutation vector
-		permutation.insert(permutation.end(), permutation.begin(), permutation.end());
+		std::copy(permutation.begin(), permutation.begin() + 256, permutation.begin() + 256);
 	}
 
 	double perlin::noise(double x, double y, double z) const {
 		// Find the unit cube that contains the point
-		int X = (int) ::floor(x) & 255;
-		int Y = (int) ::floor(y) & 255;
-		int Z = (int) ::floor(z) & 255;
+		double fx = std::floor(x), fy = std::floor(y), fz = std::floor(z);
+		int X = (int) fx & 255;
+		int Y = (int) fy & 255;
+		int Z = (int) fz & 255;
 
 		// Find relative x, y,z of point in cube
-		x -= ::floor(x);
-		y -= ::floor(y);
-		z -= ::floor(z);
+		x -= fx;
+		y -= fy;
+		z -= fz;
 
 		// Compute fade curves for each of x, y, z
 		double u = fade(x);
@@ -50,10 +172,100 @@ namespace math{
 		int BB = permutation[B + 1] + Z;
 
 		// Add blended results from 8 corners of cube
-		double res = lerp(w, lerp(v, lerp(u, grad(permutation[AA], x, y, z), grad(permutation[BA], x-1, y, z)), lerp(u, grad(permutation[AB], x, y-1, z), grad(permutation[BB], x-1, y-1, z))),	lerp(v, lerp(u, grad(permutation[AA+1], x, y, z-1), grad(permutation[BA+1], x-1, y, z-1)), lerp(u, grad(permutation[AB+1], x, y-1, z-1),	grad(permutation[BB+1], x-1, y-1, z-1))));
+		double res = lerp(lerp(lerp(grad(permutation[AA], x, y, z), grad(permutation[BA], x-1, y, z), u), lerp(grad(permutation[AB], x, y-1, z), grad(permutation[BB], x-1, y-1, z), u), v), lerp(lerp(grad(permutation[AA+1], x, y, z-1), grad(permutation[BA+1], x-1, y, z-1), u), lerp(grad(permutation[AB+1], x, y-1, z-1), grad(permutation[BB+1], x-1, y-1, z-1), u), v), w);
 		return (res + 1.0)/2.0;
 	}
 
+	void perlin::noise(std::span<const vec2> pos, std::span<float> out) const {
+		size_t i = 0;
+#if defined(NOISE_SSE2)
+		for(; i < pos.size(); i += 4) {
+			size_t n = std::min<size_t>(4, pos.size() - i);
+			alignas(16) float x[4] = {}, y[4] = {};
+			for(size_t j = 0; j < n; j++) {
+				x[j] = pos[i + j].x, y[j] = pos[i + j].y;
+			}
+			storePartial(&out[i], perlin4(permutation.data(), _mm_load_ps(x), _mm_load_ps(y), _mm_setzero_ps(), ivec3(0), true), n);
+		}
+#endif
+		for(; i < pos.size(); i++) {
+			out[i] = float(noise(pos[i].x, pos[i].y));
+		}
+	}
+
+	void perlin::noise(std::span<const vec3> pos, std::span<float> out) const {
+		size_t i = 0;
+#if defined(NOISE_SSE2)
+		for(; i < pos.size(); i += 4) {
+			size_t n = std::min<size_t>(4, pos.size() - i);
+			alignas(16) float x[4] = {}, y[4] = {}, z[4] = {};
+			for(size_t j = 0; j < n; j++) {
+				x[j] = pos[i + j].x, y[j] = pos[i + j].y, z[j] = pos[i + j].z;
+			}
+			storePartial(&out[i], perlin4(permutation.data(), _mm_load_ps(x), _mm_load_ps(y), _mm_load_ps(z), ivec3(0), false), n);
+		}
+#endif
+		for(; i < pos.size(); i++) {
+			out[i] = float(noise(pos[i].x, pos[i].y, pos[i].z));
+		}
+	}
+
+	void perlin::grid(dvec2 origin, dvec2 step, ivec2 size, std::span<float> out) const {
+#if defined(NOISE_SSE2)
+		// only the offsets from the cell of the origin go through float
+		dvec2 cell(std::floor(origin.x), std::floor(origin.y));
+		dvec2 local = origin - cell;
+		ivec3 base(int(cell.x), int(cell.y), 0);
+		std::vector<float> xs((size.x + 3) & ~3);
+		for(size_t x = 0; x < xs.size(); x++) {
+			xs[x] = float(local.x + x * step.x);
+		}
+		for(int y = 0; y < size.y; y++) {
+			__m128 row = _mm_set1_ps(float(local.y + y * step.y));
+			float *dst = out.data() + size_t(y) * size.x;
+			for(int x = 0; x < size.x; x += 4) {
+				storePartial(dst + x, perlin4(permutation.data(), _mm_loadu_ps(&xs[x]), row, _mm_setzero_ps(), base, true), std::min(4, size.x - x));
+			}
+		}
+#else
+		for(int y = 0; y < size.y; y++) {
+			for(int x = 0; x < size.x; x++) {
+				out[size_t(y) * size.x + x] = float(noise(origin.x + x * step.x, origin.y + y * step.y));
+			}
+		}
+#endif
+	}
+
+	void perlin::grid(dvec3 origin, dvec3 step, ivec3 size, std::span<float> out) const {
+#if defined(NOISE_SSE2)
+		dvec3 cell(std::floor(origin.x), std::floor(origin.y), std::floor(origin.z));
+		dvec3 local = origin - cell;
+		ivec3 base(int(cell.x), int(cell.y), int(cell.z));
+		std::vector<float> xs((size.x + 3) & ~3);
+		for(size_t x = 0; x < xs.size(); x++) {
+			xs[x] = float(local.x + x * step.x);
+		}
+		for(int z = 0; z < size.z; z++) {
+			__m128 layer = _mm_set1_ps(float(local.z + z * step.z));
+			for(int y = 0; y < size.y; y++) {
+				__m128 row = _mm_set1_ps(float(local.y + y * step.y));
+				float *dst = out.data() + (size_t(z) * size.y + y) * size.x;
+				for(int x = 0; x < size.x; x += 4) {
+					storePartial(dst + x, perlin4(permutation.data(), _mm_loadu_ps(&xs[x]), row, layer, base, false), std::min(4, size.x - x));
+				}
+			}
+		}
+#else
+		for(int z = 0; z < size.z; z++) {
+			for(int y = 0; y < size.y; y++) {
+				for(int x = 0; x < size.x; x++) {
+					out[(size_t(z) * size.y + y) * size.x + x] = float(noise(origin.x + x * step.x, origin.y + y * step.y, origin.z + z * step.z));
+				}
+			}
+		}
+#endif
+	}
+
 	double perlin::fade(double t) {
 		return t * t * t * (t * (t * 6 - 15) + 10);
 	}
@@ -85,14 +297,14 @@ namespace math{
 		}
 	}
 
-	double simplex::noise2d(math::dvec2 pos) {
+	double simplex::noise2d(math::dvec2 pos) const {
 		// Get points for A2* lattice
 		double s = 0.366025403784439 * (pos.x + pos.y);
 		dvec2 ps = pos + s;
 		return noise2dBase(ps);
 	}
 
-	double simplex::noise3d(math::dvec3 pos) {
+	double simplex::noise3d(math::dvec3 pos) const {
 		// Re-orient the cubic lattices via rotation, to produce the expected look on cardinal planar slices.
 		// If texturing objects that don't tend to have cardinal plane faces, you could even remove this.
 		// Orthonormal rotation. Not a skew transform.
@@ -103,14 +315,65 @@ namespace math{
 		return noise3dBCC(posr);
 	}
 
-	double simplex::noise4d(math::dvec4 pos) {
+	double simplex::noise4d(math::dvec4 pos) const {
 		// Get points for A4 lattice
 		double s = -0.138196601125011 * (pos.x + pos.y + pos.z + pos.w);
 		math::dvec4 spos = pos + math::dvec4(s);
 		return noise4dBase(spos);
 	}
 
-	double simplex::noise2dBase(math::dvec2 pos) {
+	void simplex::noise2d(std::span<const vec2> pos, std::span<float> out) const {
+		size_t i = 0;
+#if defined(NOISE_SSE2)
+		for(; i < pos.size(); i += 4) {
+			size_t n = std::min<size_t>(4, pos.size() - i);
+			alignas(16) float x[4] = {}, y[4] = {};
+			for(size_t j = 0; j < n; j++) {
+				x[j] = pos[i + j].x, y[j] = pos[i + j].y;
+			}
+			__m128 px = _mm_load_ps(x), py = _mm_load_ps(y);
+			__m128 s = _mm_mul_ps(_mm_add_ps(px, py), _mm_set1_ps(0.366025403784439f));
+			storePartial(&out[i], simplex4(perm.data(), permGrad2.data(), mask, _mm_add_ps(px, s), _mm_add_ps(py, s), ivec2(0)), n);
+		}
+#endif
+		for(; i < pos.size(); i++) {
+			out[i] = float(noise2d(dvec2(pos[i])));
+		}
+	}
+
+	void simplex::grid2d(dvec2 origin, dvec2 step, ivec2 size, std::span<float> out) const {
+#if defined(NOISE_SSE2)
+		// the skew is linear, so skewed positions are the skewed origin plus skewed column and row offsets
+		const double F = 0.366025403784439;
+		double s = F * (origin.x + origin.y);
+		dvec2 skewed = origin + s;
+		dvec2 cell(std::floor(skewed.x), std::floor(skewed.y));
+		dvec2 local = skewed - cell;
+		ivec2 base(int(cell.x), int(cell.y));
+		std::vector<float> xs((size.x + 3) & ~3), ys(xs.size());
+		for(size_t x = 0; x < xs.size(); x++) {
+			xs[x] = float(x * step.x * (1.0 + F));
+			ys[x] = float(x * step.x * F);
+		}
+		for(int y = 0; y < size.y; y++) {
+			__m128 rowX = _mm_set1_ps(float(local.x + y * step.y * F));
+			__m128 rowY = _mm_set1_ps(float(local.y + y * step.y * (1.0 + F)));
+			float *dst = out.data() + size_t(y) * size.x;
+			for(int x = 0; x < size.x; x += 4) {
+				__m128 px = _mm_add_ps(rowX, _mm_loadu_ps(&xs[x])), py = _mm_add_ps(rowY, _mm_loadu_ps(&ys[x]));
+				storePartial(dst + x, simplex4(perm.data(), permGrad2.data(), mask, px, py, base), std::min(4, size.x - x));
+			}
+		}
+#else
+		for(int y = 0; y < size.y; y++) {
+			for(int x = 0; x < size.x; x++) {
+				out[size_t(y) * size.x + x] = float(noise2d(origin + dvec2(x * step.x, y * step.y)));
+			}
+		}
+#endif
+	}
+
+	double simplex::noise2dBase(math::dvec2 pos) const {
 		double value = 0;
 
 		// Get base points and offsets
@@ -141,7 +404,7 @@ namespace math{
 		return value;
 	}
 
-	double simplex::noise3dBCC(math::dvec3 pos) {
+	double simplex::noise3dBCC(math::dvec3 pos) const {
 		// Get base and offsets inside cube of first lattice.
 		int xrb = fastFloor(pos.x), yrb = fastFloor(pos.y), zrb = fastFloor(pos.z);
 		double xri = pos.x - xrb, yri = pos.y - yrb, zri = pos.z - zrb;
@@ -153,26 +416,26 @@ namespace math{
 
 		// Point contributions
 		double value = 0;
-		std::shared_ptr<LatticePoint3D> c = lookup3D[index];
-		while (c) {
-			double dxr = xri + c->dxr, dyr = yri + c->dyr, dzr = zri + c->dzr;
+		for (int i = index * 8; i >= 0;) {
+			const LatticePoint3D &c = lookup3D[i];
+			double dxr = xri + c.dxr, dyr = yri + c.dyr, dzr = zri + c.dzr;
 			double attn = 0.5 - dxr * dxr - dyr * dyr - dzr * dzr;
 			if (attn < 0) {
-				c = c->nextOnFailure;
+				i = c.nextOnFailure;
 			} else {
-				int pxm = (xrb + c->xrv) & mask, pym = (yrb + c->yrv) & mask, pzm = (zrb + c->zrv) & mask;
+				int pxm = (xrb + c.xrv) & mask, pym = (yrb + c.yrv) & mask, pzm = (zrb + c.zrv) & mask;
 				Grad3 grad = permGrad3[perm[perm[pxm] ^ pym] ^ pzm];
 				double extrapolation = grad.x * dxr + grad.y * dyr + grad.z * dzr;
 
 				attn *= attn;
 				value += attn * attn * extrapolation;
-				c = c->nextOnSuccess;
+				i = c.nextOnSuccess;
 			}
 		}
 		return value;
 	}
 
-	double simplex::noise4dBase(math::dvec4 pos) {
+	double simplex::noise4dBase(math::dvec4 pos) const {
 		double value = 0;
 
 		// Get base points and offsets
@@ -551,58 +814,63 @@ namespace math{
 		return result;
 	}();
 
-	const std::array<simplex::LatticePoint2D, 4> simplex::lookup2D = {
-		LatticePoint2D(1, 0),
-		LatticePoint2D(0, 0),
-		LatticePoint2D(1, 1),
-		LatticePoint2D(0, 1)
-	};
-
-	const std::array<std::shared_ptr<simplex::LatticePoint3D>, 8> simplex::lookup3D = []() -> std::array<std::shared_ptr<simplex::LatticePoint3D>, 8> {
-		std::array<std::shared_ptr<simplex::LatticePoint3D>, 8> tmp;
+	constexpr std::array<simplex::LatticePoint3D, 64> simplex::buildLookup3D() {
+		std::array<LatticePoint3D, 64> result{};
 		for (int i = 0; i < 8; i++) {
 			int i1, j1, k1, i2, j2, k2;
 			i1 = (i >> 0) & 1; j1 = (i >> 1) & 1; k1 = (i >> 2) & 1;
 			i2 = i1 ^ 1; j2 = j1 ^ 1; k2 = k1 ^ 1;
+			LatticePoint3D *c = &result[i * 8];
+			int base = i * 8;
 
 			// The two points within this octant, one from each of the two cubic half-lattices.
-			std::shared_ptr<LatticePoint3D> c0(new LatticePoint3D(i1, j1, k1, 0));
-			std::shared_ptr<LatticePoint3D> c1(new LatticePoint3D(i1 + i2, j1 + j2, k1 + k2, 1));
+			c[0] = LatticePoint3D(i1, j1, k1, 0);
+			c[1] = LatticePoint3D(i1 + i2, j1 + j2, k1 + k2, 1);
 
 			// Each single step away on the first half-lattice.
-			std::shared_ptr<LatticePoint3D> c2(new LatticePoint3D(i1 ^ 1, j1, k1, 0));
-			std::shared_ptr<LatticePoint3D> c3(new LatticePoint3D(i1, j1 ^ 1, k1, 0));
-			std::shared_ptr<LatticePoint3D> c4(new LatticePoint3D(i1, j1, k1 ^ 1, 0));
+			c[2] = LatticePoint3D(i1 ^ 1, j1, k1, 0);
+			c[3] = LatticePoint3D(i1, j1 ^ 1, k1, 0);
+			c[4] = LatticePoint3D(i1, j1, k1 ^ 1, 0);
 
 			// Each single step away on the second half-lattice.
-			std::shared_ptr<LatticePoint3D> c5(new LatticePoint3D(i1 + (i2 ^ 1), j1 + j2, k1 + k2, 1));
-			std::shared_ptr<LatticePoint3D> c6(new LatticePoint3D(i1 + i2, j1 + (j2 ^ 1), k1 + k2, 1));
-			std::shared_ptr<LatticePoint3D> c7(new LatticePoint3D(i1 + i2, j1 + j2, k1 + (k2 ^ 1), 1));
+			c[5] = LatticePoint3D(i1 + (i2 ^ 1), j1 + j2, k1 + k2, 1);
+			c[6] = LatticePoint3D(i1 + i2, j1 + (j2 ^ 1), k1 + k2, 1);
+			c[7] = LatticePoint3D(i1 + i2, j1 + j2, k1 + (k2 ^ 1), 1);
 
 			// First two are guaranteed.
-			c0->nextOnFailure = c0->nextOnSuccess = c1;
-			c1->nextOnFailure = c1->nextOnSuccess = c2;
+			c[0].nextOnFailure = c[0].nextOnSuccess = base + 1;
+			c[1].nextOnFailure = c[1].nextOnSuccess = base + 2;
 
 			// Once we find one on the first half-lattice, the rest are out.
 			// In addition, knowing c2 rules out c5.
-			c2->nextOnFailure = c3; c2->nextOnSuccess = c6;
-			c3->nextOnFailure = c4; c3->nextOnSuccess = c5;
-			c4->nextOnFailure = c4->nextOnSuccess = c5;
+			c[2].nextOnFailure = base + 3; c[2].nextOnSuccess = base + 6;
+			c[3].nextOnFailure = base + 4; c[3].nextOnSuccess = base + 5;
+			c[4].nextOnFailure = c[4].nextOnSuccess = base + 5;
 
 			// Once we find one on the second half-lattice, the rest are out.
-			c5->nextOnFailure = c6; c5->nextOnSuccess = nullptr;
-			c6->nextOnFailure = c7; c6->nextOnSuccess = nullptr;
-			c7->nextOnFailure = c7->nextOnSuccess = nullptr;
-
-			tmp[i] = c0;
+			c[5].nextOnFailure = base + 6; c[5].nextOnSuccess = -1;
+			c[6].nextOnFailure = base + 7; c[6].nextOnSuccess = -1;
+			c[7].nextOnFailure = c[7].nextOnSuccess = -1;
 		}
-		return tmp;
-	}();
+		return result;
+	}
 
-	const std::array<simplex::LatticePoint4D, 16> simplex::vertices4D = []() -> std::array<simplex::LatticePoint4D, 16> {
-		std::array<simplex::LatticePoint4D, 16> tmp;
+	constexpr std::array<simplex::LatticePoint4D, 16> simplex::buildVertices4D() {
+		std::array<LatticePoint4D, 16> result{};
 		for (int i = 0; i < 16; i++) {
-			tmp[i] = LatticePoint4D((i >> 0) & 1, (i >> 1) & 1, (i >> 2) & 1, (i >> 3) & 1);		}
-		return tmp;
-	}();
+			result[i] = LatticePoint4D((i >> 0) & 1, (i >> 1) & 1, (i >> 2) & 1, (i >> 3) & 1);
+		}
+		return result;
+	}
+
+	constinit const std::array<simplex::LatticePoint2D, 4> simplex::lookup2D = {
+		LatticePoint2D(1, 0),
+		LatticePoint2D(0, 0),
+		LatticePoint2D(1, 1),
+		LatticePoint2D(0, 1)
+	};
+
+	constinit const std::array<simplex::LatticePoint3D, 64> simplex::lookup3D = buildLookup3D();
+
+	constinit const std::array<simplex::LatticePoint4D, 16> simplex::vertices4D = buildVertices4D();
 }
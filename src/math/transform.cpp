@@ -0,0 +1,125 @@
+#include <math/transform.hpp>
+
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace math{
+	static void checkSizes(size_t count, std::initializer_list<size_t> sizes) {
+		for(size_t size : sizes) {
+			if(size < count) {
+				throw std::invalid_argument("transform_points: span shorter than the input");
+			}
+		}
+	}
+
+	// body(begin, end) over [0, count), on several threads for long parallel spans
+	template<typename F>
+	static void split(size_t count, bool parallel, F &&body) {
+		size_t threads = parallel && count >= parallelTransformSize ? std::min<size_t>(std::thread::hardware_concurrency(), count / (parallelTransformSize / 4)) : 1;
+		if(threads <= 1) {
+			body(size_t(0), count);
+			return;
+		}
+		// multiples of 4, so only the last range has a scalar tail
+		size_t step = (count / threads + 3) & ~size_t(3);
+		std::vector<std::thread> workers;
+		for(size_t begin = step; begin < count; begin += step) {
+			workers.emplace_back(body, begin, std::min(begin + step, count));
+		}
+		body(size_t(0), std::min(step, count));
+		for(std::thread &worker : workers) {
+			worker.join();
+		}
+	}
+
+	void transform_points(std::span<const vec4> in, const mat4 &m, std::span<vec4> out, bool parallel) {
+		checkSizes(in.size(), {out.size()});
+		split(in.size(), parallel, [&](size_t begin, size_t end) {
+#if defined(MATH_SSE)
+			const __m128 cols[4] = {simd::load(m[0]), simd::load(m[1]), simd::load(m[2]), simd::load(m[3])};
+			for(size_t i = begin; i < end; i++) {
+				_mm_storeu_ps(&out[i].x, simd::combine(cols, simd::load(in[i])));
+			}
+#else
+			for(size_t i = begin; i < end; i++) {
+				out[i] = m * in[i];
+			}
+#endif
+		});
+	}
+
+	void transform_points(std::span<const vec2> in, const mat4 &m, std::span<vec2> out, bool parallel) {
+		checkSizes(in.size(), {out.size()});
+		split(in.size(), parallel, [&](size_t begin, size_t end) {
+			size_t i = begin;
+#if defined(MATH_SSE)
+			// two points per register
+			const __m128 a = _mm_setr_ps(m[0].x, m[0].y, m[0].x, m[0].y);
+			const __m128 b = _mm_setr_ps(m[1].x, m[1].y, m[1].x, m[1].y);
+			const __m128 t = _mm_setr_ps(m[3].x, m[3].y, m[3].x, m[3].y);
+			for(; i + 2 <= end; i += 2) {
+				__m128 p = _mm_loadu_ps(&in[i].x);
+				__m128 x = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0)), y = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1));
+				_mm_storeu_ps(&out[i].x, _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, x), _mm_mul_ps(b, y)), t));
+			}
+#endif
+			for(; i < end; i++) {
+				vec2 p = in[i];
+				out[i] = vec2(m[0].x * p.x + m[1].x * p.y + m[3].x, m[0].y * p.x + m[1].y * p.y + m[3].y);
+			}
+		});
+	}
+
+	void transform_points(std::span<const float> x, std::span<const float> y, std::span<const float> z, std::span<const float> w, const mat4 &m,
+		std::span<float> outX, std::span<float> outY, std::span<float> outZ, std::span<float> outW, bool parallel) {
+		checkSizes(x.size(), {y.size(), z.size(), w.size(), outX.size(), outY.size(), outZ.size(), outW.size()});
+		split(x.size(), parallel, [&](size_t begin, size_t end) {
+			size_t i = begin;
+#if defined(MATH_SSE)
+			// four points per register, every matrix element broadcast
+			__m128 e[4][4];
+			for(unsigned col = 0; col < 4; col++) {
+				for(unsigned row = 0; row < 4; row++) {
+					e[col][row] = _mm_set1_ps(m[col][row]);
+				}
+			}
+			for(; i + 4 <= end; i += 4) {
+				__m128 px = _mm_loadu_ps(&x[i]), py = _mm_loadu_ps(&y[i]), pz = _mm_loadu_ps(&z[i]), pw = _mm_loadu_ps(&w[i]);
+				float *outs[4] = {&outX[i], &outY[i], &outZ[i], &outW[i]};
+				for(unsigned row = 0; row < 4; row++) {
+					__m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e[0][row], px), _mm_mul_ps(e[1][row], py)), _mm_add_ps(_mm_mul_ps(e[2][row], pz), _mm_mul_ps(e[3][row], pw)));
+					_mm_storeu_ps(outs[row], r);
+				}
+			}
+#endif
+			for(; i < end; i++) {
+				vec4 p = m * vec4(x[i], y[i], z[i], w[i]);
+				outX[i] = p.x, outY[i] = p.y, outZ[i] = p.z, outW[i] = p.w;
+			}
+		});
+	}
+
+	void transform_points(std::span<const float> x, std::span<const float> y, const mat4 &m, std::span<float> outX, std::span<float> outY, bool parallel) {
+		checkSizes(x.size(), {y.size(), outX.size(), outY.size()});
+		split(x.size(), parallel, [&](size_t begin, size_t end) {
+			size_t i = begin;
+#if defined(MATH_SSE)
+			const __m128 m00 = _mm_set1_ps(m[0].x), m10 = _mm_set1_ps(m[1].x), m30 = _mm_set1_ps(m[3].x);
+			const __m128 m01 = _mm_set1_ps(m[0].y), m11 = _mm_set1_ps(m[1].y), m31 = _mm_set1_ps(m[3].y);
+			for(; i + 4 <= end; i += 4) {
+				__m128 px = _mm_loadu_ps(&x[i]), py = _mm_loadu_ps(&y[i]);
+				_mm_storeu_ps(&outX[i], _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, px), _mm_mul_ps(m10, py)), m30));
+				_mm_storeu_ps(&outY[i], _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, px), _mm_mul_ps(m11, py)), m31));
+			}
+#endif
+			for(; i < end; i++) {
+				float px = x[i], py = y[i];
+				outX[i] = m[0].x * px + m[1].x * py + m[3].x;
+				outY[i] = m[0].y * px + m[1].y * py + m[3].y;
+			}
+		});
+	}
+}
@@ -0,0 +1,637 @@
+#include <network/eventloop.hpp>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+#include <netinet/tcp.h>
+
+namespace network{
+	static constexpr size_t readSize = 64 * 1024;
+	static constexpr int maxEvents = 256;
+	static constexpr size_t maxIovecs = 64;
+	static constexpr size_t coalesceSize = 4096;
+	static constexpr unsigned ringEntries = 4096;
+	static constexpr unsigned bufferCount = 1024;
+	static constexpr unsigned bufferSize = 16 * 1024;
+
+	static std::atomic<size_t> copied = 0;
+
+	// close() is shadowed by connection::close()
+	static void closeHandle(int handle){
+		close(handle);
+	}
+
+	connection::connection(int handle) : handle(handle){}
+
+	connection::~connection(){
+		for(segment &seg : output){
+			if(seg.file >= 0){
+				closeHandle(seg.file);
+			}
+		}
+		if(handle >= 0){
+			closeHandle(handle);
+		}
+	}
+
+	void connection::queue(std::string_view data){
+		if(data.empty()){
+			return;
+		}
+		copied.fetch_add(data.size(), std::memory_order_relaxed);
+		// small writes are appended to the last segment, bigger ones get their own
+		if(output.size() > sending && output.back().file < 0 && output.back().data.size() + data.size() <= coalesceSize){
+			output.back().data.append(data);
+		}
+		else{
+			output.push_back({std::string(data)});
+		}
+	}
+
+	void connection::send(std::string_view data){
+		if(state == Reading){
+			queue(data);
+		}
+	}
+
+	void connection::send(std::initializer_list<std::string_view> parts){
+		if(state != Reading){
+			return;
+		}
+		size_t sent = 0;
+		if(output.empty() && !deferred && parts.size() <= maxIovecs){
+			struct iovec iov[maxIovecs];
+			size_t count = 0, total = 0;
+			for(std::string_view part : parts){
+				iov[count++] = {const_cast<char*>(part.data()), part.size()};
+				total += part.size();
+			}
+			struct msghdr message = {};
+			message.msg_iov = iov;
+			message.msg_iovlen = count;
+			ssize_t len;
+			do{
+				len = sendmsg(handle, &message, MSG_NOSIGNAL);
+			} while(len < 0 && errno == EINTR);
+			sent = std::max<ssize_t>(len, 0);
+			if(sent == total){
+				return;
+			}
+		}
+		for(std::string_view part : parts){
+			size_t skip = std::min(sent, part.size());
+			queue(part.substr(skip));
+			sent -= skip;
+		}
+	}
+
+	void connection::sendFile(int file, off_t offset, size_t len){
+		if(state != Reading || len == 0){
+			closeHandle(file);
+			return;
+		}
+		output.push_back({{}, file, offset, len});
+	}
+
+	void connection::close(){
+		if(state == Reading){
+			state = Closing;
+		}
+	}
+
+	size_t connection::copiedBytes(){
+		return copied.load(std::memory_order_relaxed);
+	}
+
+	int connection::getHandle() const{
+		return handle;
+	}
+
+	connection::states connection::getState() const{
+		return state;
+	}
+
+	bool connection::readable(){
+		thread_local char buffer[readSize];
+		while(state == Reading){
+			ssize_t len = ::recv(handle, buffer, readSize, 0);
+			if(len == 0){
+				// the peer closed its side, what is still queued goes out before the connection closes
+				state = Closing;
+				return writable();
+			}
+			if(len < 0){
+				if(errno == EINTR){
+					continue;
+				}
+				return errno == EAGAIN || errno == EWOULDBLOCK;
+			}
+
+			received(std::string_view(buffer, len));
+			if((!output.empty() || state == Closing) && !writable()){
+				return false;
+			}
+		}
+		return state != Closed;
+	}
+
+	void connection::received(std::string_view data){
+		// only leftovers of incomplete messages are copied
+		if(input.empty()){
+			size_t consumed = onData(data);
+			input.assign(data.substr(consumed));
+		}
+		else{
+			input.append(data);
+			input.erase(0, onData(input));
+		}
+	}
+
+	int connection::writeFile(){
+		segment &seg = output.front();
+		while(seg.size > 0){
+			ssize_t len = sendfile(handle, seg.file, &seg.offset, seg.size);
+			if(len < 0){
+				if(errno == EINTR){
+					continue;
+				}
+				return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+			}
+			if(len == 0){
+				spdlog::error("eventloop: file ended before all of it was sent");
+				return -1;
+			}
+			seg.size -= len;
+		}
+		closeHandle(seg.file);
+		output.pop_front();
+		return 1;
+	}
+
+	bool connection::writable(){
+		while(!output.empty()){
+			if(output.front().file >= 0){
+				int status = writeFile();
+				if(status <= 0){
+					return status == 0;
+				}
+				continue;
+			}
+
+			// gather consecutive data segments into one sendmsg
+			ssize_t len;
+			struct iovec iov[maxIovecs];
+			size_t count = 0;
+			for(auto it = output.begin(); it != output.end() && it->file < 0 && count < maxIovecs; it++){
+				size_t skip = count == 0 ? outputOffset : 0;
+				iov[count++] = {it->data.data() + skip, it->data.size() - skip};
+			}
+			struct msghdr message = {};
+			message.msg_iov = iov;
+			message.msg_iovlen = count;
+			do{
+				len = sendmsg(handle, &message, MSG_NOSIGNAL);
+			} while(len < 0 && errno == EINTR);
+			if(len < 0){
+				return errno == EAGAIN || errno == EWOULDBLOCK;
+			}
+
+			size_t sent = len;
+			while(sent > 0){
+				size_t remaining = output.front().data.size() - outputOffset;
+				if(sent < remaining){
+					outputOffset += sent;
+					break;
+				}
+				sent -= remaining;
+				outputOffset = 0;
+				output.pop_front();
+			}
+		}
+		if(state == Closing){
+			state = Closed;
+			return false;
+		}
+		return true;
+	}
+
+	eventloop::eventloop(factory create, unsigned short port, address addr, unsigned threads, backends backend) : create(create), port(port), backend(backend){
+		if(threads == 0){
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		if(backend == IoUring && !uring::supported()){
+			spdlog::error("eventloop: io_uring isn't available, falling back to epoll");
+			this->backend = Epoll;
+		}
+
+		for(unsigned i = 0; i < threads; i++){
+			std::unique_ptr<worker> w(new worker());
+			w->listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+			int enable = 1;
+			setsockopt(w->listener, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+			setsockopt(w->listener, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable));
+			// inherited by accepted connections
+			setsockopt(w->listener, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+			struct sockaddr_in server = {AF_INET, htons(this->port), {htonl(addr.val)}, {}};
+			if(::bind(w->listener, (struct sockaddr*)&server, sizeof(server)) < 0 || ::listen(w->listener, SOMAXCONN) < 0){
+				closeHandle(w->listener);
+				throw std::runtime_error("eventloop: couldn't listen on port " + std::to_string(this->port) + ": " + strerror(errno));
+			}
+			// an ephemeral port is picked by the first listener, the others join it
+			if(this->port == 0){
+				socklen_t len = sizeof(server);
+				getsockname(w->listener, (struct sockaddr*)&server, &len);
+				this->port = ntohs(server.sin_port);
+			}
+
+			w->epoll = epoll_create1(EPOLL_CLOEXEC);
+			w->wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			struct epoll_event event = {EPOLLIN | EPOLLET, {.fd = w->listener}};
+			epoll_ctl(w->epoll, EPOLL_CTL_ADD, w->listener, &event);
+			event = {EPOLLIN, {.fd = w->wake}};
+			epoll_ctl(w->epoll, EPOLL_CTL_ADD, w->wake, &event);
+
+			workers.push_back(std::move(w));
+		}
+	}
+
+	eventloop::~eventloop(){
+		stop();
+		for(auto &w : workers){
+			// cancels everything in flight before the connections' buffers go away
+			w->ring.reset();
+			w->connections.clear();
+			closeHandle(w->listener);
+			closeHandle(w->wake);
+			closeHandle(w->epoll);
+		}
+	}
+
+	void eventloop::start(){
+		if(running){
+			return;
+		}
+		running = true;
+		for(auto &w : workers){
+			w->thread = std::thread([this, &w = *w](){
+				run(w);
+			});
+		}
+	}
+
+	void eventloop::stop(){
+		if(!running){
+			return;
+		}
+		for(auto &w : workers){
+			uint64_t one = 1;
+			if(write(w->wake, &one, sizeof(one)) < 0){
+				spdlog::error("eventloop: couldn't wake loop thread");
+			}
+		}
+		for(auto &w : workers){
+			w->thread.join();
+		}
+		running = false;
+	}
+
+	unsigned short eventloop::getPort() const{
+		return port;
+	}
+
+	size_t eventloop::connections() const{
+		return openConnections;
+	}
+
+	eventloop::backends eventloop::getBackend() const{
+		return backend;
+	}
+
+	void eventloop::run(worker &w){
+		if(backend == IoUring){
+			// a ring is bound to the thread that created it
+			if(w.ring){
+				w.ring.reset();
+				openConnections -= w.connections.size();
+				w.connections.clear();
+			}
+			try{
+				w.ring.reset(new uring(ringEntries, bufferCount, bufferSize));
+			}
+			catch(const std::exception &e){
+				spdlog::error("eventloop: {}", e.what());
+				return;
+			}
+			runUring(w);
+			return;
+		}
+
+		struct epoll_event events[maxEvents];
+		while(true){
+			int n = epoll_wait(w.epoll, events, maxEvents, -1);
+			if(n < 0 && errno != EINTR){
+				spdlog::error("eventloop: epoll_wait failed: {}", strerror(errno));
+				return;
+			}
+			for(int i = 0; i < n; i++){
+				int fd = events[i].data.fd;
+				if(fd == w.wake){
+					return;
+				}
+				if(fd == w.listener){
+					accept(w);
+					continue;
+				}
+				auto it = w.connections.find(fd);
+				if(it != w.connections.end()){
+					update(w, *it->second, events[i].events);
+				}
+			}
+		}
+	}
+
+	void eventloop::accept(worker &w){
+		while(true){
+			int fd = accept4(w.listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if(fd < 0){
+				if(errno == EINTR || errno == ECONNABORTED){
+					continue;
+				}
+				if(errno != EAGAIN && errno != EWOULDBLOCK){
+					spdlog::error("eventloop: accept failed: {}", strerror(errno));
+				}
+				return;
+			}
+
+			std::unique_ptr<connection> c = create(fd);
+			if(!c){
+				closeHandle(fd);
+				continue;
+			}
+			struct epoll_event event = {EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, {.fd = fd}};
+			epoll_ctl(w.epoll, EPOLL_CTL_ADD, fd, &event);
+			w.connections[fd] = std::move(c);
+			openConnections++;
+		}
+	}
+
+	void eventloop::update(worker &w, connection &c, uint32_t events){
+		bool open = !(events & EPOLLERR);
+		if(open && (events & EPOLLOUT)){
+			open = c.writable();
+		}
+		if(open && (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))){
+			open = c.readable();
+		}
+		if(!open){
+			c.state = connection::Closed;
+			c.onClose();
+			epoll_ctl(w.epoll, EPOLL_CTL_DEL, c.getHandle(), nullptr);
+			remove(w, c);
+		}
+	}
+
+	void eventloop::remove(worker &w, connection &c){
+		w.connections.erase(c.getHandle());
+		openConnections--;
+	}
+
+	// user data of io_uring operations, the descriptor shifted left by 8 and the operation
+	enum operations : uint64_t{
+		Accept,
+		Receive,
+		Send,
+		Poll,
+		Cancel,
+		Wake,
+	};
+
+	static uint64_t tag(int fd, operations operation){
+		return uint64_t(fd) << 8 | operation;
+	}
+
+	static bool prepareAccept(uring &ring, int listener){
+		struct io_uring_sqe *sqe = ring.next();
+		if(!sqe){
+			return false;
+		}
+		sqe->opcode = IORING_OP_ACCEPT;
+		sqe->fd = listener;
+		sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+		sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+		sqe->user_data = tag(listener, Accept);
+		return true;
+	}
+
+	void eventloop::runUring(worker &w){
+		uring &ring = *w.ring;
+		struct io_uring_sqe *sqe = ring.next();
+		sqe->opcode = IORING_OP_POLL_ADD;
+		sqe->fd = w.wake;
+		sqe->poll32_events = POLLIN;
+		sqe->user_data = tag(w.wake, Wake);
+		prepareAccept(ring, w.listener);
+
+		// completions queue up new operations, they're submitted along with the next wait
+		while(ring.wait()){
+			while(struct io_uring_cqe *cqe = ring.peek()){
+				uint64_t data = cqe->user_data;
+				int result = cqe->res;
+				uint32_t flags = cqe->flags;
+				ring.seen();
+
+				switch(data & 0xFF){
+					case Wake:
+						return;
+					case Accept:
+						accepted(w, result, flags);
+						break;
+					case Cancel:
+						break;
+					default:
+						auto it = w.connections.find(data >> 8);
+						if(it != w.connections.end()){
+							completed(w, *it->second, data & 0xFF, result, flags);
+						}
+				}
+			}
+		}
+		spdlog::error("eventloop: io_uring_enter failed: {}", strerror(errno));
+	}
+
+	void eventloop::accepted(worker &w, int result, uint32_t flags){
+		// multishot accept stops after errors
+		if(!(flags & IORING_CQE_F_MORE) && !prepareAccept(*w.ring, w.listener)){
+			spdlog::error("eventloop: couldn't accept connections anymore");
+		}
+		if(result < 0){
+			if(result != -ECONNABORTED){
+				spdlog::error("eventloop: accept failed: {}", strerror(-result));
+			}
+			return;
+		}
+
+		std::unique_ptr<connection> c = create(result);
+		if(!c){
+			closeHandle(result);
+			return;
+		}
+		c->deferred = true;
+		connection &ref = *c;
+		w.connections[result] = std::move(c);
+		openConnections++;
+		if(!receive(w, ref)){
+			shut(w, ref);
+		}
+	}
+
+	void eventloop::completed(worker &w, connection &c, uint64_t operation, int result, uint32_t flags){
+		switch(operation){
+			case Receive:
+				if(!(flags & IORING_CQE_F_MORE)){
+					c.pending--;
+				}
+				if(result > 0){
+					unsigned id = flags >> IORING_CQE_BUFFER_SHIFT;
+					if(c.state == connection::Reading){
+						c.received(std::string_view(w.ring->buffer(id), result));
+					}
+					w.ring->recycle(id);
+					transmit(w, c);
+				}
+				else if(result == 0){
+					// end of stream, the queued output is sent before the connection closes
+					if(c.state == connection::Reading){
+						c.state = connection::Closing;
+					}
+					transmit(w, c);
+				}
+				else if(result != -ENOBUFS){
+					// error or cancelled
+					c.failed = true;
+				}
+				// the receive also ends when the provided buffers ran out
+				if(!c.failed && result != 0 && c.state != connection::Closed && !(flags & IORING_CQE_F_MORE) && !receive(w, c)){
+					c.failed = true;
+				}
+				break;
+			case Send:
+				c.pending--;
+				c.sending--;
+				// a failed send cancels the rest of its chain
+				if(!c.failed && result == int(c.output.front().data.size())){
+					c.output.pop_front();
+				}
+				else{
+					c.failed = true;
+				}
+				if(c.sending == 0){
+					transmit(w, c);
+				}
+				break;
+			case Poll:
+				c.pending--;
+				c.polling = false;
+				if(result < 0){
+					c.failed = true;
+				}
+				transmit(w, c);
+				break;
+		}
+		if(c.failed || c.state == connection::Closed){
+			shut(w, c);
+		}
+	}
+
+	bool eventloop::receive(worker &w, connection &c){
+		struct io_uring_sqe *sqe = w.ring->next();
+		if(!sqe){
+			return false;
+		}
+		sqe->opcode = IORING_OP_RECV;
+		sqe->fd = c.handle;
+		sqe->ioprio = IORING_RECV_MULTISHOT;
+		sqe->flags = IOSQE_BUFFER_SELECT;
+		sqe->buf_group = uring::bufferGroup;
+		sqe->user_data = tag(c.handle, Receive);
+		c.pending++;
+		return true;
+	}
+
+	void eventloop::transmit(worker &w, connection &c){
+		if(c.sending > 0 || c.polling || c.failed || c.state == connection::Closed){
+			return;
+		}
+		// sendfile has no io_uring counterpart, it's called right away and the socket is polled once it's full
+		while(!c.output.empty() && c.output.front().file >= 0){
+			int status = c.writeFile();
+			if(status == 0){
+				struct io_uring_sqe *sqe = w.ring->next();
+				if(sqe){
+					sqe->opcode = IORING_OP_POLL_ADD;
+					sqe->fd = c.handle;
+					sqe->poll32_events = POLLOUT;
+					sqe->user_data = tag(c.handle, Poll);
+					c.pending++;
+					c.polling = true;
+					return;
+				}
+			}
+			if(status <= 0){
+				c.failed = true;
+				return;
+			}
+		}
+
+		// consecutive data segments go out as a chain of linked sends, the kernel runs them in order
+		size_t count = 0;
+		for(auto it = c.output.begin(); it != c.output.end() && it->file < 0 && count < maxIovecs; it++){
+			count++;
+		}
+		w.ring->reserve(count);
+		struct io_uring_sqe *sqe = nullptr;
+		for(auto it = c.output.begin(); c.sending < count; it++){
+			sqe = w.ring->next();
+			if(!sqe){
+				c.failed = true;
+				return;
+			}
+			sqe->opcode = IORING_OP_SEND;
+			sqe->fd = c.handle;
+			sqe->addr = reinterpret_cast<uint64_t>(it->data.data());
+			sqe->len = it->data.size();
+			sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+			sqe->flags = IOSQE_IO_LINK;
+			sqe->user_data = tag(c.handle, Send);
+			c.sending++;
+			c.pending++;
+		}
+		if(sqe){
+			sqe->flags = 0;
+		}
+		if(c.output.empty() && c.state == connection::Closing){
+			c.state = connection::Closed;
+		}
+	}
+
+	// cancels whatever is still in flight, the connection is removed with its last completion
+	void eventloop::shut(worker &w, connection &c){
+		if(!c.cancelled){
+			c.cancelled = true;
+			c.state = connection::Closed;
+			c.onClose();
+			struct io_uring_sqe *sqe = c.pending > 0 ? w.ring->next() : nullptr;
+			if(sqe){
+				sqe->opcode = IORING_OP_ASYNC_CANCEL;
+				sqe->fd = c.handle;
+				sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+				sqe->user_data = tag(c.handle, Cancel);
+			}
+		}
+		if(c.pending == 0){
+			remove(w, c);
+		}
+	}
+}
@@ -0,0 +1,404 @@
+#include <network/http.hpp>
+
+#include <algorithm>
+#include <charconv>
+
+#include <sys/stat.h>
+
+#include <utils/metrics.hpp>
+
+namespace network{
+	namespace http{
+		static bool equalsIgnoreCase(std::string_view a, std::string_view b){
+			return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y){
+				return tolower(x) == tolower(y);
+			});
+		}
+
+		static std::string_view trim(std::string_view str){
+			while(!str.empty() && (str.front() == ' ' || str.front() == '\t')){
+				str.remove_prefix(1);
+			}
+			while(!str.empty() && (str.back() == ' ' || str.back() == '\t')){
+				str.remove_suffix(1);
+			}
+			return str;
+		}
+
+		std::string_view request::get(std::string_view name) const{
+			for(const header &h : headers){
+				if(equalsIgnoreCase(h.name, name)){
+					return h.value;
+				}
+			}
+			return {};
+		}
+
+		void response::set(std::string_view name, std::string_view value){
+			headers.push_back({name, value});
+		}
+
+		static std::string_view contentType(std::string_view path){
+			static const std::pair<std::string_view, std::string_view> types[] = {
+				{".html", "text/html"},
+				{".css", "text/css"},
+				{".js", "text/javascript"},
+				{".json", "application/json"},
+				{".txt", "text/plain"},
+				{".glsl", "text/plain"},
+				{".png", "image/png"},
+				{".jpg", "image/jpeg"},
+				{".svg", "image/svg+xml"},
+				{".ttf", "font/ttf"},
+				{".wasm", "application/wasm"},
+			};
+			for(auto &[extension, type] : types){
+				if(path.ends_with(extension)){
+					return type;
+				}
+			}
+			return "application/octet-stream";
+		}
+
+		bool response::sendFile(const std::string &path){
+			int handle = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			if(handle < 0){
+				return false;
+			}
+			struct stat info;
+			if(fstat(handle, &info) < 0 || !S_ISREG(info.st_mode)){
+				close(handle);
+				return false;
+			}
+			if(file >= 0){
+				close(file);
+			}
+			file = handle;
+			fileSize = info.st_size;
+			set("Content-Type", contentType(path));
+			return true;
+		}
+
+		void response::clear(){
+			status = HttpStatus_OK;
+			headers.clear();
+			body.clear();
+			if(file >= 0){
+				close(file);
+			}
+			file = -1;
+			fileSize = 0;
+		}
+
+		handler serveDirectory(const std::string &root){
+			return [root](const request &req, response &res){
+				if(req.method != "GET" && req.method != "HEAD"){
+					res.status = HttpStatus_MethodNotAllowed;
+					return;
+				}
+				std::string_view path = req.target.substr(0, req.target.find('?'));
+				if(path.empty() || path.front() != '/' || path.find("..") != std::string_view::npos || !res.sendFile(root + std::string(path))){
+					res.status = HttpStatus_NotFound;
+				}
+			};
+		}
+
+		handler serveMetrics(){
+			return [](const request &req, response &res){
+				if(req.method != "GET" && req.method != "HEAD"){
+					res.status = HttpStatus_MethodNotAllowed;
+					return;
+				}
+				std::string_view path = req.target.substr(0, req.target.find('?'));
+				if(path == "/metrics"){
+					res.set("Content-Type", "text/plain; version=0.0.4");
+					res.body = metrics::Registry::get().prometheus();
+				}
+				else if(path == "/metrics.json"){
+					res.set("Content-Type", "application/json");
+					res.body = metrics::Registry::get().json();
+				}
+				else{
+					res.status = HttpStatus_NotFound;
+				}
+			};
+		}
+
+		parser::status parser::fail(int code){
+			m_error = code;
+			return Error;
+		}
+
+		parser::status parser::parse(std::string_view data){
+			if(headerSize == 0){
+				size_t end = data.find("\r\n\r\n", scanned > 3 ? scanned - 3 : 0);
+				if(end == std::string_view::npos){
+					scanned = data.size();
+					return scanned > maxHeaderSize ? fail(HttpStatus_RequestHeaderFieldsTooLarge) : Incomplete;
+				}
+				headerSize = end + 4;
+				if(!parseHead(data.substr(0, end + 2))){
+					return Error;
+				}
+				chunkPos = headerSize;
+			}
+
+			if(chunked){
+				status result = parseChunked(data);
+				if(result == Complete){
+					resolve(data);
+				}
+				return result;
+			}
+			if(data.size() < headerSize + bodySize){
+				return Incomplete;
+			}
+			resolve(data);
+			m_request.body = data.substr(headerSize, bodySize);
+			m_consumed = headerSize + bodySize;
+			return Complete;
+		}
+
+		void parser::resolve(std::string_view data){
+			m_request.method = data.substr(method.offset, method.size);
+			m_request.target = data.substr(target.offset, target.size);
+			m_request.version = data.substr(version.offset, version.size);
+			m_request.headers.resize(headers.size());
+			for(size_t i = 0; i < headers.size(); i++){
+				m_request.headers[i] = {data.substr(headers[i].first.offset, headers[i].first.size), data.substr(headers[i].second.offset, headers[i].second.size)};
+			}
+		}
+
+		bool parser::parseHead(std::string_view head){
+			size_t lineEnd = head.find("\r\n");
+			std::string_view line = head.substr(0, lineEnd);
+			size_t first = line.find(' '), last = line.rfind(' ');
+			if(first == std::string_view::npos || first == last){
+				fail(HttpStatus_BadRequest);
+				return false;
+			}
+			m_request.method = line.substr(0, first);
+			m_request.target = line.substr(first + 1, last - first - 1);
+			m_request.version = line.substr(last + 1);
+			if(m_request.version != "HTTP/1.1" && m_request.version != "HTTP/1.0"){
+				fail(HttpStatus_HTTPVersionNotSupported);
+				return false;
+			}
+			m_request.keepAlive = m_request.version == "HTTP/1.1";
+
+			m_request.headers.clear();
+			for(size_t pos = lineEnd + 2; pos < head.size(); pos = lineEnd + 2){
+				lineEnd = head.find("\r\n", pos);
+				line = head.substr(pos, lineEnd - pos);
+				size_t colon = line.find(':');
+				if(colon == std::string_view::npos || colon == 0){
+					fail(HttpStatus_BadRequest);
+					return false;
+				}
+				m_request.headers.push_back({line.substr(0, colon), trim(line.substr(colon + 1))});
+			}
+
+			std::string_view connection = m_request.get("connection");
+			if(equalsIgnoreCase(connection, "close")){
+				m_request.keepAlive = false;
+			}
+			else if(equalsIgnoreCase(connection, "keep-alive")){
+				m_request.keepAlive = true;
+			}
+
+			std::string_view encoding = m_request.get("transfer-encoding");
+			std::string_view length = m_request.get("content-length");
+			if(!encoding.empty()){
+				if(!equalsIgnoreCase(encoding, "chunked")){
+					fail(HttpStatus_NotImplemented);
+					return false;
+				}
+				chunked = true;
+			}
+			else if(!length.empty()){
+				auto [end, ec] = std::from_chars(length.data(), length.data() + length.size(), bodySize);
+				if(ec != std::errc() || end != length.data() + length.size()){
+					fail(HttpStatus_BadRequest);
+					return false;
+				}
+				if(bodySize > maxBodySize){
+					fail(HttpStatus_PayloadTooLarge);
+					return false;
+				}
+			}
+
+			auto offsets = [&](std::string_view view){
+				return range{size_t(view.data() - head.data()), view.size()};
+			};
+			method = offsets(m_request.method);
+			target = offsets(m_request.target);
+			version = offsets(m_request.version);
+			headers.clear();
+			for(const header &h : m_request.headers){
+				headers.push_back({offsets(h.name), offsets(h.value)});
+			}
+			return true;
+		}
+
+		parser::status parser::parseChunked(std::string_view data){
+			while(true){
+				size_t lineEnd = data.find("\r\n", chunkPos);
+				if(lineEnd == std::string_view::npos){
+					return Incomplete;
+				}
+				std::string_view line = data.substr(chunkPos, lineEnd - chunkPos);
+				size_t size = 0;
+				auto [end, ec] = std::from_chars(line.data(), line.data() + line.size(), size, 16);
+				if(ec != std::errc() || (end != line.data() + line.size() && *end != ';')){
+					return fail(HttpStatus_BadRequest);
+				}
+
+				if(size == 0){
+					// skip trailers up to the terminating empty line
+					size_t trailers = lineEnd + 2, trailerEnd;
+					if(data.size() < trailers + 2){
+						return Incomplete;
+					}
+					if(data.substr(trailers, 2) == "\r\n"){
+						trailerEnd = trailers + 2;
+					}
+					else{
+						trailerEnd = data.find("\r\n\r\n", trailers);
+						if(trailerEnd == std::string_view::npos){
+							return Incomplete;
+						}
+						trailerEnd += 4;
+					}
+					m_request.body = chunkedBody;
+					m_consumed = trailerEnd;
+					return Complete;
+				}
+
+				if(chunkedBody.size() + size > maxBodySize){
+					return fail(HttpStatus_PayloadTooLarge);
+				}
+				if(data.size() < lineEnd + 2 + size + 2){
+					return Incomplete;
+				}
+				chunkedBody.append(data.substr(lineEnd + 2, size));
+				chunkPos = lineEnd + 2 + size + 2;
+			}
+		}
+
+		void parser::reset(){
+			scanned = headerSize = bodySize = m_consumed = chunkPos = 0;
+			chunked = false;
+			chunkedBody.clear();
+			m_error = 0;
+			m_request.body = {};
+		}
+
+		const request& parser::get() const{
+			return m_request;
+		}
+
+		size_t parser::consumed() const{
+			return m_consumed;
+		}
+
+		int parser::error() const{
+			return m_error;
+		}
+
+		void serialize(const response &res, bool keepAlive, std::string &head){
+			char number[32];
+			head.clear();
+			head.append("HTTP/1.1 ");
+			head.append(number, std::to_chars(number, number + sizeof(number), res.status).ptr);
+			head.push_back(' ');
+			head.append(HttpStatusReasonPhrase(res.status));
+			head.append("\r\n");
+			for(const header &h : res.headers){
+				head.append(h.name);
+				head.append(": ");
+				head.append(h.value);
+				head.append("\r\n");
+			}
+			head.append("Content-Length: ");
+			head.append(number, std::to_chars(number, number + sizeof(number), res.file >= 0 ? res.fileSize : res.body.size()).ptr);
+			head.append(keepAlive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n");
+		}
+
+		class session : public connection{
+		public:
+			session(int handle, const server::handler &callback) : connection(handle), callback(callback){}
+
+			size_t onData(std::string_view data) override{
+				size_t consumed = 0;
+				while(getState() == Reading){
+					parser::status status = p.parse(data.substr(consumed));
+					if(status == parser::Incomplete){
+						break;
+					}
+
+					res.clear();
+					bool keepAlive = false, headOnly = false;
+					if(status == parser::Error){
+						res.status = p.error();
+					}
+					else{
+						keepAlive = p.get().keepAlive;
+						headOnly = p.get().method == "HEAD";
+						try{
+							callback(p.get(), res);
+						}
+						catch(const std::exception &e){
+							spdlog::error("http: exception while handling '{}': {}", p.get().target, e.what());
+							res.clear();
+							res.status = HttpStatus_InternalServerError;
+						}
+						consumed += p.consumed();
+					}
+
+					serialize(res, keepAlive, head);
+					if(res.file >= 0 && !headOnly){
+						send({head});
+						sendFile(res.file, 0, res.fileSize);
+						res.file = -1;
+					}
+					else{
+						send({head, headOnly ? std::string_view() : std::string_view(res.body)});
+						// the file of a HEAD request isn't sent, the connection may end before the next clear
+						res.clear();
+					}
+					p.reset();
+					if(!keepAlive){
+						close();
+					}
+				}
+				return consumed;
+			}
+
+		private:
+			const server::handler &callback;
+			parser p;
+			response res;
+			std::string head;
+		};
+
+		server::server(handler callback, unsigned short port, address addr, unsigned threads, eventloop::backends backend) : callback(callback), loop([this](int handle){
+			return std::unique_ptr<connection>(new session(handle, this->callback));
+		}, port, addr, threads, backend){}
+
+		void server::start(){
+			loop.start();
+		}
+
+		void server::stop(){
+			loop.stop();
+		}
+
+		unsigned short server::getPort() const{
+			return loop.getPort();
+		}
+
+		size_t server::connections() const{
+			return loop.connections();
+		}
+	}
+}
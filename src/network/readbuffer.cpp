@@ -0,0 +1,50 @@
+#include <network/readbuffer.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace network{
+	readbuffer::readbuffer(size_t capacity) : buffer(new char[capacity]), capacity(capacity){}
+
+	std::string_view readbuffer::data() const{
+		return std::string_view(buffer.get() + head, tail - head);
+	}
+
+	size_t readbuffer::size() const{
+		return tail - head;
+	}
+
+	bool readbuffer::empty() const{
+		return head == tail;
+	}
+
+	void readbuffer::consume(size_t len){
+		head += std::min(len, size());
+		if(head == tail){
+			head = tail = 0;
+		}
+	}
+
+	std::span<char> readbuffer::prepare(size_t len){
+		if(capacity - tail < len){
+			size_t used = size();
+			if(capacity - used < len){
+				size_t newCapacity = std::max(capacity * 2, used + len);
+				std::unique_ptr<char[]> newBuffer(new char[newCapacity]);
+				memcpy(newBuffer.get(), buffer.get() + head, used);
+				buffer = std::move(newBuffer);
+				capacity = newCapacity;
+			}
+			else{
+				memmove(buffer.get(), buffer.get() + head, used);
+			}
+			head = 0;
+			tail = used;
+		}
+		return std::span<char>(buffer.get() + tail, capacity - tail);
+	}
+
+	void readbuffer::commit(size_t len){
+		tail = std::min(tail + len, capacity);
+	}
+}
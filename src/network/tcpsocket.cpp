@@ -1,5 +1,11 @@
 #include <network/tcpsocket.hpp>
 
+#if !defined(WINDOWS)
+	#include <sys/sendfile.h>
+	#include <netinet/tcp.h>
+	#include <limits.h>
+#endif
+
 namespace network{
 	/*void __attribute__((constructor)) initTCP(){
 		#if defined(WINDOWS)
@@ -38,7 +44,10 @@ namespace network{
 			std::string ipaddress = inet_ntoa(client.sin_addr);
 			setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<char*>(&timeout), sizeof(timeout));
 		}
-		return new tcpsocket(s, client);
+		return wrap(s, client);
+	}
+	tcpsocket* tcpsocket::wrap(SOCKET s, SOCKADDR_IN addr){
+		return new tcpsocket(s, addr);
 	}
 	std::string tcpsocket::getClientIP(){
 		return inet_ntoa(client.sin_addr);
@@ -95,30 +104,24 @@ namespace network{
 		if(::listen(handle, 64) == -1) {
 			spdlog::error("tcpsocket::listen()");
 		}
-		FD_ZERO(&master);
-		FD_ZERO(&readfds);
-		FD_SET(handle, &master);
 	}
 	tcpsocket* tcpsocket::accept(struct timeval timeout){
-		memcpy(&readfds, &master, sizeof(master));
-		int nready = select(handle + 1, &readfds, NULL, NULL, &timeout);
-		for (int i = 0; i <= handle && nready > 0; i++) {
-			if (FD_ISSET(i, &readfds)) {
-				nready--;
-				if(i == handle) {
-					unsigned int len = sizeof(client);
-					int new_socket = ::accept(handle, (struct sockaddr *)&client, &len);
-					if(new_socket >= 0) {
-						setsockopt(new_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-						return new tcpsocket(new_socket, client);
-					}
-					spdlog::error("accept failed");
-					return nullptr;
-				}
-			}
+		struct pollfd listener = {handle, POLLIN, 0};
+		if(poll(&listener, 1, timeout.tv_sec * 1000 + timeout.tv_usec / 1000) <= 0 || !(listener.revents & POLLIN)) {
+			return nullptr;
+		}
+		socklen_t len = sizeof(client);
+		int new_socket = ::accept(handle, (struct sockaddr *)&client, &len);
+		if(new_socket >= 0) {
+			setsockopt(new_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+			return wrap(new_socket, client);
 		}
+		spdlog::error("accept failed");
 		return nullptr;
 	}
+	tcpsocket* tcpsocket::wrap(int handle, struct sockaddr_in addr){
+		return new tcpsocket(handle, addr);
+	}
 	std::string tcpsocket::getClientIP(){
 		std::string ipaddress(16, ' ');
 		struct in_addr ipAddr = client.sin_addr;
@@ -163,36 +166,151 @@ namespace network{
 	}
 
 #endif
+	void tcpsocket::setNoDelay(bool enable){
+		int value = enable;
+		setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
 	tcpsocket::~tcpsocket(){
 		if(isConnected())
 			disconnect();
 	}
 
-	bool tcpsocket::send(std::string data){
-		if(::send(handle, data.c_str(), (size_t)data.size(), 0) == -1){
-			return false;
+#if defined(WINDOWS)
+	bool tcpsocket::send(std::string_view data){
+		while(!data.empty()){
+			int len = ::send(handle, data.data(), (int)data.size(), 0);
+			if(len == SOCKET_ERROR){
+				return false;
+			}
+			data.remove_prefix(len);
+		}
+		return true;
+	}
+#else
+	bool tcpsocket::send(std::string_view data){
+		struct iovec part = {const_cast<char*>(data.data()), data.size()};
+		return send(std::span<const struct iovec>(&part, 1));
+	}
+	bool tcpsocket::send(std::span<const struct iovec> parts){
+		std::vector<struct iovec> iov(parts.begin(), parts.end());
+		size_t first = 0;
+		while(first < iov.size()){
+			struct msghdr message = {};
+			message.msg_iov = iov.data() + first;
+			message.msg_iovlen = std::min<size_t>(iov.size() - first, IOV_MAX);
+			ssize_t len = sendmsg(handle, &message, MSG_NOSIGNAL);
+			if(len < 0){
+				if(errno == EINTR){
+					continue;
+				}
+				return false;
+			}
+			// skip what was sent, the first unfinished part is adjusted in place
+			size_t sent = len;
+			while(first < iov.size() && sent >= iov[first].iov_len){
+				sent -= iov[first++].iov_len;
+			}
+			if(first < iov.size()){
+				iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + sent;
+				iov[first].iov_len -= sent;
+			}
+		}
+		return true;
+	}
+	bool tcpsocket::sendFile(int file, off_t offset, size_t len){
+		while(len > 0){
+			ssize_t sent = sendfile(handle, file, &offset, len);
+			if(sent < 0 && errno == EINTR){
+				continue;
+			}
+			if(sent <= 0){
+				return false;
+			}
+			len -= sent;
 		}
 		return true;
 	}
+#endif
 	std::string tcpsocket::recv(int len){
 		if(isConnected()){
-			std::string data(len+1, '\0');
-			int size = ::recv(handle, &data[0], len, 0);
-			data[size] = '\0';
-			data.resize(size);
+			if(input.empty()){
+				fill(len);
+			}
+			std::string data(input.data().substr(0, len));
+			input.consume(data.size());
 			return data;
 		}
 		return "";
 	}
-	std::string tcpsocket::recvLine(char delim, size_t maxlen){;
+	std::string tcpsocket::recvLine(char delim, size_t maxlen){
 		std::string line = "";
 		if(isConnected()){
-			char c;
-			while(::recv(handle, &c, 1, 0) > 0 && c != delim && line.length() < maxlen){
-				if(c != '\r')
-					line.push_back(c);
+			std::optional<std::string_view> data = readUntil(delim, maxlen);
+			if(data){
+				line = *data;
 			}
+			else{
+				line = input.data().substr(0, maxlen);
+				input.consume(line.size());
+			}
+			std::erase(line, '\r');
 		}
 		return line;
 	}
+
+	std::optional<std::string_view> tcpsocket::readUntil(char delim, size_t maxlen){
+		size_t scanned = 0;
+		while(true){
+			std::string_view data = input.data();
+			size_t pos = data.substr(0, maxlen + 1).find(delim, scanned);
+			if(pos != std::string_view::npos){
+				input.consume(pos + 1);
+				return data.substr(0, pos);
+			}
+			if(data.size() > maxlen){
+				return std::nullopt;
+			}
+			scanned = data.size();
+			if(!fill(1)){
+				return std::nullopt;
+			}
+		}
+	}
+	std::optional<std::string_view> tcpsocket::readLine(size_t maxlen){
+		std::optional<std::string_view> line = readUntil('\n', maxlen + 1);
+		if(line && line->ends_with('\r')){
+			line->remove_suffix(1);
+		}
+		return line;
+	}
+	std::optional<std::string_view> tcpsocket::readExact(size_t len){
+		while(input.size() < len){
+			if(!fill(len - input.size())){
+				return std::nullopt;
+			}
+		}
+		std::string_view data = input.data().substr(0, len);
+		input.consume(len);
+		return data;
+	}
+
+	size_t tcpsocket::getRecvCalls() const{
+		return recvCalls;
+	}
+
+	int tcpsocket::read(char *data, size_t len){
+		return ::recv(handle, data, len, 0);
+	}
+
+	bool tcpsocket::fill(size_t len){
+		std::span<char> space = input.prepare(len);
+		recvCalls++;
+		int size = read(space.data(), space.size());
+		if(size <= 0){
+			return false;
+		}
+		input.commit(size);
+		return true;
+	}
 }
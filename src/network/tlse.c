@@ -1254,6 +1254,10 @@ struct TLSContext {
 #ifdef TLS_12_FALSE_START
     unsigned char false_start;
 #endif
+    tls_session_lookup_function session_lookup;
+    void *session_cache;
+    unsigned short session_cipher;
+    unsigned char session_resumed;
 };
 
 struct TLSPacket {
@@ -1673,7 +1677,7 @@ int _private_rsa_verify_hash_md5sha1(const unsigned char *sig, unsigned long sig
 }
 #endif
 
-int _private_tls_verify_rsa(struct TLSContext *context, unsigned int hash_type, const unsigned char *buffer, unsigned int len, const unsigned char *message, unsigned int message_len) {
+int _private_tls_verify_rsa_ex(struct TLSContext *context, unsigned int hash_type, int pss, const unsigned char *buffer, unsigned int len, const unsigned char *message, unsigned int message_len) {
     tls_init();
     rsa_key key;
     int err;
@@ -1789,11 +1793,10 @@ int _private_tls_verify_rsa(struct TLSContext *context, unsigned int hash_type,
         err = _private_rsa_verify_hash_md5sha1(buffer, len, hash, hash_len, &rsa_stat, &key);
     else
 #endif
-#ifdef WITH_TLS_13
-    if ((context->version == TLS_V13) || (context->version == DTLS_V13))
-        err = rsa_verify_hash_ex(buffer, len, hash, hash_len, LTC_PKCS_1_PSS, hash_idx, 0, &rsa_stat, &key);
+    if (pss)
+        // rsa_pss_rsae salts are as long as the hash (RFC 8446 4.2.3)
+        err = rsa_verify_hash_ex(buffer, len, hash, hash_len, LTC_PKCS_1_PSS, hash_idx, hash_len, &rsa_stat, &key);
     else
-#endif
         err = rsa_verify_hash_ex(buffer, len, hash, hash_len, LTC_PKCS_1_V1_5, hash_idx, 0, &rsa_stat, &key);
     rsa_free(&key);
     if (err)
@@ -1801,6 +1804,14 @@ int _private_tls_verify_rsa(struct TLSContext *context, unsigned int hash_type,
     return rsa_stat;
 }
 
+int _private_tls_verify_rsa(struct TLSContext *context, unsigned int hash_type, const unsigned char *buffer, unsigned int len, const unsigned char *message, unsigned int message_len) {
+#ifdef WITH_TLS_13
+    if ((context->version == TLS_V13) || (context->version == DTLS_V13))
+        return _private_tls_verify_rsa_ex(context, hash_type, 1, buffer, len, message, message_len);
+#endif
+    return _private_tls_verify_rsa_ex(context, hash_type, 0, buffer, len, message, message_len);
+}
+
 #ifdef TLS_LEGACY_SUPPORT
 int _private_rsa_sign_hash_md5sha1(const unsigned char *in, unsigned long inlen, unsigned char *out, unsigned long *outlen, rsa_key *key) {
     unsigned long modulus_bitlen, modulus_bytelen, x;
@@ -4454,6 +4465,8 @@ struct TLSContext *tls_accept(struct TLSContext *context) {
 #endif
         child->alpn = context->alpn;
         child->alpn_count = context->alpn_count;
+        child->session_lookup = context->session_lookup;
+        child->session_cache = context->session_cache;
     }
     return child;
 }
@@ -5427,6 +5440,9 @@ struct TLSPacket *tls_build_server_key_exchange(struct TLSContext *context, int
 void _private_tls_set_session_id(struct TLSContext *context) {
     if (((context->version == TLS_V13) || (context->version == DTLS_V13)) && (context->session_size == TLS_MAX_SESSION_ID))
         return;
+    // offered (client) or accepted (server) session
+    if (context->session_cipher)
+        return;
     if (tls_random(context->session, TLS_MAX_SESSION_ID))
         context->session_size = TLS_MAX_SESSION_ID;
     else
@@ -5776,10 +5792,10 @@ struct TLSPacket *tls_build_hello(struct TLSContext *context, int tls13_downgrad
 #ifdef WITH_TLS_13
                 if ((!context->is_server) && ((context->version == TLS_V13) || (context->version == DTLS_V13))) {
 #ifdef TLS_CURVE25519
-                    extension_len += 70;
+                    extension_len += 72;
 #else
                     // secp256r1 produces 65 bytes export
-                    extension_len += 103;
+                    extension_len += 105;
 #endif
                 }
 #endif
@@ -5842,10 +5858,12 @@ struct TLSPacket *tls_build_hello(struct TLSContext *context, int tls13_downgrad
                 else
                     tls_packet_uint16(packet, context->version);
             } else {
-                tls_packet_uint16(packet, 5);
-                tls_packet_uint8(packet, 4);
+                // TLS 1.2 is offered too, so TLS 1.2 servers can answer (and resume) without a second hello
+                tls_packet_uint16(packet, 7);
+                tls_packet_uint8(packet, 6);
                 tls_packet_uint16(packet, TLS_V13);
                 tls_packet_uint16(packet, 0x7F1C);
+                tls_packet_uint16(packet, TLS_V12);
             }
             if (context->connection_status == 4) {
                 // fallback to the mandatory secp256r1
@@ -6383,6 +6401,8 @@ int tls_parse_hello(struct TLSContext *context, const unsigned char *buf, int bu
     
     int res = 0;
     int downgraded = 0;
+    // servers created for TLS 1.2 don't upgrade when the client supports TLS 1.3
+    unsigned short local_version = context->version;
     int hello_min_size = context->dtls ? TLS_CLIENT_HELLO_MINSIZE + 8 : TLS_CLIENT_HELLO_MINSIZE;
     CHECK_SIZE(hello_min_size, buf_len, TLS_NEED_MORE_DATA)
     // big endian
@@ -6429,6 +6449,9 @@ int tls_parse_hello(struct TLSContext *context, const unsigned char *buf, int bu
     unsigned char session_len = buf[res++];
     CHECK_SIZE(session_len, buf_len - res, TLS_NEED_MORE_DATA)
     if ((session_len) && (session_len <= TLS_MAX_SESSION_ID)) {
+        // the server accepted the offered session if it echoes its id
+        if ((!context->is_server) && (context->session_cipher) && (session_len == context->session_size) && (!memcmp(context->session, &buf[res], session_len)))
+            context->session_resumed = 1;
         memcpy(context->session, &buf[res], session_len);
         context->session_size = session_len;
         DEBUG_DUMP_HEX_LABEL("REMOTE SESSION ID: ", context->session, context->session_size);
@@ -6628,7 +6651,7 @@ int tls_parse_hello(struct TLSContext *context, const unsigned char *buf, int bu
             else
             if (extension_type == 0x2B) {
                 // supported versions
-                if ((context->is_server) && (buf[res] == extension_len - 1)) {
+                if ((context->is_server) && (buf[res] == extension_len - 1) && (local_version == TLS_V13)) {
                     if (extension_len > 4) {
                         DEBUG_DUMP_HEX_LABEL("SUPPORTED VERSIONS", &buf[res], extension_len);
                         int i;
@@ -6755,11 +6778,16 @@ int tls_parse_certificate(struct TLSContext *context, const unsigned char *buf,
     }
 #ifdef WITH_TLS_13
     if ((context->version == TLS_V13) || (context->version == DTLS_V13)) {
+        CHECK_SIZE(1, buf_len - res, TLS_NEED_MORE_DATA)
         int context_size = buf[res];
         res++;
         // must be 0
         if (context_size)
             res += context_size;
+        // the message length covers the request context too
+        if (size_of_all_certificates < (unsigned int)context_size + 1)
+            return TLS_BROKEN_PACKET;
+        size_of_all_certificates -= context_size + 1;
     }
 #endif
 
@@ -6825,7 +6853,8 @@ int tls_parse_certificate(struct TLSContext *context, const unsigned char *buf,
                     // ignore extensions
                     remaining -= 2;
                     unsigned short size = ntohs(*(unsigned short *)&buf[res2]);
-                    if ((size) && (size >= remaining)) {
+                    res2 += 2;
+                    if ((size) && (size <= remaining)) {
                         res2 += size;
                         remaining -= size;
                     }
@@ -7106,7 +7135,13 @@ int tls_parse_server_key_exchange(struct TLSContext *context, const unsigned cha
         } else 
 #endif
         {
-            if (_private_tls_verify_rsa(context, hash_algorithm, signature, sign_size, message, message_len) != 1) {
+            int valid;
+            // rsa_pss_rsae_sha256/384/512 (0x0804-0x0806), offered by TLS 1.3 client hellos and picked by some TLS 1.2 servers
+            if ((hash_algorithm == 8) && (sign_algorithm >= 4) && (sign_algorithm <= 6))
+                valid = _private_tls_verify_rsa_ex(context, sign_algorithm, 1, signature, sign_size, message, message_len);
+            else
+                valid = _private_tls_verify_rsa(context, hash_algorithm, signature, sign_size, message, message_len);
+            if (valid != 1) {
                 DEBUG_PRINT("Server signature FAILED!\n");
                 TLS_FREE(message);
                 return TLS_BROKEN_PACKET;
@@ -7341,6 +7376,14 @@ int tls_parse_finished(struct TLSContext *context, const unsigned char *buf, int
         }
         TLS_FREE(out);
     }
+    if (context->session_resumed) {
+        // abbreviated handshake, the server's finished came first
+        if (context->is_server) {
+            _private_tls_destroy_hash(context);
+            context->connection_status = 0xFF;
+        } else
+            *write_packets = 3;
+    } else
     if (context->is_server)
         *write_packets = 3;
     else
@@ -7471,6 +7514,18 @@ int tls_parse_verify(struct TLSContext *context, const unsigned char *buf, int b
     return 1;
 }
 
+int _private_tls_resume_session(struct TLSContext *context) {
+    if ((!context->session_lookup) || (!context->session_size) || (context->dtls) || (context->version != TLS_V12))
+        return 0;
+    if ((context->session_lookup(context, context->session, context->session_size, context->session_cache) > 0) && (context->session_cipher == context->cipher) && (context->master_key))
+        return 1;
+    TLS_FREE(context->master_key);
+    context->master_key = NULL;
+    context->master_key_len = 0;
+    context->session_cipher = 0;
+    return 0;
+}
+
 int tls_parse_payload(struct TLSContext *context, const unsigned char *buf, int buf_len, tls_validation_function certificate_verify) {
     int orig_len = buf_len;
     if (context->connection_status == 0xFF) {
@@ -7533,6 +7588,8 @@ int tls_parse_payload(struct TLSContext *context, const unsigned char *buf, int
                         context->connection_status = 3;
                         update_hash = 0;
                     }
+                    if ((payload_res > 0) && (write_packets == 2) && (_private_tls_resume_session(context)))
+                        write_packets = 6;
                 } else
                     payload_res = TLS_UNEXPECTED_MESSAGE;
                 break;
@@ -7542,8 +7599,26 @@ int tls_parse_payload(struct TLSContext *context, const unsigned char *buf, int
                 DEBUG_PRINT(" => SERVER HELLO\n");
                 if (context->is_server)
                     payload_res = TLS_UNEXPECTED_MESSAGE;
-                else
+                else {
                     payload_res = tls_parse_hello(context, buf + 1, payload_size, &write_packets, &dtls_cookie_verified);
+                    // TLS 1.3 servers echo the legacy session id without resuming
+                    if (context->version != TLS_V12)
+                        context->session_resumed = 0;
+                    if ((payload_res >= 0) && (context->session_resumed)) {
+                        // abbreviated handshake, the server continues with change cipher spec and finished
+                        if ((context->cipher != context->session_cipher) || (!_private_tls_expand_key(context)))
+                            payload_res = TLS_UNEXPECTED_MESSAGE;
+                        else
+                            context->connection_status = 2;
+                    } else
+                    if ((payload_res >= 0) && (context->session_cipher)) {
+                        // full handshake, the offered session was rejected
+                        TLS_FREE(context->master_key);
+                        context->master_key = NULL;
+                        context->master_key_len = 0;
+                        context->session_cipher = 0;
+                    }
+                }
                 break;
                 // hello verify request
             case 0x03:
@@ -7569,6 +7644,9 @@ int tls_parse_payload(struct TLSContext *context, const unsigned char *buf, int
                             // empty certificates are permitted for client
                             if (payload_res <= 0)
                                 payload_res = 1;
+                        } else {
+                            if ((certificate_verify) && (context->certificates_count))
+                                certificate_verify_alert = certificate_verify(context, context->certificates, context->certificates_count);
                         }
                     } else
                         payload_res = TLS_UNEXPECTED_MESSAGE;
@@ -7826,6 +7904,23 @@ int tls_parse_payload(struct TLSContext *context, const unsigned char *buf, int
                 _private_tls_write_packet(tls_build_finished(context));
                 context->connection_status = 0xFF;
                 break;
+            case 6:
+                // abbreviated handshake, server hello is followed by change cipher spec and finished
+                DEBUG_PRINT("<= SENDING SERVER HELLO (RESUMED SESSION)\n");
+                context->session_resumed = 1;
+                _private_tls_write_packet(tls_build_hello(context, 0));
+                if (!_private_tls_expand_key(context)) {
+                    _private_tls_write_packet(tls_build_alert(context, 1, internal_error));
+                    context->critical_error = 1;
+                    break;
+                }
+                _private_tls_write_packet(tls_build_change_cipher_spec(context));
+                context->cipher_spec_set = 1;
+                DEBUG_PRINT("<= SENDING FINISHED\n");
+                _private_tls_write_packet(tls_build_finished(context));
+                context->cipher_spec_set = 0;
+                context->connection_status = 2;
+                break;
             case 4:
                 // dtls only
                 context->dtls_seq = 1;
@@ -9228,9 +9323,14 @@ struct TLSPacket *tls_build_finished(struct TLSContext *context) {
         } else
 #endif
         {
-            hash_len = _private_tls_done_hash(context, hash);
+            // with a resumed session the client's finished follows and still needs the hash
+            if (context->session_resumed)
+                hash_len = _private_tls_get_hash(context, hash);
+            else
+                hash_len = _private_tls_done_hash(context, hash);
             _private_tls_prf(context, out, TLS_MIN_FINISHED_OPAQUE_LEN, context->master_key, context->master_key_len, (unsigned char *)"server finished", 15, hash, hash_len, NULL, 0);
-            _private_tls_destroy_hash(context);
+            if (!context->session_resumed)
+                _private_tls_destroy_hash(context);
         }
     } else {
 #ifdef WITH_TLS_13
@@ -9595,6 +9695,74 @@ int tls_export_context(struct TLSContext *context, unsigned char *buffer, unsign
     return size;
 }
 
+int tls_export_session(struct TLSContext *context, unsigned char *buffer, unsigned int buf_len) {
+    if ((!context) || (context->connection_status != 0xFF) || (context->version != TLS_V12) || (context->dtls) || (!context->session_size) || (!context->master_key) || (context->master_key_len > 0xFF))
+        return TLS_GENERIC_ERROR;
+    
+    unsigned int size = 4 + context->session_size + context->master_key_len;
+    if (!buffer)
+        return size;
+    if (buf_len < size)
+        return TLS_NO_MEMORY;
+    
+    unsigned int pos = 0;
+    buffer[pos++] = (unsigned char)(context->cipher >> 8);
+    buffer[pos++] = (unsigned char)context->cipher;
+    buffer[pos++] = context->session_size;
+    memcpy(buffer + pos, context->session, context->session_size);
+    pos += context->session_size;
+    buffer[pos++] = (unsigned char)context->master_key_len;
+    memcpy(buffer + pos, context->master_key, context->master_key_len);
+    return size;
+}
+
+int tls_import_session(struct TLSContext *context, const unsigned char *buffer, unsigned int buf_len) {
+    if ((!context) || (!buffer) || (buf_len < 4) || ((context->version != TLS_V12) && (context->version != TLS_V13)) || (context->dtls))
+        return TLS_GENERIC_ERROR;
+    
+    unsigned int session_size = buffer[2];
+    if ((!session_size) || (session_size > TLS_MAX_SESSION_ID) || (buf_len < 4 + session_size))
+        return TLS_BROKEN_PACKET;
+    unsigned int master_key_len = buffer[3 + session_size];
+    if ((!master_key_len) || (buf_len != 4 + session_size + master_key_len))
+        return TLS_BROKEN_PACKET;
+    
+    TLS_FREE(context->master_key);
+    context->master_key = (unsigned char *)TLS_MALLOC(master_key_len);
+    if (!context->master_key) {
+        context->master_key_len = 0;
+        return TLS_NO_MEMORY;
+    }
+    memcpy(context->master_key, buffer + 4 + session_size, master_key_len);
+    context->master_key_len = master_key_len;
+    memcpy(context->session, buffer + 3, session_size);
+    context->session_size = session_size;
+    context->session_cipher = (unsigned short)(buffer[0] << 8 | buffer[1]);
+    return 0;
+}
+
+void tls_set_session_cache(struct TLSContext *context, tls_session_lookup_function lookup, void *cache) {
+    if (context) {
+        context->session_lookup = lookup;
+        context->session_cache = cache;
+    }
+}
+
+const unsigned char *tls_session_id(struct TLSContext *context, unsigned int *len) {
+    if ((!context) || (!context->session_size)) {
+        if (len)
+            *len = 0;
+        return NULL;
+    }
+    if (len)
+        *len = context->session_size;
+    return context->session;
+}
+
+int tls_session_resumed(struct TLSContext *context) {
+    return context ? context->session_resumed : 0;
+}
+
 struct TLSContext *tls_import_context(const unsigned char *buffer, unsigned int buf_len) {
     if ((!buffer) || (buf_len < 64) || (buffer[0] != TLS_SERIALIZED_OBJECT) || (buffer[5] != 0x01)) {
         DEBUG_PRINT("CANNOT IMPORT CONTEXT BUFFER\n");
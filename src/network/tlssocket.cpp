@@ -1,5 +1,442 @@
 #include <network/tlssocket.hpp>
+#include <network/tlse.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#if !defined(WINDOWS)
+	#include <unistd.h>
+#endif
 
 namespace network{
-	//void __attribute__((constructor)) initTLS(){ }
+	static constexpr size_t recordSize = 16 * 1024;	// maximum plaintext per record
+	static constexpr size_t readSize = 64 * 1024;
+	static constexpr unsigned int flushSize = 256 * 1024;	// encrypted bytes that are buffered before sending
+
+	// record buffers are shared by all connections of a thread
+	static thread_local unsigned char buffer[readSize];
+	static thread_local unsigned char plaintext[recordSize];
+#if !defined(WINDOWS)
+	// separate from buffer, files may be sent while decrypted data in buffer is handled
+	static thread_local unsigned char fileBuffer[readSize];
+#endif
+
+	static void init(){
+		static std::once_flag once;
+		std::call_once(once, tls_init);
+	}
+
+	static std::string_view view(std::string_view part){
+		return part;
+	}
+
+#if !defined(WINDOWS)
+	static std::string_view view(const struct iovec &part){
+		return std::string_view(static_cast<const char*>(part.iov_base), part.iov_len);
+	}
+#endif
+
+#if !defined(WINDOWS)
+	// sendfile would put the plaintext on the wire, so file ranges are read and passed to send in pieces
+	template<typename Send>
+	static bool readFile(int file, off_t offset, size_t len, Send send){
+		while(len > 0){
+			ssize_t size = pread(file, fileBuffer, std::min(len, readSize), offset);
+			if(size < 0 && errno == EINTR){
+				continue;
+			}
+			if(size <= 0 || !send(std::string_view(reinterpret_cast<const char*>(fileBuffer), size))){
+				return false;
+			}
+			offset += size;
+			len -= size;
+		}
+		return true;
+	}
+#endif
+
+	// packs the parts into full records, flush is called whenever enough encrypted bytes piled up and once at the end
+	template<typename Parts, typename Flush>
+	static bool encrypt(TLSContext *tls, const Parts &parts, Flush flush){
+		auto write = [&](const unsigned char *data, size_t len){
+			if(tls_write(tls, data, len) != int(len)){
+				return false;
+			}
+			unsigned int buffered = 0;
+			tls_get_write_buffer(tls, &buffered);
+			return buffered < flushSize || flush();
+		};
+
+		size_t used = 0;
+		for(const auto &part : parts){
+			std::string_view data = view(part);
+			while(!data.empty()){
+				// whole records are encrypted straight from the caller's data, the rest is staged
+				if(used == 0 && data.size() >= recordSize){
+					if(!write(reinterpret_cast<const unsigned char*>(data.data()), recordSize)){
+						return false;
+					}
+					data.remove_prefix(recordSize);
+					continue;
+				}
+				size_t len = std::min(recordSize - used, data.size());
+				memcpy(plaintext + used, data.data(), len);
+				used += len;
+				data.remove_prefix(len);
+				if(used == recordSize){
+					if(!write(plaintext, used)){
+						return false;
+					}
+					used = 0;
+				}
+			}
+		}
+		return (used == 0 || write(plaintext, used)) && flush();
+	}
+
+	tlscontext::tlscontext(versions maxVersion, size_t sessionCapacity) : version(maxVersion == TLS13 ? TLS_V13 : TLS_V12), capacity(sessionCapacity){
+		init();
+	}
+
+	tlscontext::tlscontext(std::string_view certificate, std::string_view key, versions maxVersion, size_t sessionCapacity) : version(maxVersion == TLS13 ? TLS_V13 : TLS_V12), capacity(sessionCapacity){
+		init();
+		server = tls_create_context(1, version);
+		if(!server){
+			throw std::runtime_error("tlscontext: couldn't create server context");
+		}
+		if(tls_load_certificates(server, reinterpret_cast<const unsigned char*>(certificate.data()), certificate.size()) <= 0 ||
+			tls_load_private_key(server, reinterpret_cast<const unsigned char*>(key.data()), key.size()) <= 0){
+			tls_destroy_context(server);
+			throw std::runtime_error("tlscontext: couldn't load certificate or private key");
+		}
+		if(capacity > 0){
+			tls_set_session_cache(server, lookup, this);
+		}
+	}
+
+	tlscontext::~tlscontext(){
+		if(server){
+			tls_destroy_context(server);
+		}
+	}
+
+	void tlscontext::loadRootCertificates(std::string_view pem){
+		roots = pem;
+	}
+
+	void tlscontext::insecureSkipVerify(bool skip){
+		skipVerify = skip;
+	}
+
+	bool tlscontext::isServer() const{
+		return server != nullptr;
+	}
+
+	size_t tlscontext::fullHandshakes() const{
+		return full;
+	}
+
+	size_t tlscontext::resumedHandshakes() const{
+		return resumed;
+	}
+
+	TLSContext* tlscontext::create(const std::string &peer){
+		if(server){
+			return tls_accept(server);
+		}
+		TLSContext *tls = tls_create_context(0, version);
+		if(!tls){
+			throw std::runtime_error("tlscontext: couldn't create client context");
+		}
+		if(!roots.empty()){
+			tls_load_root_certificates(tls, reinterpret_cast<const unsigned char*>(roots.data()), roots.size());
+		}
+		if(capacity > 0){
+			std::lock_guard lock(mutex);
+			auto it = sessions.find(peer);
+			// TLS 1.3 client hellos offer it as legacy session id, a TLS 1.2 server may pick it up
+			if(it != sessions.end()){
+				tls_import_session(tls, reinterpret_cast<const unsigned char*>(it->second.data()), it->second.size());
+			}
+		}
+		return tls;
+	}
+
+	void tlscontext::established(TLSContext *connection, const std::string &peer){
+		if(tls_session_resumed(connection)){
+			resumed++;
+			return;
+		}
+		full++;
+
+		int size = capacity > 0 ? tls_export_session(connection, nullptr, 0) : 0;
+		if(size <= 0){
+			return;
+		}
+		std::string session(size, '\0');
+		tls_export_session(connection, reinterpret_cast<unsigned char*>(session.data()), size);
+		std::string key = peer;
+		if(server){
+			unsigned int len = 0;
+			const unsigned char *id = tls_session_id(connection, &len);
+			key.assign(reinterpret_cast<const char*>(id), len);
+		}
+
+		std::lock_guard lock(mutex);
+		if(sessions.insert_or_assign(key, std::move(session)).second){
+			order.push_back(std::move(key));
+			if(order.size() > capacity){
+				sessions.erase(order.front());
+				order.pop_front();
+			}
+		}
+	}
+
+	int (*tlscontext::verifier())(TLSContext*, TLSCertificate**, int){
+		// without root certificates tls_default_verify rejects every chain
+		return server || skipVerify ? nullptr : tls_default_verify;
+	}
+
+	int tlscontext::lookup(TLSContext *connection, const unsigned char *id, unsigned int len, void *self){
+		tlscontext &context = *static_cast<tlscontext*>(self);
+		std::lock_guard lock(context.mutex);
+		auto it = context.sessions.find(std::string(reinterpret_cast<const char*>(id), len));
+		return it != context.sessions.end() && tls_import_session(connection, reinterpret_cast<const unsigned char*>(it->second.data()), it->second.size()) == 0;
+	}
+
+	tlssocket::tlssocket(tlscontext &context) : tcpsocket(AF_INET, SOCK_STREAM, 0), context(context){}
+
+#if defined(WINDOWS)
+	tlssocket::tlssocket(tlscontext &context, SOCKET s, SOCKADDR_IN addr) : tcpsocket(s, addr), context(context), tls(context.create()){}
+
+	tcpsocket* tlssocket::wrap(SOCKET s, SOCKADDR_IN addr){
+		tlssocket *client = new tlssocket(context, s, addr);
+		client->setNoDelay();
+		return client;
+	}
+#else
+	tlssocket::tlssocket(tlscontext &context, int handle, struct sockaddr_in addr) : tcpsocket(handle, addr), context(context), tls(context.create()){}
+
+	tcpsocket* tlssocket::wrap(int handle, struct sockaddr_in addr){
+		tlssocket *client = new tlssocket(context, handle, addr);
+		client->setNoDelay();
+		return client;
+	}
+#endif
+
+	tlssocket::~tlssocket(){
+		if(isConnected()){
+			disconnect();
+		}
+		if(tls){
+			tls_destroy_context(tls);
+		}
+	}
+
+	tcpsocket* tlssocket::accept(struct timeval timeout){
+		tlssocket *client = static_cast<tlssocket*>(tcpsocket::accept(timeout));
+		if(client && !client->handshake()){
+			spdlog::error("tlssocket: handshake with {} failed", client->getClientIP());
+			delete client;
+			return nullptr;
+		}
+		return client;
+	}
+
+	bool tlssocket::connect(std::string host, unsigned short port){
+		if(!tcpsocket::connect(host, port)){
+			return false;
+		}
+		// records are packed already, waiting for more data would only delay handshake messages
+		setNoDelay();
+		if(tls){
+			tls_destroy_context(tls);
+		}
+		peer = host + ":" + std::to_string(port);
+		tls = context.create(peer);
+		// no server name indication for ip addresses
+		if(inet_addr(host.c_str()) == INADDR_NONE){
+			tls_sni_set(tls, host.c_str());
+		}
+		return handshake();
+	}
+
+	void tlssocket::disconnect(){
+		if(tls && tls_established(tls) == 1){
+			tls_close_notify(tls);
+			flush();
+		}
+		if(tls){
+			tls_destroy_context(tls);
+			tls = nullptr;
+		}
+		tcpsocket::disconnect();
+	}
+
+	bool tlssocket::send(std::string_view data){
+		return tls && encrypt(tls, std::initializer_list<std::string_view>{data}, [this](){
+			return flush();
+		});
+	}
+
+#if !defined(WINDOWS)
+	bool tlssocket::send(std::span<const struct iovec> parts){
+		return tls && encrypt(tls, parts, [this](){
+			return flush();
+		});
+	}
+
+	bool tlssocket::sendFile(int file, off_t offset, size_t len){
+		return readFile(file, offset, len, [this](std::string_view data){
+			return send(data);
+		});
+	}
+#endif
+
+	bool tlssocket::handshake(){
+		if(!tls || (!context.isServer() && tls_client_connect(tls) < 0) || !flush()){
+			return false;
+		}
+		int status;
+		while((status = tls_established(tls)) == 0){
+			if(!receive()){
+				return false;
+			}
+		}
+		if(status < 0){
+			return false;
+		}
+		context.established(tls, peer);
+		return true;
+	}
+
+	bool tlssocket::isResumed() const{
+		return tls && tls_session_resumed(tls);
+	}
+
+	int tlssocket::read(char *data, size_t len){
+		while(true){
+			int size = tls_read(tls, reinterpret_cast<unsigned char*>(data), len);
+			if(size != 0 || !receive()){
+				return size;
+			}
+		}
+	}
+
+	bool tlssocket::receive(){
+		int len = tcpsocket::read(reinterpret_cast<char*>(buffer), readSize);
+		if(len <= 0){
+			return false;
+		}
+		int consumed = tls_consume_stream(tls, buffer, len, context.verifier());
+		// handshake messages and alerts are answered right away
+		bool sent = flush();
+		return consumed >= 0 && sent;
+	}
+
+	bool tlssocket::flush(){
+		unsigned int len = 0;
+		const unsigned char *data = tls_get_write_buffer(tls, &len);
+		if(len == 0){
+			return true;
+		}
+		// the plain tcpsocket send, the overrides would encrypt again
+		#if defined(WINDOWS)
+			bool sent = tcpsocket::send(std::string_view(reinterpret_cast<const char*>(data), len));
+		#else
+			struct iovec part = {const_cast<unsigned char*>(data), len};
+			bool sent = tcpsocket::send(std::span<const struct iovec>(&part, 1));
+		#endif
+		tls_buffer_clear(tls);
+		return sent;
+	}
+
+	tlsconnection::tlsconnection(int handle, tlscontext &context) : connection(handle), context(context), tls(context.create()){}
+
+	tlsconnection::~tlsconnection(){
+		tls_destroy_context(tls);
+	}
+
+	size_t tlsconnection::onData(std::string_view data){
+		int consumed = tls_consume_stream(tls, reinterpret_cast<const unsigned char*>(data.data()), data.size(), context.verifier());
+		flush();
+		int status = tls_established(tls);
+		if(consumed < 0 || status < 0){
+			connection::close();
+			return data.size();
+		}
+		if(!established){
+			if(status == 0){
+				return data.size();
+			}
+			established = true;
+			context.established(tls);
+			onHandshake();
+		}
+
+		int len;
+		while(getState() == Reading && (len = tls_read(tls, buffer, readSize)) > 0){
+			// only leftovers of incomplete messages are copied
+			std::string_view decrypted(reinterpret_cast<const char*>(buffer), len);
+			if(input.empty()){
+				size_t used = onDecrypted(decrypted);
+				input.assign(decrypted.substr(used));
+			}
+			else{
+				input.append(decrypted);
+				input.erase(0, onDecrypted(input));
+			}
+		}
+		return data.size();
+	}
+
+	void tlsconnection::send(std::string_view data){
+		send({data});
+	}
+
+	void tlsconnection::send(std::initializer_list<std::string_view> parts){
+		if(established && getState() == Reading){
+			encrypt(tls, parts, [this](){
+				flush();
+				return true;
+			});
+		}
+	}
+
+	void tlsconnection::sendFile(int file, off_t offset, size_t len){
+		bool sent = !established || getState() != Reading || readFile(file, offset, len, [this](std::string_view data){
+			send(data);
+			return getState() == Reading;
+		});
+		::close(file);
+		if(!sent){
+			spdlog::error("tlsconnection: reading the file to send failed");
+			close();
+		}
+	}
+
+	void tlsconnection::close(){
+		if(established && getState() == Reading){
+			tls_close_notify(tls);
+			flush();
+		}
+		connection::close();
+	}
+
+	bool tlsconnection::isEstablished() const{
+		return established;
+	}
+
+	bool tlsconnection::isResumed() const{
+		return tls_session_resumed(tls);
+	}
+
+	void tlsconnection::flush(){
+		unsigned int len = 0;
+		const unsigned char *data = tls_get_write_buffer(tls, &len);
+		if(len > 0){
+			connection::send({std::string_view(reinterpret_cast<const char*>(data), len)});
+			tls_buffer_clear(tls);
+		}
+	}
 }
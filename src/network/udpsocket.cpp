@@ -0,0 +1,58 @@
+#include <network/udpsocket.hpp>
+
+namespace network{
+	udpsocket::udpsocket(address addr, unsigned short port){
+		handle = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		struct sockaddr_in local = {AF_INET, htons(port), {htonl(addr.val)}, {}};
+		if(handle < 0 || ::bind(handle, (struct sockaddr*)&local, sizeof(local)) < 0){
+			std::string error = strerror(errno);
+			if(handle >= 0){
+				close(handle);
+			}
+			throw std::runtime_error("udpsocket: couldn't bind port " + std::to_string(port) + ": " + error);
+		}
+	}
+
+	udpsocket::~udpsocket(){
+		close(handle);
+	}
+
+	std::optional<struct sockaddr_in> udpsocket::resolve(const std::string &host, unsigned short port){
+		struct addrinfo hints = {}, *result;
+		hints.ai_family = AF_INET;
+		hints.ai_socktype = SOCK_DGRAM;
+		if(getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0){
+			return std::nullopt;
+		}
+		struct sockaddr_in peer = *reinterpret_cast<struct sockaddr_in*>(result->ai_addr);
+		peer.sin_port = htons(port);
+		freeaddrinfo(result);
+		return peer;
+	}
+
+	std::string udpsocket::toString(const struct sockaddr_in &peer){
+		char ip[INET_ADDRSTRLEN] = {};
+		inet_ntop(AF_INET, &peer.sin_addr, ip, sizeof(ip));
+		return std::string(ip) + ":" + std::to_string(ntohs(peer.sin_port));
+	}
+
+	bool udpsocket::sendTo(std::span<const uint8_t> data, const struct sockaddr_in &peer){
+		return sendto(handle, data.data(), data.size(), 0, (const struct sockaddr*)&peer, sizeof(peer)) == ssize_t(data.size());
+	}
+
+	int udpsocket::recvFrom(std::span<uint8_t> buffer, struct sockaddr_in &peer){
+		socklen_t len = sizeof(peer);
+		ssize_t size = recvfrom(handle, buffer.data(), buffer.size(), 0, (struct sockaddr*)&peer, &len);
+		if(size < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNREFUSED){
+			spdlog::error("udpsocket: recvfrom failed: {}", strerror(errno));
+		}
+		return size;
+	}
+
+	unsigned short udpsocket::getPort() const{
+		struct sockaddr_in local;
+		socklen_t len = sizeof(local);
+		getsockname(handle, (struct sockaddr*)&local, &len);
+		return ntohs(local.sin_port);
+	}
+}
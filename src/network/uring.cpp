@@ -0,0 +1,185 @@
+#include <network/uring.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace network{
+	// rings shared with the kernel, the side that doesn't own an index only reads it with acquire
+	static unsigned load(unsigned *index){
+		return std::atomic_ref<unsigned>(*index).load(std::memory_order_acquire);
+	}
+
+	static void store(unsigned *index, unsigned value){
+		std::atomic_ref<unsigned>(*index).store(value, std::memory_order_release);
+	}
+
+	static void store(uint16_t *index, uint16_t value){
+		std::atomic_ref<uint16_t>(*index).store(value, std::memory_order_release);
+	}
+
+	static void* map(size_t size, int fd, off_t offset){
+		void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, fd < 0 ? MAP_PRIVATE | MAP_ANONYMOUS : MAP_SHARED | MAP_POPULATE, fd, offset);
+		return memory == MAP_FAILED ? nullptr : memory;
+	}
+
+	uring::uring(unsigned entries, unsigned bufferCount, unsigned bufferSize) : bufferCount(bufferCount), bufferSize(bufferSize){
+		struct io_uring_params params = {};
+		// task work only runs when the loop waits for completions, no interrupts in between
+		params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+		params.cq_entries = entries * 4;
+		fd = syscall(__NR_io_uring_setup, entries, &params);
+		if(fd < 0){
+			throw std::runtime_error(std::string("uring: io_uring_setup failed: ") + strerror(errno));
+		}
+		if(!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_NODROP)){
+			::close(fd);
+			throw std::runtime_error("uring: kernel is too old");
+		}
+
+		ringSize = std::max<size_t>(params.sq_off.array + params.sq_entries * sizeof(unsigned), params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe));
+		sqeSize = params.sq_entries * sizeof(struct io_uring_sqe);
+		ring = map(ringSize, fd, IORING_OFF_SQ_RING);
+		sqeMemory = map(sqeSize, fd, IORING_OFF_SQES);
+		buffers = static_cast<struct io_uring_buf_ring*>(map(bufferCount * sizeof(struct io_uring_buf), -1, 0));
+		bufferMemory = static_cast<char*>(map(size_t(bufferCount) * bufferSize, -1, 0));
+
+		struct io_uring_buf_reg reg = {};
+		reg.ring_addr = reinterpret_cast<uint64_t>(buffers);
+		reg.ring_entries = bufferCount;
+		reg.bgid = bufferGroup;
+		if(!ring || !sqeMemory || !buffers || !bufferMemory || syscall(__NR_io_uring_register, fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0){
+			std::string error = strerror(errno);
+			release();
+			throw std::runtime_error("uring: couldn't set up rings: " + error);
+		}
+
+		char *base = static_cast<char*>(ring);
+		sqHead = reinterpret_cast<unsigned*>(base + params.sq_off.head);
+		sqTail = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+		sqMask = *reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+		sqEntries = params.sq_entries;
+		sqes = static_cast<struct io_uring_sqe*>(sqeMemory);
+		// submission slots map to entries one to one
+		unsigned *array = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+		for(unsigned i = 0; i < sqEntries; i++){
+			array[i] = i;
+		}
+		sqLocalTail = *sqTail;
+
+		cqHead = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+		cqTail = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+		cqMask = *reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+		cqes = reinterpret_cast<struct io_uring_cqe*>(base + params.cq_off.cqes);
+
+		for(unsigned id = 0; id < bufferCount; id++){
+			recycle(id);
+		}
+	}
+
+	uring::~uring(){
+		release();
+	}
+
+	void uring::release(){
+		if(fd >= 0 && buffers){
+			struct io_uring_buf_reg reg = {};
+			reg.bgid = bufferGroup;
+			syscall(__NR_io_uring_register, fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+		}
+		if(fd >= 0){
+			::close(fd);
+		}
+		if(ring){
+			munmap(ring, ringSize);
+		}
+		if(sqeMemory){
+			munmap(sqeMemory, sqeSize);
+		}
+		if(buffers){
+			munmap(buffers, bufferCount * sizeof(struct io_uring_buf));
+		}
+		if(bufferMemory){
+			munmap(bufferMemory, size_t(bufferCount) * bufferSize);
+		}
+		fd = -1;
+		ring = sqeMemory = nullptr;
+		buffers = nullptr;
+		bufferMemory = nullptr;
+	}
+
+	bool uring::supported(){
+		static const bool result = [](){
+			try{
+				uring probe(4, 1, 64);
+				return true;
+			}
+			catch(const std::exception&){
+				return false;
+			}
+		}();
+		return result;
+	}
+
+	struct io_uring_sqe* uring::next(){
+		if(sqLocalTail - load(sqHead) >= sqEntries && (!submit(0) || sqLocalTail - load(sqHead) >= sqEntries)){
+			return nullptr;
+		}
+		struct io_uring_sqe *sqe = &sqes[sqLocalTail & sqMask];
+		memset(sqe, 0, sizeof(*sqe));
+		sqLocalTail++;
+		return sqe;
+	}
+
+	void uring::reserve(unsigned count){
+		if(sqEntries - (sqLocalTail - load(sqHead)) < count){
+			submit(0);
+		}
+	}
+
+	bool uring::wait(){
+		return submit(1);
+	}
+
+	bool uring::submit(unsigned wait){
+		store(sqTail, sqLocalTail);
+		while(true){
+			unsigned pending = sqLocalTail - load(sqHead);
+			if(syscall(__NR_io_uring_enter, fd, pending, wait, wait > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0) >= 0){
+				return true;
+			}
+			if(errno != EINTR){
+				return false;
+			}
+		}
+	}
+
+	struct io_uring_cqe* uring::peek(){
+		unsigned head = *cqHead;
+		return head == load(cqTail) ? nullptr : &cqes[head & cqMask];
+	}
+
+	void uring::seen(){
+		store(cqHead, *cqHead + 1);
+	}
+
+	char* uring::buffer(unsigned id){
+		return bufferMemory + size_t(id) * bufferSize;
+	}
+
+	void uring::recycle(unsigned id){
+		// not buffers->bufs, its empty struct in front moves it by 8 bytes in C++
+		struct io_uring_buf &buf = reinterpret_cast<struct io_uring_buf*>(buffers)[bufferTail & (bufferCount - 1)];
+		buf.addr = reinterpret_cast<uint64_t>(buffer(id));
+		buf.len = bufferSize;
+		buf.bid = id;
+		store(&buffers->tail, ++bufferTail);
+	}
+}
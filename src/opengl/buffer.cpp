@@ -0,0 +1,18 @@
+#include <opengl/buffer.hpp>
+
+namespace opengl {
+	metrics::Counter& uploadBytes() {
+		static metrics::Counter counter("photon_gpu_upload_bytes_total", "bytes uploaded to buffers and textures");
+		return counter;
+	}
+
+	metrics::Counter& drawCalls() {
+		static metrics::Counter counter("photon_gl_draw_calls_total", "draw calls");
+		return counter;
+	}
+
+	metrics::Counter& drawnTriangles() {
+		static metrics::Counter counter("photon_gl_triangles_total", "triangles drawn");
+		return counter;
+	}
+}
@@ -0,0 +1,93 @@
+#include <opengl/querypool.hpp>
+
+namespace opengl {
+	QueryPool::QueryPool(size_t frames, size_t queriesPerFrame) : frames(frames), supported(GLAD_GL_VERSION_3_3) {
+		if(!supported) {
+			return;
+		}
+		for(Frame &frame : this->frames) {
+			frame.queries.resize(queriesPerFrame);
+			glGenQueries(frame.queries.size(), frame.queries.data());
+		}
+	}
+
+	QueryPool::~QueryPool() {
+		for(Frame &frame : frames) {
+			if(!frame.queries.empty()) {
+				glDeleteQueries(frame.queries.size(), frame.queries.data());
+			}
+		}
+	}
+
+	QueryPool& QueryPool::get() {
+		static QueryPool *pool = new QueryPool();
+		return *pool;
+	}
+
+	void QueryPool::beginFrame() {
+		if(!supported) {
+			return;
+		}
+		for(Frame &frame : frames) {
+			collect(frame);
+		}
+
+		current = (current + 1) % frames.size();
+		Frame &frame = frames[current];
+		// a frame whose results are still missing keeps its queries, the new one isn't measured
+		frame.recording = !frame.pending && photon::profiler::capturing();
+		if(frame.recording) {
+			frame.passes.clear();
+			frame.open.clear();
+			frame.used = 0;
+			GLint64 gpu;
+			glGetInteger64v(GL_TIMESTAMP, &gpu);
+			frame.offset = photon::profiler::now() - gpu;
+		}
+	}
+
+	bool QueryPool::begin(const char *name) {
+		if(!supported) {
+			return false;
+		}
+		Frame &frame = frames[current];
+		// the end of every open pass needs a query too
+		if(!frame.recording || frame.used + frame.open.size() + 2 > frame.queries.size()) {
+			return false;
+		}
+		frame.open.push_back(frame.passes.size());
+		frame.passes.push_back({name, frame.used, 0});
+		glQueryCounter(frame.queries[frame.used++], GL_TIMESTAMP);
+		return true;
+	}
+
+	void QueryPool::end() {
+		Frame &frame = frames[current];
+		if(frame.open.empty()) {
+			return;
+		}
+		frame.passes[frame.open.back()].end = frame.used;
+		frame.open.pop_back();
+		glQueryCounter(frame.queries[frame.used++], GL_TIMESTAMP);
+		frame.pending = true;
+	}
+
+	void QueryPool::collect(Frame &frame) {
+		if(!frame.pending || !frame.open.empty()) {
+			return;
+		}
+		// timestamps complete in order, the last one being there means all of them are
+		GLuint available = 0;
+		glGetQueryObjectuiv(frame.queries[frame.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if(!available) {
+			return;
+		}
+		for(const Pass &pass : frame.passes) {
+			GLuint64 begin, end;
+			glGetQueryObjectui64v(frame.queries[pass.begin], GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(frame.queries[pass.end], GL_QUERY_RESULT, &end);
+			track.record(pass.name, begin + frame.offset, end + frame.offset);
+		}
+		frame.pending = false;
+	}
+}
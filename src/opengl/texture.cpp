@@ -1,6 +1,13 @@
 #include <opengl/texture.hpp>
 
+#include <opengl/buffer.hpp>
+
 namespace opengl {
+	template<typename Image_t>
+	static void countUpload(const Image_t &image) {
+		uploadBytes().add(size_t(image.size().x) * image.size().y * image.channels() * image.bitdepth() / 8);
+	}
+
 	Texture::Texture(GLenum type) : type(type) {
 		glGenTextures(1, &handle);
 	}
@@ -91,6 +98,7 @@ namespace opengl {
 		setParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		setParameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 		glTexImage2D(type, 0, internalFormat, image.size().x, image.size().y, 0, format, atomic, image.data());
+		countUpload(image);
 		generateMipmap();
 		unbind();
 	}
@@ -111,6 +119,7 @@ namespace opengl {
 		setParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		setParameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 		glTexImage2D(type, 0, internalFormat, image.size().x, image.size().y, 0, format, atomic, image.data());
+		countUpload(image);
 		generateMipmap();
 		unbind();
 	}
@@ -133,6 +142,7 @@ namespace opengl {
 		setParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		setParameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 		glTexImage2D(type, 0, internalFormat, image.size().x, image.size().y, 0, format, atomic, image.data());
+		countUpload(image);
 		generateMipmap();
 		unbind();
 	}
@@ -164,6 +174,7 @@ namespace opengl {
 				const Image &image = images[i];
 				if(m_size == image.size() && channels == image.channels()) {
 					glTexImage2D(sides[i], 0, internalFormat, m_size.x, m_size.y, 0, format, atomic, image.data());
+					countUpload(image);
 				}
 			}
 			setParameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -202,6 +213,7 @@ namespace opengl {
 				const HDRImage &image = images[i];
 				if(m_size == image.size() && channels == image.channels()) {
 					glTexImage2D(sides[i], 0, internalFormat, m_size.x, m_size.y, 0, format, atomic, image.data());
+					countUpload(image);
 				}
 			}
 			setParameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
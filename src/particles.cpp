@@ -43,61 +43,32 @@ void Particle::update([[maybe_unused]] float time, float dt, const WorldContaine
 	}
 }
 
-ParticleSystem::ParticleSystem(std::shared_ptr<TiledTexture> texture) : texture(texture), buffer(opengl::Buffer<Particle>::Array) {
-	std::ifstream src("assets/particles.glsl", std::ios::ate);
-	std::string buffer(src.tellg(), '\0');
-	src.seekg(src.beg);
-	src.read(buffer.data(), buffer.size());
-	prog = opengl::Program::load(buffer, opengl::Shader::VertexStage | opengl::Shader::GeometryStage | opengl::Shader::FragmentStage);
-
-	this->buffer.initEmpty(opengl::Buffer<Particle>::DynamicDraw, 0);
-	transformUBO.bindBase(0);
-	transformUBO.setData(mat4());
-
-	vao.bind();
-	this->buffer.bind();
-	vao.setVertexAttributes<vec4, vec4, vec4, vec4>();
-	vao.unbind();
-}
-
 void ParticleSystem::update(float time, float dt, const WorldContainer &world) {
 	for(Particle &p : particles) {
 		p.update(time, dt, world);
 	}
-	changed = true;
-}
-
-void ParticleSystem::render(mat4 transform) {
-	if(changed) {
-		buffer.setData(particles, opengl::Buffer<Particle>::DynamicDraw);
-		changed = false;
-	}
-
-	prog.use();
-	transformUBO.bindBase(0);
-	transformUBO.update(transform);
-	if(texture) {
-		texture->activate();
-	}
-	vao.bind();
-	glDrawArrays(GL_POINTS, 0, buffer.size());
-	vao.unbind();
+	revision++;
 }
 
 void ParticleSystem::shift(ivec2 dir) {
 	for(Particle &p : particles) {
 		p.pos += vec2(dir) * Chunk::size * Tile::resolution;
 	}
-}
-
-void ParticleSystem::setTexture(const std::shared_ptr<TiledTexture> &texture) {
-	this->texture = texture;
+	revision++;
 }
 
 size_t ParticleSystem::size() {
 	return particles.size();
 }
 
+const std::vector<Particle>& ParticleSystem::data() const {
+	return particles;
+}
+
+unsigned ParticleSystem::getRevision() const {
+	return revision;
+}
+
 Particle& ParticleSystem::operator[](size_t index) {
 	return particles[index];
 }
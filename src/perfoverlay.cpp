@@ -0,0 +1,98 @@
+#include <perfoverlay.hpp>
+
+#include <algorithm>
+#include <functional>
+
+#include <opengl/buffer.hpp>
+
+#include <world.hpp>
+
+void PerfOverlay::toggle() {
+	visible = !visible;
+	photon::profiler::enableTotals(visible);
+}
+
+bool PerfOverlay::isVisible() const {
+	return visible;
+}
+
+void PerfOverlay::update(float dt) {
+	frameTimes[next] = dt * 1000.0f;
+	next = (next + 1) % history;
+	frames = std::min(frames + 1, history);
+
+	// what the rendering thread did since the last frame
+	auto delta = [](uint64_t value, uint64_t &last) {
+		float result = value - last;
+		last = value;
+		return result;
+	};
+	frameDrawCalls = delta(opengl::drawCalls().threadValue(), drawCalls);
+	frameTriangles = delta(opengl::drawnTriangles().threadValue(), triangles);
+	frameUploadBytes = delta(opengl::uploadBytes().threadValue(), uploadBytes);
+
+	if(!visible) {
+		return;
+	}
+	size_t count = std::min(photon::profiler::totals(totals), maxScopes);
+	for(size_t i = 0; i < count; i++) {
+		const photon::profiler::total &total = totals[i];
+		auto scope = std::find_if(scopes.begin(), scopes.begin() + scopeCount, [&](const Scope &scope) {
+			return scope.name == total.name;
+		});
+		if(scope == scopes.begin() + scopeCount) {
+			if(scopeCount < maxScopes) {
+				scopes[scopeCount++] = {total.name, total.time, 0.0f};
+			}
+			continue;
+		}
+		float ms = (total.time - scope->last) / 1e6f;
+		scope->last = total.time;
+		scope->ms += (ms - scope->ms) * 0.1f;
+	}
+}
+
+float PerfOverlay::low(float share) {
+	if(frames == 0) {
+		return 0.0f;
+	}
+	std::copy_n(frameTimes.begin(), frames, sorted.begin());
+	size_t index = std::min(size_t(frames * share), frames - 1);
+	std::nth_element(sorted.begin(), sorted.begin() + index, sorted.begin() + frames, std::greater<float>());
+	return sorted[index];
+}
+
+void PerfOverlay::render(GuiSystem &gui, vec2 pos) {
+	const vec4 background(0.0f, 0.0f, 0.0f, 0.6f), white(1.0f), grey(1.0f, 1.0f, 1.0f, 0.4f);
+	const vec4 good(0.3f, 0.9f, 0.3f, 1.0f), slow(0.9f, 0.8f, 0.2f, 1.0f), bad(0.9f, 0.2f, 0.2f, 1.0f);
+	const vec2 scale(0.4f);
+	const float width = 2.0f * graphFrames, height = 100.0f, line = 24.0f, budget = 1000.0f / 60.0f;
+
+	// newest frame on the right, the line in the middle is 60 fps
+	gui.rect(pos, pos + vec2(width, height), background);
+	for(size_t i = 0; i < std::min(frames, graphFrames); i++) {
+		float ms = frameTimes[(next + history - 1 - i) % history];
+		float bar = std::min(ms / (2.0f * budget), 1.0f) * height;
+		float x = pos.x + width - 2.0f * (i + 1);
+		gui.rect(vec2(x, pos.y + height - bar), vec2(x + 2.0f, pos.y + height), ms <= budget * 1.05f ? good : ms <= budget * 2.1f ? slow : bad);
+	}
+	gui.rect(pos + vec2(0.0f, height / 2.0f), pos + vec2(width, height / 2.0f + 1.0f), grey);
+
+	vec2 cursor = pos + vec2(0.0f, height + line);
+	float last = frameTimes[(next + history - 1) % history];
+	gui.text("frame: {:.2f} ms, 1% low: {:.1f} fps, 0.1% low: {:.1f} fps", cursor, white, scale, 0.0f, last, 1000.0f / low(0.01f), 1000.0f / low(0.001f));
+	cursor.y += line;
+	gui.text("draw calls: {:.0f}, triangles: {:.0f}, uploads: {:.1f} kB", cursor, white, scale, 0.0f, frameDrawCalls, frameTriangles, frameUploadBytes / 1024.0f);
+	cursor.y += line;
+	WorldMetrics &world = worldMetrics();
+	gui.text("chunks: {:.0f}, queue: {:.0f}, particles: {:.0f}", cursor, white, scale, 0.0f, world.chunks.value(), world.loadQueue.value(), world.particles.value());
+
+	// cpu time per frame of each scope, a full bar is the frame budget
+	for(size_t i = 0; i < scopeCount; i++) {
+		cursor.y += line;
+		const Scope &scope = scopes[i];
+		float bar = std::min(scope.ms / budget, 1.0f) * (width / 2.0f);
+		gui.rect(cursor + vec2(width / 2.0f, -line + 6.0f), cursor + vec2(width / 2.0f + bar, -2.0f), scope.ms <= budget ? good : bad);
+		gui.text("{} {:.2f} ms", cursor, white, scale, 0.0f, scope.name, scope.ms);
+	}
+}
@@ -1,17 +1,34 @@
 #include "platformer.hpp"
 #include <math/noise.hpp>
+#include <utils/profiler.hpp>
+#include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <chrono>
+#include <memory>
+#include <random>
+#include <stdexcept>
 
 using namespace std::chrono_literals;
 
 TileCursor::TileCursor(std::shared_ptr<TiledTexture> sprites) : Entity(sprites) {}
 
 void TileCursor::update([[maybe_unused]] float time, [[maybe_unused]] float dt, [[maybe_unused]] WorldContainer &world) {
-	transform = mat4().translate(pos + 0.5 * Tile::resolution).scale(Tile::resolution + 1.0f);
+	transform = affine2().translate(pos + 0.5f * Tile::resolution).scale(vec2(Tile::resolution + 1.0f));
 }
 
-Game::Game() : opengl::Window({1080, 720}, "Game"), gui(freetype::Font("assets/jetbrains-mono.ttf")) {
+Game::Game() : Game(Options()) {}
+
+Game::Game(const Options &options) : opengl::Window({1080, 720}, "Game"), gui(freetype::Font("assets/jetbrains-mono.ttf")), options(options) {
+	// particles and entities use rand, a session is only reproducible with the same seed
+	if(!options.replay.empty()) {
+		log = InputLog::load(options.replay);
+	}
+	else if(!options.record.empty()) {
+		log = InputLog(std::random_device()());
+	}
+	std::srand(log.getSeed());
+
 	glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
 
 	auto playerSprite = textures.load("assets/player.png", ivec2(16, 13));
@@ -23,20 +40,13 @@ Game::Game() : opengl::Window({1080, 720}, "Game"), gui(freetype::Font("assets/j
 	auto tileset = textures.load("assets/tileset.png", ivec2(32));
 	world.initRenderer(std::ref(cam), player, tileset);
 	world.initGenerator(tileset->scale());
-	world.initParticleSystem(palette);
+	if(options.record.empty() && options.replay.empty()) {
+		world.initStorage("world");
+	}
+	world.initParticleRenderer(palette);
 	world.initTextRenderer(freetype::Font("assets/jetbrains-mono.ttf"));
 
-	for(int i = 5; i < 128; i++) {
-		world[ivec2(i + 4, i)] = Tile::stone;
-		world[ivec2(i + 4, i - 1)] = Tile::stone;
-	}
-	for(int i = 0; i < 16; i++) {
-		world[ivec2(-i - 5, 8)] = Tile::stone;
-	}
-	world[ivec2(-5, 0)] = Tile::stone;
-	world[ivec2(-5, 1)] = Tile::stone;
-	world[ivec2(-5, 2)] = Tile::stone;
-	world[ivec2(-5, 3)] = Tile::stone;
+	buildStartArea(world);
 
 	auto cursorSprite = textures.load("assets/crosshair.png", 1);
 	cursor = world.createEntity<TileCursor>(cursorSprite);
@@ -46,85 +56,153 @@ Game::Game() : opengl::Window({1080, 720}, "Game"), gui(freetype::Font("assets/j
 	glDisable(GL_CULL_FACE);
 
 	onFramebufferResized(getFramebufferSize());
-	glfwSwapInterval(1);
+	glfwSwapInterval(options.vsync ? 1 : 0);
 }
 
 #if defined(MULTITHREADING)
 	int Game::exec() {
 		std::thread updateThread([this](){
-			while(!windowShouldClose()) {
+			while(!windowShouldClose() && !replayFinished()) {
+				photon::profiler::frame();
 				update();
 			}
 		});
-		while(!windowShouldClose()) {
+		while(!windowShouldClose() && !replayFinished()) {
 			pollEvents();
 			updateInputs();
 			render();
 			swapBuffers();
 		}
 		updateThread.join();
+		finishSession();
+		photon::profiler::stop("trace.json");
 		return 0;
 	}
 #else
 	int Game::exec() {
-		while(!windowShouldClose()) {
+		while(!windowShouldClose() && !replayFinished()) {
+			auto start = std::chrono::steady_clock::now();
+			photon::profiler::frame();
 			pollEvents();
 			updateInputs();
 			update();
 			render();
 			swapBuffers();
+			if(!options.replay.empty()) {
+				frameTimes.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+			}
 		}
+		finishSession();
+		photon::profiler::stop("trace.json");
 		return 0;
 	}
 #endif
 
 void Game::update() {
+	photon::profiler::scope profile("Game::update");
 	double current_time = glfwGetTime();
 	dt = time > 0.0 ? (current_time - time) : (1.0f / 60.0f);
 	time = current_time;
+	if(!options.replay.empty()) {
+		// the live cursor doesn't move the tile cursor either, it shows where the log edits
+		frame = log.getFrames()[replayed];
+		dt = options.fixedDt > 0.0f ? options.fixedDt : frame.dt;
+		if(frame.flags & (InputLog::Frame::place | InputLog::Frame::remove)) {
+			cursor->pos = frame.tile * Tile::resolution;
+		}
+	}
+	else {
+		{
+			std::lock_guard<std::mutex> lock(inputMutex);
+			frame = input;
+			input.flags &= ~InputLog::Frame::respawn;
+			cursor->pos = cursorTile * Tile::resolution;
+		}
+		if(!options.record.empty()) {
+			frame.dt = dt;
+			dt = frame.dt;
+			log.push(frame);
+		}
+	}
+	frame.apply(*player, world);
+	elapsed += dt;
 
-	world.update(glfwGetTime(), dt);
+	world.update(elapsed, dt);
 	cam.update();
+	if(!options.replay.empty()) {
+		replayed++;
+	}
 }
 
-void Game::updateInputs() {
-	player->setInput(Player::move, getKey(GLFW_KEY_D) - getKey(GLFW_KEY_A));
-	if(getKey(GLFW_KEY_SPACE))
-		player->setInput(Player::jump, 1.0f);
-	if(getKey(GLFW_KEY_LEFT_ALT) || getKey(GLFW_KEY_RIGHT_ALT))
-		player->setInput(Player::dash, 1.0f);
-	if(getKey(GLFW_KEY_LEFT_SHIFT))
-		player->setInput(Player::walk, 1.0f);
+bool Game::replayFinished() const {
+	return !options.replay.empty() && replayed == log.getFrames().size();
+}
 
-	if(getKey(GLFW_KEY_S)) {
-		player->gravity.y = abs(player->gravity.y);
+void Game::finishSession() {
+	if(!options.record.empty()) {
+		log.save(options.record);
+		spdlog::info("recorded {} frames to {}", log.getFrames().size(), options.record);
 	}
-	else {
-		player->gravity.y = -abs(player->gravity.y);
+	if(!options.replay.empty() && !frameTimes.empty()) {
+		std::vector<float> sorted = frameTimes;
+		std::sort(sorted.begin(), sorted.end());
+		float total = 0.0f;
+		for(float ms : sorted) {
+			total += ms;
+		}
+		spdlog::info("replayed {} frames in {:.3f} s, mean {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms", sorted.size(), total / 1000.0f,
+			total / sorted.size(), sorted[std::min(size_t(sorted.size() * 0.99), sorted.size() - 1)], sorted.back());
 	}
+}
 
+void Game::updateInputs() {
 	lvec2 cursorTileIndex = world.getTileIndex(screenToWorldSpace(getCursorPos()));
-	cursor->pos = cursorTileIndex * Tile::resolution;
 	if(getMouseButton(GLFW_MOUSE_BUTTON_MIDDLE)) {
 		//world.createBloodParticles(screenToWorldSpace(getCursorPos()) - 0.5);
 	}
 
 	updateUI();
+	// a replay ignores the keyboard and mouse, update takes the frames from the log
+	if(!options.replay.empty()) {
+		return;
+	}
+
+	InputLog::Frame sampled;
+	sampled.move = getKey(GLFW_KEY_D) - getKey(GLFW_KEY_A);
+	if(getKey(GLFW_KEY_SPACE))
+		sampled.flags |= InputLog::Frame::jump;
+	if(getKey(GLFW_KEY_LEFT_ALT) || getKey(GLFW_KEY_RIGHT_ALT))
+		sampled.flags |= InputLog::Frame::dash;
+	if(getKey(GLFW_KEY_LEFT_SHIFT))
+		sampled.flags |= InputLog::Frame::walk;
+	if(getKey(GLFW_KEY_S))
+		sampled.flags |= InputLog::Frame::gravityDown;
 
 	if(!gui.usesMouse()) {
+		sampled.tile = cursorTileIndex;
 		if (getMouseButton(GLFW_MOUSE_BUTTON_LEFT)) {
-			world[cursorTileIndex] = Tile::stone;
+			sampled.flags |= InputLog::Frame::place;
 		}
 		else if (getMouseButton(GLFW_MOUSE_BUTTON_RIGHT)) {
-			world[cursorTileIndex] = Tile::null;
+			sampled.flags |= InputLog::Frame::remove;
 		}
 	}
+
+	std::lock_guard<std::mutex> lock(inputMutex);
+	// a click stays pending until a tick took it
+	if(respawnClicked || (input.flags & InputLog::Frame::respawn)) {
+		sampled.flags |= InputLog::Frame::respawn;
+	}
+	respawnClicked = false;
+	input = sampled;
+	cursorTile = cursorTileIndex;
 }
 
 void Game::updateUI() {
 	static float t = 0;
 	static int frames = 0;
 	static float fps = 0;
+	overlay.update(dt);
 	gui.beginFrame(glfwGetTime(), dt);
 		t += dt;
 		frames += 1;
@@ -141,15 +219,20 @@ void Game::updateUI() {
 		gui.text("speed: {} {}", vec2(8.0f, 160.0f), vec4(1.0f), vec2(0.5f), 0.0f, round(player->speed.x), round(player->speed.y));
 		gui.rect(vec2(8.0f, 166.0f), vec2(200.0f, 164.0f), vec4(1.0f));
 
-		if(gui.button("Respawn!", vec2(getFramebufferSize().x - 310.0f, 0.0f), vec4(0.2f, 0.2f, 0.2f, 1.0f))) {
-			player->pos = vec2(0);
-			player->speed = vec2(0);
-			world.shift(world.offset());
+		if(gui.button("Respawn!", vec2(getFramebufferSize().x - 310.0f, 0.0f), vec4(0.2f, 0.2f, 0.2f, 1.0f)) && options.replay.empty()) {
+			respawnClicked = true;
+		}
+
+		if(overlay.isVisible()) {
+			overlay.render(gui, vec2(getFramebufferSize().x - 2.0f * PerfOverlay::graphFrames - 8.0f, 64.0f));
 		}
 	gui.endFrame();
 }
 
 void Game::render() {
+	photon::profiler::scope profile("Game::render");
+	opengl::QueryPool::get().beginFrame();
+	opengl::QueryPool::Scope pass("frame");
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	world.render();
@@ -157,19 +240,20 @@ void Game::render() {
 }
 
 vec2 Game::screenToWorldSpace(vec2 screenpos) {
-	mat4 view = mat4().translate(vec3(0, 0, cam.pos.z)).inverse();
+	// the inverses are a translation back and the one the camera keeps
+	mat4 view = mat4().translate(vec3(0, 0, -cam.pos.z));
 	mat4 proj = cam.proj();
 
 	vec2 normalizedpos = screenpos / getFramebufferSize();
 	vec2 glpos = (normalizedpos * 2 - 1) * vec2(1, -1);
 	vec4 tmp = (proj * view * vec4(0, 0, 0, 1)) + glpos;
-	vec2 worldpos = proj.inverse() * view.inverse() * tmp;
+	vec2 worldpos = cam.projInverse() * mat4().translate(vec3(0, 0, cam.pos.z)) * tmp;
 
 	return worldpos * tmp.w + cam.pos.xy;
 }
 
 vec2 Game::worldToScreenSpace(vec2 worldpos) {
-	mat4 view = mat4().translate(vec3(0, 0, cam.pos.z)).inverse();
+	mat4 view = mat4().translate(vec3(0, 0, -cam.pos.z));
 	mat4 proj = cam.proj();
 
 	vec2 tmp = worldpos - cam.pos.xy;
@@ -184,7 +268,14 @@ void Game::onKeyTyped(int key) {}
 
 void Game::onKeyChanged(int key, int scancode, int modifier, int action) {}
 
-void Game::onKeyPressed(int key, int scancode, int modifier, bool repeat) {}
+void Game::onKeyPressed(int key, int scancode, int modifier, bool repeat) {
+	if(key == GLFW_KEY_F2 && !repeat) {
+		photon::profiler::toggle("trace.json");
+	}
+	if(key == GLFW_KEY_F3 && !repeat) {
+		overlay.toggle();
+	}
+}
 
 void Game::onKeyReleased(int key, int scancode, int modifier) {}
 
@@ -226,6 +317,34 @@ int main(int argc, const char *argv[]) {
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
 
-	Game game;
-	return game.run();
+	Game::Options options;
+	for(size_t i = 1; i < args.size(); i++) {
+		if(args[i] == "--record" && i + 1 < args.size()) {
+			options.record = args[++i];
+		}
+		else if(args[i] == "--replay" && i + 1 < args.size()) {
+			options.replay = args[++i];
+		}
+		else if(args[i] == "--dt" && i + 1 < args.size()) {
+			options.fixedDt = std::stof(args[++i]);
+		}
+		else if(args[i] == "--no-vsync") {
+			options.vsync = false;
+		}
+		else {
+			spdlog::error("usage: {} [--record log | --replay log [--dt seconds]] [--no-vsync]", args[0]);
+			return 1;
+		}
+	}
+
+	// a log that doesn't exist or can't be read throws from the constructor
+	std::unique_ptr<Game> game;
+	try {
+		game = std::unique_ptr<Game>(new Game(options));
+	}
+	catch(const std::runtime_error &e) {
+		spdlog::error("couldn't start the game: {}", e.what());
+		return 1;
+	}
+	return game->run();
 }
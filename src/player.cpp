@@ -242,9 +242,14 @@ void Player::update(float time, float dt, WorldContainer &world) {
 	RigidBody::update(time, dt, world);
 	updateAnimation(time);
 
-	transform = mat4().translate(rpos + vec3(0, 2.5, 0)).scale(vec3(scale, 1));
-	uvtransform = texture->getUVTransform(uvpos);
-	cam->pos.xy = rpos;
+	transform = affine2().translate(rpos + vec2(0, 2.5)).scale(scale);
+	if(texture) {
+		uvtransform = texture->getUVTransform(uvpos);
+	}
+	// headless servers simulate players without a camera
+	if(cam) {
+		cam->pos.xy = rpos;
+	}
 
 	prevInputs = inputs;
 	inputs = {0.0f, 0.0f, 0.0f, 0.0f};
@@ -302,6 +307,23 @@ void Player::playAnimation(uint8_t animation) {
 	animationState = animation;
 }
 
+void Player::saveState(EntityState &state) const {
+	RigidBody::saveState(state);
+	state.state = uint8_t(this->state);
+	state.frame = uvpos.y * 16 + uvpos.x;
+}
+
+void Player::loadState(const EntityState &state) {
+	RigidBody::loadState(state);
+	this->state = State(std::min<uint8_t>(state.state, uint8_t(State::count) - 1));
+	uvpos = ivec2(state.frame % 16, state.frame / 16);
+
+	transform = affine2().translate(rpos + vec2(0, 2.5)).scale(scale);
+	if(texture) {
+		uvtransform = texture->getUVTransform(uvpos);
+	}
+}
+
 bool Player::inputStarted(uint8_t action) const {
 	return (inputs[action] != 0) && (prevInputs[action] == 0);
 }
@@ -0,0 +1,573 @@
+#include <replication.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include <utils/serialization.hpp>
+
+#include <world.hpp>
+
+enum PacketType : uint8_t {
+	SnapshotPacket = 0,
+	AckPacket,
+	DisconnectPacket,
+};
+
+static constexpr unsigned historySize = 64;	// ticks a baseline may lag behind
+static constexpr unsigned sentPackets = 1024;	// datagrams per client that can still be acked
+static constexpr size_t maxPacketSize = 1200;	// below the mtu of most paths, nothing gets fragmented
+static constexpr size_t headerSize = PacketSequence::headerSize, snapshotHeaderSize = headerSize + 16;
+static constexpr float positionScale = 8.0f, speedScale = 4.0f;
+static constexpr std::array<unsigned, 4> deltaBits = {4, 8, 14, 32};
+static constexpr float resendInterval = 0.1f;	// acks are sent at least this often, also serves as hello
+static constexpr auto clientTimeout = std::chrono::seconds(5);
+
+// appends bits lsb first, the last byte is only written by flush
+class BitWriter {
+public:
+	struct Mark {
+		size_t size;
+		uint64_t scratch;
+		unsigned used;
+	};
+
+	BitWriter(std::vector<uint8_t> &out) : out(out) {}
+
+	void write(uint32_t value, unsigned bits) {
+		scratch |= (uint64_t(value) & ((uint64_t(1) << bits) - 1)) << used;
+		used += bits;
+		while(used >= 8) {
+			out.push_back(uint8_t(scratch));
+			scratch >>= 8;
+			used -= 8;
+		}
+	}
+
+	void flush() {
+		if(used > 0) {
+			out.push_back(uint8_t(scratch));
+		}
+		scratch = 0;
+		used = 0;
+	}
+
+	size_t bytes() const {
+		return out.size() + (used > 0);
+	}
+
+	Mark mark() const {
+		return {out.size(), scratch, used};
+	}
+
+	void rewind(const Mark &mark) {
+		out.resize(mark.size);
+		scratch = mark.scratch;
+		used = mark.used;
+	}
+
+private:
+	std::vector<uint8_t> &out;
+	uint64_t scratch = 0;
+	unsigned used = 0;
+};
+
+// reading past the end yields zeros and fails the reader
+class BitReader {
+public:
+	BitReader(std::span<const uint8_t> in) : in(in) {}
+
+	uint32_t read(unsigned bits) {
+		while(used < bits) {
+			if(in.empty()) {
+				failed = true;
+				return 0;
+			}
+			scratch |= uint64_t(in.front()) << used;
+			in = in.subspan(1);
+			used += 8;
+		}
+		uint32_t value = scratch & ((uint64_t(1) << bits) - 1);
+		scratch >>= bits;
+		used -= bits;
+		return value;
+	}
+
+	bool good() const {
+		return !failed;
+	}
+
+private:
+	std::span<const uint8_t> in;
+	uint64_t scratch = 0;
+	unsigned used = 0;
+	bool failed = false;
+};
+
+// zero costs one bit, everything else a size class and zigzag encoded magnitude, wrapping arithmetic on both sides
+static void writeDelta(BitWriter &bits, uint32_t delta) {
+	if(delta == 0) {
+		bits.write(0, 1);
+		return;
+	}
+	uint32_t zigzag = (delta << 1) ^ uint32_t(int32_t(delta) >> 31);
+	uint32_t value = zigzag - 1;
+	unsigned size = 0;
+	while(size < deltaBits.size() - 1 && value >> deltaBits[size]) {
+		size++;
+	}
+	bits.write(1 | size << 1, 3);
+	bits.write(value, deltaBits[size]);
+}
+
+static uint32_t readDelta(BitReader &bits) {
+	if(!bits.read(1)) {
+		return 0;
+	}
+	uint32_t zigzag = bits.read(deltaBits[bits.read(2)]) + 1;
+	return (zigzag >> 1) ^ -(zigzag & 1);
+}
+
+// where the baseline would be after elapsed ticks at its speed
+static QuantizedState predict(const QuantizedState &base, unsigned elapsed, uint8_t tickRate) {
+	QuantizedState predicted = base;
+	for(int axis = 0; axis < 2; axis++) {
+		predicted.pos[axis] += int32_t(int64_t(base.speed[axis]) * elapsed * int64_t(positionScale) / (int64_t(speedScale) * tickRate));
+	}
+	return predicted;
+}
+
+static void encode(BitWriter &bits, const QuantizedState &predicted, const QuantizedState &state) {
+	uint32_t deltas[4] = {
+		uint32_t(state.pos[0]) - uint32_t(predicted.pos[0]), uint32_t(state.pos[1]) - uint32_t(predicted.pos[1]),
+		uint32_t(state.speed[0]) - uint32_t(predicted.speed[0]), uint32_t(state.speed[1]) - uint32_t(predicted.speed[1]),
+	};
+	bool frameChanged = state.frame != predicted.frame;
+	bool stateChanged = state.state != predicted.state || state.flipped != predicted.flipped;
+	if(!deltas[0] && !deltas[1] && !deltas[2] && !deltas[3] && !frameChanged && !stateChanged) {
+		bits.write(0, 1);
+		return;
+	}
+
+	bits.write(1, 1);
+	for(uint32_t delta : deltas) {
+		writeDelta(bits, delta);
+	}
+	bits.write(frameChanged, 1);
+	if(frameChanged) {
+		bits.write(state.frame, 8);
+	}
+	bits.write(stateChanged, 1);
+	if(stateChanged) {
+		bits.write(state.state, 3);
+		bits.write(state.flipped, 1);
+	}
+}
+
+static void decode(BitReader &bits, const QuantizedState &predicted, QuantizedState &state) {
+	state = predicted;
+	if(!bits.read(1)) {
+		return;
+	}
+	state.pos[0] += readDelta(bits);
+	state.pos[1] += readDelta(bits);
+	state.speed[0] += readDelta(bits);
+	state.speed[1] += readDelta(bits);
+	if(bits.read(1)) {
+		state.frame = bits.read(8);
+	}
+	if(bits.read(1)) {
+		state.state = bits.read(3);
+		state.flipped = bits.read(1);
+	}
+}
+
+static vec2 worldOrigin(const WorldContainer &world) {
+	return vec2(world.offset()) * Chunk::size * Tile::resolution;
+}
+
+uint16_t PacketSequence::next() {
+	return local++;
+}
+
+bool PacketSequence::isNew(uint16_t sequence) const {
+	if(!any || newer(sequence, remote)) {
+		return true;
+	}
+	uint16_t distance = remote - sequence;
+	return distance > 0 && distance <= 32 && !(bits & (1u << (distance - 1)));
+}
+
+void PacketSequence::received(uint16_t sequence) {
+	if(!any) {
+		any = true;
+		remote = sequence;
+	}
+	else if(newer(sequence, remote)) {
+		uint16_t distance = sequence - remote;
+		bits = distance < 32 ? bits << distance | 1u << (distance - 1) : distance == 32 ? 1u << 31 : 0;
+		remote = sequence;
+	}
+	else {
+		bits |= 1u << (uint16_t(remote - sequence) - 1);
+	}
+}
+
+uint16_t PacketSequence::ack() const {
+	return remote;
+}
+
+uint32_t PacketSequence::ackBits() const {
+	return bits;
+}
+
+void PacketSequence::writeHeader(uint8_t *out, uint8_t type) {
+	put16(out, next());
+	put16(out + 2, ack());
+	put32(out + 4, ackBits());
+	out[8] = type;
+}
+
+bool PacketSequence::newer(uint16_t a, uint16_t b) {
+	return int16_t(a - b) > 0;
+}
+
+ReplicationServer::ReplicationServer(const WorldContainer &world, unsigned short port, uint8_t tickRate, size_t maxClients)
+ : world(world), socket(network::address::Any, port), tickRate(std::max<uint8_t>(tickRate, 1)), maxClients(maxClients), history(historySize) {}
+
+void ReplicationServer::tick() {
+	receive();
+
+	Snapshot &snapshot = history[currentTick % historySize];
+	snapshot.tick = currentTick;
+	capture(snapshot);
+	for(Client &client : clients) {
+		send(client, snapshot);
+	}
+	currentTick++;
+}
+
+void ReplicationServer::capture(Snapshot &snapshot) const {
+	vec2 origin = worldOrigin(world);
+	snapshot.states.resize(world.entities().size());
+	for(size_t i = 0; i < snapshot.states.size(); i++) {
+		EntityState state;
+		world.entities()[i]->saveState(state);
+		vec2 pos = (state.pos + origin) * positionScale, speed = state.speed * speedScale;
+		snapshot.states[i] = {
+			{int32_t(std::lround(pos.x)), int32_t(std::lround(pos.y))},
+			{int32_t(std::lround(speed.x)), int32_t(std::lround(speed.y))},
+			state.frame, uint8_t(state.state & 7), state.flipped,
+		};
+	}
+}
+
+void ReplicationServer::send(Client &client, const Snapshot &snapshot) {
+	static const std::vector<QuantizedState> none;
+	const std::vector<QuantizedState> *base = &none;
+	unsigned elapsed = 0;
+	if(client.baseline && snapshot.tick - *client.baseline < std::min(historySize, 256u)) {
+		const Snapshot &baseline = history[*client.baseline % historySize];
+		if(baseline.tick == *client.baseline) {
+			base = &baseline.states;
+			elapsed = snapshot.tick - baseline.tick;
+		}
+	}
+
+	// entities are split over as many datagrams as needed, every part can be decoded on its own
+	size_t parts = 0, entity = 0, total = snapshot.states.size();
+	do {
+		if(packets.size() <= parts) {
+			packets.emplace_back();
+		}
+		std::vector<uint8_t> &packet = packets[parts];
+		packet.assign(snapshotHeaderSize, 0);
+		put32(&packet[9], snapshot.tick);
+		packet[13] = elapsed;
+		packet[14] = tickRate;
+		put16(&packet[15], parts);
+		put16(&packet[19], entity);
+		put16(&packet[23], total);
+
+		BitWriter bits(packet);
+		size_t first = entity;
+		for(; entity < total; entity++) {
+			BitWriter::Mark mark = bits.mark();
+			encode(bits, entity < base->size() ? predict((*base)[entity], elapsed, tickRate) : QuantizedState{}, snapshot.states[entity]);
+			if(bits.bytes() > maxPacketSize && entity > first) {
+				bits.rewind(mark);
+				break;
+			}
+		}
+		bits.flush();
+		put16(&packet[21], entity - first);
+		parts++;
+	} while(entity < total);
+
+	for(size_t part = 0; part < parts; part++) {
+		std::vector<uint8_t> &packet = packets[part];
+		put16(&packet[17], parts);
+		client.sequence.writeHeader(packet.data(), SnapshotPacket);
+		uint16_t sequence = get16(packet.data());
+		client.packets[sequence % sentPackets] = {sequence, snapshot.tick, false};
+		if(socket.sendTo(packet, client.peer)) {
+			bytesSent += packet.size();
+			client.stats->bytesSent.add(packet.size());
+		}
+	}
+	client.ticks[snapshot.tick % historySize] = {snapshot.tick, uint16_t(parts), 0};
+}
+
+void ReplicationServer::receive() {
+	std::array<uint8_t, maxPacketSize> buffer;
+	struct sockaddr_in peer;
+	int len;
+	while((len = socket.recvFrom(buffer, peer)) >= 0) {
+		if(len < int(headerSize)) {
+			continue;
+		}
+		auto it = std::find_if(clients.begin(), clients.end(), [&](const Client &client) {
+			return client.peer.sin_addr.s_addr == peer.sin_addr.s_addr && client.peer.sin_port == peer.sin_port;
+		});
+		if(buffer[8] == DisconnectPacket) {
+			if(it != clients.end()) {
+				clients.erase(it);
+			}
+			continue;
+		}
+		if(it == clients.end()) {
+			if(clients.size() >= maxClients) {
+				continue;
+			}
+			clients.push_back({});
+			it = clients.end() - 1;
+			it->peer = peer;
+			it->packets.resize(sentPackets);
+			it->ticks.resize(historySize);
+			metrics::Labels labels = {{"peer", network::udpsocket::toString(peer)}};
+			it->stats.reset(new ClientMetrics{
+				metrics::Counter("photon_replication_bytes_sent_total", "snapshot bytes sent to a client", labels),
+			});
+		}
+
+		Client &client = *it;
+		uint16_t sequence = get16(&buffer[0]);
+		if(!client.sequence.isNew(sequence)) {
+			continue;
+		}
+		client.sequence.received(sequence);
+		client.lastReceived = std::chrono::steady_clock::now();
+
+		uint16_t ack = get16(&buffer[2]);
+		uint32_t ackBits = get32(&buffer[4]);
+		acked(client, ack);
+		for(unsigned i = 0; i < 32; i++) {
+			if(ackBits & (1u << i)) {
+				acked(client, ack - i - 1);
+			}
+		}
+	}
+
+	auto now = std::chrono::steady_clock::now();
+	std::erase_if(clients, [&](const Client &client) {
+		return now - client.lastReceived > clientTimeout;
+	});
+}
+
+void ReplicationServer::acked(Client &client, uint16_t sequence) {
+	SentPacket &packet = client.packets[sequence % sentPackets];
+	if(packet.sequence != sequence || packet.acked) {
+		return;
+	}
+	packet.acked = true;
+
+	SentTick &tick = client.ticks[packet.tick % historySize];
+	if(tick.tick == packet.tick && ++tick.acked == tick.parts && (!client.baseline || tick.tick > *client.baseline)) {
+		client.baseline = tick.tick;
+	}
+}
+
+unsigned short ReplicationServer::getPort() const {
+	return socket.getPort();
+}
+
+size_t ReplicationServer::getClientCount() const {
+	return clients.size();
+}
+
+size_t ReplicationServer::getBytesSent() const {
+	return bytesSent;
+}
+
+uint32_t ReplicationServer::getTick() const {
+	return currentTick;
+}
+
+ReplicationClient::ReplicationClient(const std::string &host, unsigned short port, float delay) : delay(delay), snapshots(historySize) {
+	auto address = network::udpsocket::resolve(host, port);
+	if(!address) {
+		throw std::runtime_error("ReplicationClient: couldn't resolve " + host);
+	}
+	server = *address;
+	send(AckPacket);
+}
+
+ReplicationClient::~ReplicationClient() {
+	send(DisconnectPacket);
+}
+
+void ReplicationClient::update(float dt) {
+	std::array<uint8_t, maxPacketSize> buffer;
+	struct sockaddr_in peer;
+	int len;
+	bool received = false;
+	while((len = socket.recvFrom(buffer, peer)) >= 0) {
+		if(peer.sin_addr.s_addr == server.sin_addr.s_addr && peer.sin_port == server.sin_port && receive(std::span(buffer.data(), len))) {
+			bytesReceived += len;
+			received = true;
+		}
+	}
+
+	sinceSent += dt;
+	if(received || sinceSent >= resendInterval) {
+		send(AckPacket);
+	}
+	interpolate(dt);
+}
+
+bool ReplicationClient::receive(std::span<const uint8_t> datagram) {
+	if(datagram.size() < snapshotHeaderSize || datagram[8] != SnapshotPacket) {
+		return false;
+	}
+	const uint8_t *header = datagram.data();
+	uint16_t packetSequence = get16(header);
+	uint32_t tick = get32(header + 9);
+	uint8_t elapsed = header[13], rate = header[14];
+	uint16_t part = get16(header + 15), parts = get16(header + 17), first = get16(header + 19), count = get16(header + 21), total = get16(header + 23);
+	if(!sequence.isNew(packetSequence) || rate == 0 || part >= parts || first + count > total || (newest && int32_t(tick - newest) <= 0)) {
+		return false;
+	}
+
+	const Received *base = nullptr;
+	if(elapsed > 0) {
+		const Received &baseline = snapshots[(tick - elapsed) % historySize];
+		if(baseline.tick != tick - elapsed || baseline.arrived != baseline.parts) {
+			return false;
+		}
+		base = &baseline;
+	}
+
+	Received &snapshot = snapshots[tick % historySize];
+	if(snapshot.tick != tick) {
+		snapshot.tick = tick;
+		snapshot.parts = parts;
+		snapshot.arrived = 0;
+		snapshot.part.assign(parts, false);
+		snapshot.states.resize(total);
+	}
+	if(snapshot.parts != parts || snapshot.states.size() != total || snapshot.part[part]) {
+		return false;
+	}
+
+	BitReader bits(datagram.subspan(snapshotHeaderSize));
+	for(size_t entity = first; entity < size_t(first) + count; entity++) {
+		decode(bits, base && entity < base->states.size() ? predict(base->states[entity], elapsed, rate) : QuantizedState{}, snapshot.states[entity]);
+	}
+	if(!bits.good()) {
+		return false;
+	}
+
+	// only decodable datagrams are acked, the server must not use a baseline the client doesn't have
+	sequence.received(packetSequence);
+	tickRate = rate;
+	snapshot.part[part] = true;
+	if(++snapshot.arrived == snapshot.parts) {
+		complete(snapshot);
+	}
+	return true;
+}
+
+void ReplicationClient::complete(const Received &snapshot) {
+	newest = snapshot.tick;
+	Frame frame = {snapshot.tick, std::vector<EntityState>(snapshot.states.size())};
+	for(size_t i = 0; i < snapshot.states.size(); i++) {
+		const QuantizedState &state = snapshot.states[i];
+		frame.states[i] = {
+			vec2(state.pos[0], state.pos[1]) / positionScale,
+			vec2(state.speed[0], state.speed[1]) / speedScale,
+			state.frame, state.state, state.flipped,
+		};
+	}
+	frames.push_back(std::move(frame));
+	if(frames.size() > historySize) {
+		frames.pop_front();
+	}
+}
+
+void ReplicationClient::interpolate(float dt) {
+	if(frames.empty()) {
+		return;
+	}
+
+	// the clock runs at the local rate and is only pulled slowly towards delay behind the newest snapshot
+	double target = frames.back().tick - delay * tickRate;
+	time += dt * tickRate;
+	if(std::abs(time - target) > std::max(delay * tickRate, 2.0f)) {
+		time = target;
+	}
+	else {
+		time += (target - time) * std::min(dt * 2.0f, 1.0f);
+	}
+	time = std::clamp(time, double(frames.front().tick), double(frames.back().tick));
+
+	while(frames.size() > 1 && frames[1].tick <= time) {
+		frames.pop_front();
+	}
+
+	const Frame &from = frames.front();
+	if(frames.size() == 1) {
+		states = from.states;
+		return;
+	}
+	const Frame &to = frames[1];
+	float t = (time - from.tick) / (to.tick - from.tick);
+	states = to.states;
+	for(size_t i = 0; i < std::min(from.states.size(), to.states.size()); i++) {
+		EntityState &state = states[i];
+		state = from.states[i];
+		state.pos = lerp(from.states[i].pos, to.states[i].pos, t);
+		state.speed = lerp(from.states[i].speed, to.states[i].speed, t);
+	}
+}
+
+void ReplicationClient::send(uint8_t type) {
+	uint8_t packet[headerSize];
+	sequence.writeHeader(packet, type);
+	socket.sendTo(packet, server);
+	sinceSent = 0.0f;
+}
+
+void ReplicationClient::apply(WorldContainer &world) const {
+	vec2 origin = worldOrigin(world);
+	for(size_t i = 0; i < std::min(states.size(), world.entities().size()); i++) {
+		EntityState state = states[i];
+		state.pos -= origin;
+		world.entities()[i]->loadState(state);
+	}
+}
+
+const std::vector<EntityState>& ReplicationClient::getStates() const {
+	return states;
+}
+
+double ReplicationClient::getTime() const {
+	return tickRate ? time / tickRate : 0.0;
+}
+
+bool ReplicationClient::isSynchronized() const {
+	return !states.empty();
+}
+
+size_t ReplicationClient::getBytesReceived() const {
+	return bytesReceived;
+}
@@ -17,14 +17,6 @@ TiledTexture::TiledTexture(const Image &img) : m_size(img.size()) {
 	texture.unbind();
 }
 
-ivec2 TiledTexture::size() const {
-	return m_size;
-}
-
-vec2 TiledTexture::scale() const {
-	return vec2(1.0f) / vec2(m_size);
-}
-
 ivec2 TiledTexture::textureSize() const {
 	return texture.size();
 }
@@ -32,8 +24,4 @@ ivec2 TiledTexture::textureSize() const {
 void TiledTexture::activate() {
 	texture.activate();
 	texture.bind();
-}
-
-mat4 TiledTexture::getUVTransform(ivec2 pos) const {
-	return mat4().scale(vec3(scale(), 1.0f)).translate(vec3(pos.x, pos.y, 0.0f));
 }
\ No newline at end of file
@@ -93,7 +93,7 @@ void RigidBody::update([[maybe_unused]] float time, float dt, WorldContainer &wo
 	rpos = round((pos + aabbOffset) * 2.0f) / 2;
 	Entity::pos = rpos;
 	AABB::pos = rpos;
-	transform = mat4().translate(rpos).scale(vec3(scale, 1.0f));
+	transform = affine2().translate(rpos).scale(scale);
 }
 
 void RigidBody::applyForce(vec2 f) {
@@ -106,6 +106,23 @@ void RigidBody::shift(ivec2 dir) {
 	Entity::shift(dir);
 }
 
+void RigidBody::saveState(EntityState &state) const {
+	state.pos = pos;
+	state.speed = speed;
+	state.flipped = scale.x < 0.0f;
+}
+
+void RigidBody::loadState(const EntityState &state) {
+	pos = oldPos = state.pos;
+	speed = oldSpeed = state.speed;
+	scale.x = state.flipped ? -std::abs(scale.x) : std::abs(scale.x);
+
+	rpos = round((pos + aabbOffset) * 2.0f) / 2;
+	Entity::pos = rpos;
+	AABB::pos = rpos;
+	transform = affine2().translate(rpos).scale(scale);
+}
+
 bool RigidBody::checkGround(const WorldContainer &world, float &groundY) {
 	vec2 center = pos + aabbOffset;
 	vec2 oldCenter = oldPos + aabbOffset;
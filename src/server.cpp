@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <string>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+#include <utils/profiler.hpp>
+
+#include <world.hpp>
+
+#if defined(REPLICATION)
+#include <network/http.hpp>
+#include <replication.hpp>
+#endif
+
+// dedicated server, simulates the world at a fixed tick rate without a window or gl context
+static std::atomic<bool> running = true, toggleProfiler = false;
+
+static void stop(int) {
+	running = false;
+}
+
+static void profile(int) {
+	toggleProfiler = true;
+}
+
+int main(int argc, char *argv[]) {
+	std::string path = argc > 1 ? argv[1] : "world";
+	int tickRate = argc > 2 ? std::stoi(argv[2]) : 60;
+	[[maybe_unused]] int port = argc > 3 ? std::stoi(argv[3]) : 7777;
+	[[maybe_unused]] int metricsPort = argc > 4 ? std::stoi(argv[4]) : 9464;
+	if(tickRate <= 0 || tickRate > 255) {
+		spdlog::error("tick rate has to be between 1 and 255, got {}", tickRate);
+		return 1;
+	}
+
+	std::signal(SIGINT, stop);
+	std::signal(SIGTERM, stop);
+#if defined(SIGUSR1)
+	// kill -USR1 starts a capture, the next one writes it to trace.json
+	std::signal(SIGUSR1, profile);
+#endif
+
+	// modified chunks get saved when the world is destroyed
+	DynamicWorld<> world;
+	world.initGenerator(vec2(1.0f));
+	world.initStorage(path);
+
+#if defined(REPLICATION)
+	ReplicationServer replication(world, port, tickRate);
+	spdlog::info("replicating on udp port {}", replication.getPort());
+
+	// scraped rarely, one worker is plenty
+	network::http::server metrics(network::http::serveMetrics(), metricsPort, network::address::Any, 1);
+	metrics.start();
+	spdlog::info("metrics on http://localhost:{}/metrics", metrics.getPort());
+#endif
+
+	using clock = std::chrono::steady_clock;
+	const clock::duration tick = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / tickRate));
+	const float dt = 1.0f / tickRate;
+	const clock::time_point start = clock::now();
+
+	spdlog::info("simulating '{}' at {} ticks per second", path, tickRate);
+
+	clock::time_point next = start, report = start;
+	uint64_t ticks = 0, reportTicks = 0;
+	double busy = 0.0, worst = 0.0;
+	while(running) {
+		if(toggleProfiler.exchange(false)) {
+			photon::profiler::toggle("trace.json");
+		}
+		photon::profiler::frame();
+
+		clock::time_point begin = clock::now();
+		world.update(std::chrono::duration<float>(begin - start).count(), dt);
+#if defined(REPLICATION)
+		replication.tick();
+#endif
+		clock::time_point end = clock::now();
+
+		double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+		busy += ms;
+		worst = std::max(worst, ms);
+		ticks++;
+		reportTicks++;
+
+		if(end - report >= std::chrono::seconds(10)) {
+			spdlog::info("tick {}: {:.2f} ms average, {:.2f} ms worst, {} chunks, {} entities", ticks, busy / reportTicks, worst, world.chunks().size(), world.entities().size());
+			report = end;
+			reportTicks = 0;
+			busy = worst = 0.0;
+		}
+
+		// a server that fell far behind skips the missed ticks instead of running them back to back
+		next += tick;
+		if(end - next > tick * 8) {
+			spdlog::warn("{:.0f} ms behind, skipping ticks", std::chrono::duration<double, std::milli>(end - next).count());
+			next = end;
+		}
+		std::this_thread::sleep_until(next);
+	}
+
+	spdlog::info("stopping after {} ticks", ticks);
+	photon::profiler::stop("trace.json");
+#if defined(REPLICATION)
+	metrics.stop();
+#endif
+	return 0;
+}
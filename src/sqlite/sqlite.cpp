@@ -1,56 +1,150 @@
 #include <sqlite/sqlite.hpp>
 
 namespace sqlite{
-	stmt::stmt(std::string querry, database *db, std::vector<variant> values){
+	stmt::stmt(std::string_view querry, database *db){
 		this->db = db->handle;
-		if(sqlite3_prepare_v2(this->db, querry.c_str(), -1, &handle, nullptr) == SQLITE_OK){
-			setArgs(values);
-		}
-		else{
-			std::string error = sqlite3_errmsg(this->db);
+		if(sqlite3_prepare_v3(this->db, querry.data(), querry.size(), SQLITE_PREPARE_PERSISTENT, &handle, nullptr) != SQLITE_OK){
+			throw std::runtime_error(std::string("sqlite: ") + sqlite3_errmsg(this->db));
 		}
 	}
+	stmt::stmt(std::string querry, database *db, const std::vector<variant> &values) : stmt(std::string_view(querry), db){
+		setArgs(values);
+	}
 	stmt::~stmt(){
 		sqlite3_finalize(handle);
 	}
-	void stmt::setArgs(std::vector<variant> values){
+	void stmt::setArgs(const std::vector<variant> &values){
 		reset();
+		sqlite3_clear_bindings(handle);
 		int i = 1;
-		for(variant &value : values){
-			int type = value.index();
-			int r = SQLITE_OK;
-			switch(type){
-				case 1:{
-					sqlite3_bind_int(handle, i, std::get<int>(value));
-				} break;
-				case 2:{
-					r = sqlite3_bind_double(handle, i, std::get<double>(value));
-				} break;
-				case 3:{
-					std::string val = std::get<std::string>(value);
-					r = sqlite3_bind_text(handle, i, val.data(), val.length(), SQLITE_TRANSIENT);
-				} break;
-				case 4:{
-					std::vector<unsigned char> val = std::get<std::vector<unsigned char>>(value);
-					r = sqlite3_bind_blob(handle, i, val.data(), val.size(), SQLITE_TRANSIENT);
-				} break;
-			}
-			if(r != SQLITE_OK){
-			}
-			i++;
+		for(const variant &value : values){
+			bindValue(i++, value);
+		}
+	}
+
+	static void check(sqlite3 *db, int r){
+		if(r != SQLITE_OK){
+			throw std::runtime_error(std::string("sqlite: ") + sqlite3_errmsg(db));
 		}
-		std::string error = sqlite3_errmsg(this->db);
-		if(error != "not an error" && error != "another row available" && error != "column index out of range"){
+	}
+
+	void stmt::bindValue(int i, std::monostate){
+		check(db, sqlite3_bind_null(handle, i));
+	}
+	void stmt::bindValue(int i, int value){
+		check(db, sqlite3_bind_int(handle, i, value));
+	}
+	void stmt::bindValue(int i, int64_t value){
+		check(db, sqlite3_bind_int64(handle, i, value));
+	}
+	void stmt::bindValue(int i, double value){
+		check(db, sqlite3_bind_double(handle, i, value));
+	}
+	void stmt::bindValue(int i, std::string_view value){
+		check(db, sqlite3_bind_text(handle, i, value.data(), value.size(), SQLITE_STATIC));
+	}
+	void stmt::bindValue(int i, const char *value){
+		bindValue(i, std::string_view(value));
+	}
+	void stmt::bindValue(int i, const std::string &value){
+		bindValue(i, std::string_view(value));
+	}
+	void stmt::bindValue(int i, blob value){
+		check(db, sqlite3_bind_blob(handle, i, value.data(), value.size(), SQLITE_STATIC));
+	}
+	void stmt::bindValue(int i, const std::vector<unsigned char> &value){
+		bindValue(i, blob(value));
+	}
+	void stmt::bindValue(int i, const variant &value){
+		// variants are usually temporaries, so their contents get copied
+		switch(value.index()){
+			case 0:{
+				bindValue(i, std::monostate());
+			} break;
+			case 1:{
+				bindValue(i, std::get<int>(value));
+			} break;
+			case 2:{
+				bindValue(i, std::get<double>(value));
+			} break;
+			case 3:{
+				const std::string &val = std::get<std::string>(value);
+				check(db, sqlite3_bind_text(handle, i, val.data(), val.length(), SQLITE_TRANSIENT));
+			} break;
+			case 4:{
+				const std::vector<unsigned char> &val = std::get<std::vector<unsigned char>>(value);
+				check(db, sqlite3_bind_blob(handle, i, val.data(), val.size(), SQLITE_TRANSIENT));
+			} break;
 		}
 	}
 
 	database::database(std::string fileName)
 	{
-		sqlite3_open(fileName.data(), &handle);
+		if(sqlite3_open(fileName.data(), &handle) != SQLITE_OK){
+			std::string error = sqlite3_errmsg(handle);
+			sqlite3_close(handle);
+			throw std::runtime_error("sqlite: couldn't open '" + fileName + "': " + error);
+		}
 	}
 
 	database::~database()
 	{
+		statements.clear();
 		sqlite3_close(handle);
 	}
+
+	void database::enableWAL(){
+		execute(
+			"PRAGMA journal_mode = WAL;"
+			"PRAGMA synchronous = NORMAL;"
+			"PRAGMA temp_store = MEMORY;"
+			"PRAGMA cache_size = -16384;"
+			"PRAGMA mmap_size = 268435456;"
+		);
+	}
+
+	void database::execute(const std::string &querry){
+		char *error = nullptr;
+		if(sqlite3_exec(handle, querry.c_str(), nullptr, nullptr, &error) != SQLITE_OK){
+			std::string message = error ? error : "unknown error";
+			sqlite3_free(error);
+			throw std::runtime_error("sqlite: " + message);
+		}
+	}
+
+	stmt& database::prepare(std::string_view querry){
+		auto it = statements.find(querry);
+		if(it == statements.end()){
+			it = statements.emplace(std::string(querry), std::unique_ptr<stmt>(new stmt(querry, this))).first;
+		}
+		it->second->reset();
+		return *it->second;
+	}
+
+	int database::changes(){
+		return sqlite3_changes(handle);
+	}
+
+	int64_t database::lastInsertRowid(){
+		return sqlite3_last_insert_rowid(handle);
+	}
+
+	transaction::transaction(database &db) : db(db){
+		db.prepare("BEGIN IMMEDIATE").bind().step();
+	}
+
+	transaction::~transaction(){
+		if(!done){
+			try{
+				db.prepare("ROLLBACK").bind().step();
+			}
+			catch(const std::exception&){
+			}
+		}
+	}
+
+	void transaction::commit(){
+		db.prepare("COMMIT").bind().step();
+		done = true;
+	}
 }
@@ -0,0 +1,100 @@
+#include <sqliteworld.hpp>
+
+#include <spdlog/spdlog.h>
+
+SqliteWorldDB::SqliteWorldDB(const std::string &path) : path(path), db(path) {
+	db.enableWAL();
+	db.execute(
+		"CREATE TABLE IF NOT EXISTS chunks (x INTEGER NOT NULL, y INTEGER NOT NULL, data BLOB NOT NULL, PRIMARY KEY (x, y));"
+	);
+}
+
+SqliteWorldDB::~SqliteWorldDB() {
+	try {
+		flush();
+	}
+	catch(const std::exception &e) {
+		spdlog::error("couldn't save world to '{}': {}", path, e.what());
+	}
+}
+
+bool SqliteWorldDB::select(std::string_view querry, lvec2 pos, std::vector<uint8_t> &data) {
+	for(auto [blob] : db.query<sqlite::blob>(querry, pos.x, pos.y)) {
+		data.assign(blob.begin(), blob.end());
+		return true;
+	}
+	return false;
+}
+
+bool SqliteWorldDB::read(lvec2 pos, std::vector<uint8_t> &data) {
+	auto it = pendingChunks.find(pos);
+	if(it != pendingChunks.end()) {
+		if(!it->second) {
+			return false;
+		}
+		data = *it->second;
+		return true;
+	}
+	return select("SELECT data FROM chunks WHERE x = ? AND y = ?", pos, data);
+}
+
+void SqliteWorldDB::write(lvec2 pos, std::vector<uint8_t> &&data) {
+	pendingChunks[pos] = std::make_shared<const std::vector<uint8_t>>(std::move(data));
+}
+
+void SqliteWorldDB::erase(lvec2 pos) {
+	pendingChunks[pos] = nullptr;
+}
+
+bool SqliteWorldDB::load(Chunk &chunk) {
+	std::vector<uint8_t> data;
+	ChunkDelta delta;
+	if(!read(chunk.getPos(), data)) {
+		return false;
+	}
+	if(!ChunkDelta::deserialize(data, delta)) {
+		spdlog::error("invalid delta for chunk ({}, {}) in '{}'", chunk.getPos().x, chunk.getPos().y, path);
+		return false;
+	}
+	delta.apply(chunk);
+	chunk.setModified(false);
+	return true;
+}
+
+void SqliteWorldDB::save(Chunk &chunk, const Chunk &baseline) {
+	ChunkDelta delta(baseline, chunk);
+	if(delta.empty()) {
+		erase(chunk.getPos());
+	}
+	else {
+		write(chunk.getPos(), delta.serialize());
+	}
+	chunk.setModified(false);
+}
+
+void SqliteWorldDB::flush() {
+	if(pendingChunks.empty()) {
+		return;
+	}
+
+	sqlite::transaction transaction(db);
+	for(auto &[pos, data] : pendingChunks) {
+		if(data) {
+			db.prepare("INSERT OR REPLACE INTO chunks (x, y, data) VALUES (?, ?, ?)").bind(pos.x, pos.y, sqlite::blob(*data)).run();
+		}
+		else {
+			db.prepare("DELETE FROM chunks WHERE x = ? AND y = ?").bind(pos.x, pos.y).run();
+		}
+	}
+	transaction.commit();
+
+	pendingChunks.clear();
+}
+
+void SqliteWorldDB::sync() {
+	flush();
+}
+
+size_t SqliteWorldDB::pendingWrites() {
+	return pendingChunks.size();
+}
@@ -1,5 +1,9 @@
 #include <text.hpp>
 
+#include <math/transform.hpp>
+
+#include <utils/profiler.hpp>
+
 TextObject::TextObject(const std::string &text, mat4 transform, vec4 color)
 : text(text), transform(transform), color(color) {}
 
@@ -59,36 +63,28 @@ vec2 TextRenderer::calcSize(const std::shared_ptr<TextObject> &object) {
 }
 
 void TextRenderer::update() {
+	photon::profiler::scope profile("TextRenderer::update");
 	std::lock_guard<std::mutex> lock(objectMutex);
 	vertices.clear();
 	indices.clear();
 
 	for(const auto &object : objects) {
 		std::string text = object->text;
+		size_t first = vertices.size();
+		corners.clear();
 
+		// the corners of all glyphs are transformed at once when the object is complete
 		auto quad = [&](vec2 pos, vec2 size, vec2 uv) {
 			unsigned baseIndex = vertices.size();
 
-			vertices.push_back(Vertex{
-				object->transform * vec4(pos + vec2(0, -size.y), 0, 1),
-				(uv + vec2(0, size.y)) / texture.size(),
-				object->color
-			});
-			vertices.push_back(Vertex{
-				object->transform * vec4(pos + vec2(0), 0, 1),
-				(uv + vec2(0)) / texture.size(),
-				object->color
-			});
-			vertices.push_back(Vertex{
-				object->transform * vec4(pos + vec2(size.x, 0), 0, 1),
-				(uv + vec2(size.x, 0)) / texture.size(),
-				object->color
-			});
-			vertices.push_back(Vertex{
-				object->transform * vec4(pos + vec2(size.x, -size.y), 0, 1),
-				(uv + vec2(size)) / texture.size(),
-				object->color
-			});
+			corners.push_back(vec4(pos + vec2(0, -size.y), 0, 1));
+			corners.push_back(vec4(pos + vec2(0), 0, 1));
+			corners.push_back(vec4(pos + vec2(size.x, 0), 0, 1));
+			corners.push_back(vec4(pos + vec2(size.x, -size.y), 0, 1));
+			vertices.push_back(Vertex{vec3(), (uv + vec2(0, size.y)) / texture.size(), object->color});
+			vertices.push_back(Vertex{vec3(), (uv + vec2(0)) / texture.size(), object->color});
+			vertices.push_back(Vertex{vec3(), (uv + vec2(size.x, 0)) / texture.size(), object->color});
+			vertices.push_back(Vertex{vec3(), (uv + vec2(size)) / texture.size(), object->color});
 
 			indices.push_back(baseIndex + 0);
 			indices.push_back(baseIndex + 1);
@@ -104,6 +100,11 @@ void TextRenderer::update() {
 			quad(vec2(x, y) + pos, size, uv);
 			x += advanceX;
 		}
+
+		math::transform_points(corners, object->transform, corners);
+		for(size_t i = 0; i < corners.size(); i++) {
+			vertices[first + i].get<0>() = vec3(corners[i]);
+		}
 	}
 	changed = true;
 }
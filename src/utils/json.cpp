@@ -1,5 +1,7 @@
 #include <utils/json.hpp>
 
+#include <cstring>
+
 // parse a string
 //	+ really fast
 //	- entire source needs to be in memory at the same time
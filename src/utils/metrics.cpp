@@ -0,0 +1,408 @@
+#include <utils/metrics.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+
+#include <spdlog/fmt/fmt.h>
+
+namespace metrics {
+	static constexpr double windowLength = 10.0;
+
+	constinit thread_local std::atomic<uint64_t> *detail::localBlock = nullptr;
+	static constinit thread_local bool exited = false;
+
+	static double now() {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// folds the block of an exiting thread into the shared one
+	struct Detacher {
+		~Detacher() {
+			Registry &registry = Registry::get();
+			std::lock_guard lock(registry.mutex);
+			std::atomic<uint64_t> *block = detail::localBlock;
+			for(Metric *metric : registry.metrics) {
+				for(size_t i = metric->slot; i < metric->slot + metric->slots; i++) {
+					uint64_t value = block[i].load(std::memory_order_relaxed);
+					if(metric->type == Metric::HistogramType && i == metric->slot + metric->slots - 1) {
+						registry.retired[i] = std::bit_cast<uint64_t>(std::bit_cast<double>(registry.retired[i]) + std::bit_cast<double>(value));
+					}
+					else {
+						registry.retired[i] += value;
+					}
+				}
+			}
+			std::erase(registry.blocks, block);
+			// later allocations of this thread, from other thread_local destructors, aren't counted anymore
+			exited = true;
+			detail::localBlock = nullptr;
+			std::free(block);
+		}
+	};
+
+	std::atomic<uint64_t>* detail::attach() {
+		static std::atomic<uint64_t> discarded[maxSlots];
+		if(exited) {
+			return discarded;
+		}
+
+		// not new, this may be called from inside operator new
+		void *memory = std::calloc(maxSlots, sizeof(std::atomic<uint64_t>));
+		if(!memory) {
+			return discarded;
+		}
+		std::atomic<uint64_t> *block = static_cast<std::atomic<uint64_t>*>(memory);
+		for(size_t i = 0; i < maxSlots; i++) {
+			new(&block[i]) std::atomic<uint64_t>(0);
+		}
+		// set before anything allocates, allocations from here on are counted in the new block
+		localBlock = block;
+
+		Registry &registry = Registry::get();
+		{
+			std::lock_guard lock(registry.mutex);
+			registry.blocks.push_back(block);
+		}
+		static thread_local Detacher detacher;
+		return block;
+	}
+
+	Metric::Metric(const std::string &name, const std::string &help, const Labels &labels, Type type, size_t slots)
+	 : name(name), help(help), labels(labels), type(type), slot(0), slots(slots), base(slots), older(slots), newer(slots) {
+		Registry &registry = Registry::get();
+		if(!detail::localBlock) {
+			detail::attach();
+		}
+		std::lock_guard lock(registry.mutex);
+		slot = slots ? registry.reserve(slots) : 0;
+		base = registry.sum(*this);
+		olderTime = newerTime = now();
+		registry.metrics.push_back(this);
+	}
+
+	Metric::Metric(const std::string &name, const std::string &help, Type type, size_t slot)
+	 : name(name), help(help), type(type), slot(slot), slots(1), base(1), older(1), newer(1) {
+		Registry &registry = Registry::get();
+		if(!detail::localBlock) {
+			detail::attach();
+		}
+		std::lock_guard lock(registry.mutex);
+		olderTime = newerTime = now();
+		registry.metrics.push_back(this);
+	}
+
+	Metric::~Metric() {
+		Registry &registry = Registry::get();
+		std::lock_guard lock(registry.mutex);
+		std::erase(registry.metrics, this);
+		if(slots) {
+			registry.release(slot, slots);
+		}
+	}
+
+	const std::string& Metric::getName() const {
+		return name;
+	}
+
+	Counter::Counter(const std::string &name, const std::string &help, const Labels &labels) : Metric(name, help, labels, CounterType, 1) {}
+
+	Counter::Counter(const std::string &name, const std::string &help, size_t slot) : Metric(name, help, CounterType, slot) {}
+
+	uint64_t Counter::value() const {
+		Registry &registry = Registry::get();
+		std::lock_guard lock(registry.mutex);
+		return registry.sum(*this)[0];
+	}
+
+	Gauge::Gauge(const std::string &name, const std::string &help, const Labels &labels) : Metric(name, help, labels, GaugeType, 0) {}
+
+	Histogram::Histogram(const std::string &name, const std::string &help, const std::vector<double> &bounds, const Labels &labels)
+	 : Metric(name, help, labels, HistogramType, bounds.size() + 2), bounds(bounds) {}
+
+	void Histogram::observe(double value) {
+		std::atomic<uint64_t> *block = detail::block();
+		std::atomic<uint64_t> &bucket = block[slot + (std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin())];
+		bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		// the last slot holds the sum as the bits of a double
+		std::atomic<uint64_t> &sum = block[slot + slots - 1];
+		sum.store(std::bit_cast<uint64_t>(std::bit_cast<double>(sum.load(std::memory_order_relaxed)) + value), std::memory_order_relaxed);
+	}
+
+	std::vector<double> Histogram::exponential(double start, double factor, size_t count) {
+		std::vector<double> bounds(count);
+		for(size_t i = 0; i < count; i++) {
+			bounds[i] = start * std::pow(factor, i);
+		}
+		return bounds;
+	}
+
+	Registry& Registry::get() {
+		// never destroyed, threads and metrics that outlive main still find it
+		static Registry *registry = new Registry();
+		return *registry;
+	}
+
+	Registry::Registry() : retired(detail::maxSlots), freeSlots({{detail::allocationSlot + 1, detail::maxSlots - 1}}) {}
+
+	size_t Registry::reserve(size_t count) {
+		for(auto &[first, free] : freeSlots) {
+			if(free >= count) {
+				size_t slot = first;
+				first += count;
+				free -= count;
+				std::erase_if(freeSlots, [](const auto &range) {
+					return range.second == 0;
+				});
+				return slot;
+			}
+		}
+		throw std::runtime_error("metrics: out of slots, raise detail::maxSlots");
+	}
+
+	void Registry::release(size_t slot, size_t count) {
+		// the slots keep their values, the next metric in them subtracts those as its base
+		freeSlots.push_back({slot, count});
+		std::sort(freeSlots.begin(), freeSlots.end());
+		for(size_t i = 1; i < freeSlots.size();) {
+			if(freeSlots[i - 1].first + freeSlots[i - 1].second == freeSlots[i].first) {
+				freeSlots[i - 1].second += freeSlots[i].second;
+				freeSlots.erase(freeSlots.begin() + i);
+			}
+			else {
+				i++;
+			}
+		}
+	}
+
+	std::vector<uint64_t> Registry::sum(const Metric &metric) const {
+		std::vector<uint64_t> result(retired.begin() + metric.slot, retired.begin() + metric.slot + metric.slots);
+		for(std::atomic<uint64_t> *block : blocks) {
+			for(size_t i = 0; i < metric.slots; i++) {
+				result[i] += block[metric.slot + i].load(std::memory_order_relaxed);
+			}
+		}
+		if(metric.type == Metric::HistogramType) {
+			double total = std::bit_cast<double>(retired[metric.slot + metric.slots - 1]);
+			for(std::atomic<uint64_t> *block : blocks) {
+				total += std::bit_cast<double>(block[metric.slot + metric.slots - 1].load(std::memory_order_relaxed));
+			}
+			result.back() = std::bit_cast<uint64_t>(total - std::bit_cast<double>(metric.base.back()));
+		}
+		for(size_t i = 0; i < metric.slots - (metric.type == Metric::HistogramType); i++) {
+			result[i] -= metric.base[i];
+		}
+		return result;
+	}
+
+	void Registry::window(Metric &metric, double time) {
+		if(time - metric.newerTime >= windowLength) {
+			metric.older = std::move(metric.newer);
+			metric.olderTime = metric.newerTime;
+			metric.newer = sum(metric);
+			metric.newerTime = time;
+		}
+	}
+
+	static std::string escape(const std::string &value, bool json) {
+		std::string result;
+		for(char c : value) {
+			switch(c) {
+				case '\\': result += "\\\\"; break;
+				case '"': result += "\\\""; break;
+				case '\n': result += "\\n"; break;
+				default: {
+					if(json && uint8_t(c) < 0x20) {
+						result += fmt::format("\\u{:04x}", int(c));
+					}
+					else {
+						result += c;
+					}
+				} break;
+			}
+		}
+		return result;
+	}
+
+	static std::string labelSet(const Labels &labels, const std::string &le = "") {
+		if(labels.empty() && le.empty()) {
+			return "";
+		}
+		std::string result = "{";
+		for(auto &[name, value] : labels) {
+			result += (result.size() > 1 ? "," : "") + name + "=\"" + escape(value, false) + "\"";
+		}
+		if(!le.empty()) {
+			result += (result.size() > 1 ? ",le=\"" : "le=\"") + le + "\"";
+		}
+		return result + "}";
+	}
+
+	static std::vector<Metric*> sorted(std::vector<Metric*> metrics) {
+		std::stable_sort(metrics.begin(), metrics.end(), [](const Metric *a, const Metric *b) {
+			return a->getName() < b->getName();
+		});
+		return metrics;
+	}
+
+	std::string Registry::prometheus() {
+	#if defined(METRICS_ALLOCATIONS)
+		allocations();
+	#endif
+		std::lock_guard lock(mutex);
+		std::string out;
+		std::string last;
+		for(Metric *metric : sorted(metrics)) {
+			static const char *types[] = {"counter", "gauge", "histogram"};
+			if(metric->name != last) {
+				out += fmt::format("# HELP {} {}\n# TYPE {} {}\n", metric->name, metric->help, metric->name, types[metric->type]);
+				last = metric->name;
+			}
+			switch(metric->type) {
+				case Metric::CounterType: {
+					out += fmt::format("{}{} {}\n", metric->name, labelSet(metric->labels), sum(*metric)[0]);
+				} break;
+				case Metric::GaugeType: {
+					out += fmt::format("{}{} {}\n", metric->name, labelSet(metric->labels), static_cast<Gauge*>(metric)->value());
+				} break;
+				case Metric::HistogramType: {
+					const std::vector<double> &bounds = static_cast<Histogram*>(metric)->bounds;
+					std::vector<uint64_t> values = sum(*metric);
+					uint64_t count = 0;
+					for(size_t i = 0; i <= bounds.size(); i++) {
+						count += values[i];
+						out += fmt::format("{}_bucket{} {}\n", metric->name, labelSet(metric->labels, i < bounds.size() ? fmt::format("{}", bounds[i]) : "+Inf"), count);
+					}
+					out += fmt::format("{}_sum{} {}\n", metric->name, labelSet(metric->labels), std::bit_cast<double>(values.back()));
+					out += fmt::format("{}_count{} {}\n", metric->name, labelSet(metric->labels), count);
+				} break;
+			}
+		}
+		return out;
+	}
+
+	// linear within the bucket the quantile falls into, the upper bound if it is the overflow bucket
+	static double quantile(const std::vector<double> &bounds, const std::vector<uint64_t> &buckets, double q) {
+		uint64_t total = 0;
+		for(size_t i = 0; i <= bounds.size(); i++) {
+			total += buckets[i];
+		}
+		if(total == 0) {
+			return 0.0;
+		}
+		double rank = q * total, below = 0.0;
+		for(size_t i = 0; i < bounds.size(); i++) {
+			if(below + buckets[i] >= rank && buckets[i] > 0) {
+				double lower = i > 0 ? bounds[i - 1] : std::min(0.0, bounds[0]);
+				return lower + (bounds[i] - lower) * (rank - below) / buckets[i];
+			}
+			below += buckets[i];
+		}
+		return bounds.empty() ? 0.0 : bounds.back();
+	}
+
+	std::string Registry::json() {
+	#if defined(METRICS_ALLOCATIONS)
+		allocations();
+	#endif
+		std::lock_guard lock(mutex);
+		double time = now();
+		std::string out = "{";
+		std::string last;
+		for(Metric *metric : sorted(metrics)) {
+			window(*metric, time);
+			if(metric->name != last) {
+				out += fmt::format("{}\"{}\":[", last.empty() ? "" : "],", escape(metric->name, true));
+				last = metric->name;
+			}
+			else {
+				out += ",";
+			}
+
+			out += "{\"labels\":{";
+			for(size_t i = 0; i < metric->labels.size(); i++) {
+				out += fmt::format("{}\"{}\":\"{}\"", i ? "," : "", escape(metric->labels[i].first, true), escape(metric->labels[i].second, true));
+			}
+			out += "}";
+
+			std::vector<uint64_t> values = metric->slots ? sum(*metric) : std::vector<uint64_t>();
+			double elapsed = std::max(time - metric->olderTime, 1e-9);
+			switch(metric->type) {
+				case Metric::CounterType: {
+					out += fmt::format(",\"value\":{},\"rate\":{}", values[0], (values[0] - metric->older[0]) / elapsed);
+				} break;
+				case Metric::GaugeType: {
+					out += fmt::format(",\"value\":{}", static_cast<Gauge*>(metric)->value());
+				} break;
+				case Metric::HistogramType: {
+					const std::vector<double> &bounds = static_cast<Histogram*>(metric)->bounds;
+					std::vector<uint64_t> recent(bounds.size() + 1);
+					uint64_t count = 0, recentCount = 0;
+					for(size_t i = 0; i <= bounds.size(); i++) {
+						recent[i] = values[i] - metric->older[i];
+						count += values[i];
+						recentCount += recent[i];
+					}
+					out += fmt::format(",\"count\":{},\"sum\":{},\"rate\":{}", count, std::bit_cast<double>(values.back()), recentCount / elapsed);
+					for(auto [name, q] : {std::pair("p50", 0.5), std::pair("p90", 0.9), std::pair("p99", 0.99), std::pair("p999", 0.999)}) {
+						out += fmt::format(",\"{}\":{}", name, quantile(bounds, recent, q));
+					}
+				} break;
+			}
+			out += "}";
+		}
+		return out + (last.empty() ? "}" : "]}");
+	}
+
+	Counter& allocations() {
+		static Counter *counter = new Counter("photon_allocations_total", "heap allocations of all threads", detail::allocationSlot);
+		return *counter;
+	}
+}
+
+#if defined(METRICS_ALLOCATIONS)
+static void* allocate(size_t size, size_t alignment) {
+	metrics::detail::add(metrics::detail::allocationSlot, 1);
+	size = std::max<size_t>(size, 1);
+	while(true) {
+		void *memory = alignment > alignof(std::max_align_t) ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment) : std::malloc(size);
+		if(memory) {
+			return memory;
+		}
+		std::new_handler handler = std::get_new_handler();
+		if(!handler) {
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+}
+
+void* operator new(size_t size) {
+	return allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+	return allocate(size, size_t(alignment));
+}
+
+void operator delete(void *memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void *memory, size_t, std::align_val_t) noexcept {
+	std::free(memory);
+}
+#endif
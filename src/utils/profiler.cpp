@@ -0,0 +1,246 @@
+#include <utils/profiler.hpp>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+namespace photon::profiler {
+	static constexpr size_t capacity = 1 << 18;	// events per thread and capture, later ones are dropped
+	static constexpr size_t maxTotals = 64;	// scope names, further ones aren't summed
+
+	struct Event {
+		const char *name;	// nullptr -> frame marker
+		int64_t begin, end;
+	};
+
+	// only the owning thread writes, state is the capture in the upper and the event count in the lower half
+	struct Buffer {
+		std::vector<Event> events = std::vector<Event>(capacity);
+		std::atomic<uint64_t> state = 0;
+		bool owned = true;
+		unsigned id;
+		const char *name = nullptr;	// tracks, threads are numbered
+	};
+
+	// open addressing by the name pointer, names are never removed
+	struct Total {
+		std::atomic<const char*> name = nullptr;
+		std::atomic<int64_t> time = 0;
+		std::atomic<uint64_t> count = 0;
+	};
+
+	// keeps the buffers of exited threads for the export, new threads take them over
+	struct Owner {
+		Buffer *buffer = nullptr;
+
+		~Owner();
+	};
+
+	std::atomic<bool> detail::capturing = false, detail::active = false;
+
+	static std::mutex mutex;
+	static std::vector<std::unique_ptr<Buffer>> buffers;
+	static std::atomic<uint32_t> capture = 0;
+	static std::atomic<size_t> dropped = 0;
+	static int64_t captureStart = 0;
+	static thread_local Owner owner;
+	static std::atomic<bool> summing = false;
+	static std::array<Total, maxTotals> sums;
+
+	Owner::~Owner() {
+		if(buffer) {
+			std::lock_guard lock(mutex);
+			buffer->owned = false;
+		}
+	}
+
+	static Buffer& attach() {
+		std::lock_guard lock(mutex);
+		auto it = std::find_if(buffers.begin(), buffers.end(), [](const auto &buffer) {
+			return !buffer->owned;
+		});
+		if(it != buffers.end()) {
+			(*it)->owned = true;
+			owner.buffer = it->get();
+		}
+		else {
+			buffers.push_back(std::make_unique<Buffer>());
+			buffers.back()->id = buffers.size();
+			owner.buffer = buffers.back().get();
+		}
+		return *owner.buffer;
+	}
+
+	static void append(Buffer &buffer, const char *name, int64_t begin, int64_t end) {
+		uint64_t current = capture.load(std::memory_order_relaxed);
+		uint64_t state = buffer.state.load(std::memory_order_relaxed);
+		if(state >> 32 != current) {
+			state = current << 32;
+		}
+		size_t count = state & 0xffffffff;
+		if(count >= capacity) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		buffer.events[count] = {name, begin, end};
+		buffer.state.store(state + 1, std::memory_order_release);
+	}
+
+	static void sum(const char *name, int64_t time) {
+		size_t start = (reinterpret_cast<uintptr_t>(name) >> 3) % maxTotals;
+		for(size_t i = 0; i < maxTotals; i++) {
+			Total &total = sums[(start + i) % maxTotals];
+			const char *current = total.name.load(std::memory_order_acquire);
+			if(!current && total.name.compare_exchange_strong(current, name, std::memory_order_acq_rel)) {
+				current = name;
+			}
+			if(current == name) {
+				total.time.fetch_add(time, std::memory_order_relaxed);
+				total.count.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+		}
+	}
+
+	void detail::record(const char *name, int64_t begin, int64_t end) {
+		if(name && summing.load(std::memory_order_relaxed)) {
+			sum(name, end - begin);
+		}
+		if(profiler::capturing()) {
+			append(owner.buffer ? *owner.buffer : attach(), name, begin, end);
+		}
+	}
+
+	void enableTotals(bool enabled) {
+		std::lock_guard lock(mutex);
+		summing = enabled;
+		detail::active = enabled || capturing();
+	}
+
+	size_t totals(std::span<total> out) {
+		size_t count = 0;
+		for(const Total &total : sums) {
+			const char *name = total.name.load(std::memory_order_acquire);
+			if(!name) {
+				continue;
+			}
+			if(count < out.size()) {
+				out[count] = {name, total.time.load(std::memory_order_relaxed), total.count.load(std::memory_order_relaxed)};
+			}
+			count++;
+		}
+		return count;
+	}
+
+	track::track(const char *name) {
+		std::lock_guard lock(mutex);
+		buffers.push_back(std::make_unique<Buffer>());
+		buffer = buffers.back().get();
+		buffer->id = buffers.size();
+		buffer->name = name;
+	}
+
+	track::~track() {
+		std::lock_guard lock(mutex);
+		buffer->owned = false;
+		buffer->name = nullptr;
+	}
+
+	void track::record(const char *name, int64_t begin, int64_t end) {
+		append(*buffer, name, begin, end);
+	}
+
+	void start() {
+		std::lock_guard lock(mutex);
+		if(capturing()) {
+			return;
+		}
+		capture.fetch_add(1, std::memory_order_relaxed);
+		dropped = 0;
+		captureStart = now();
+		detail::capturing.store(true, std::memory_order_relaxed);
+		detail::active = true;
+		spdlog::info("profiler: capturing");
+	}
+
+	static std::string escape(const char *name) {
+		std::string result;
+		for(; *name; name++) {
+			if(*name == '"' || *name == '\\') {
+				result += '\\';
+			}
+			result += *name;
+		}
+		return result;
+	}
+
+	bool stop(const std::string &path) {
+		std::lock_guard lock(mutex);
+		if(!detail::capturing.exchange(false)) {
+			return false;
+		}
+		detail::active = summing.load();
+		uint64_t current = capture.load(std::memory_order_relaxed);
+		int64_t captureEnd = now();
+
+		std::ofstream file(path);
+		if(!file) {
+			spdlog::error("profiler: can't write {}", path);
+			return false;
+		}
+
+		// timestamps are microseconds since the start of the capture
+		auto micros = [&](int64_t time) {
+			return fmt::format("{:.3f}", (time - captureStart) / 1e3);
+		};
+
+		size_t written = 0;
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"photon\"}}";
+		for(const auto &buffer : buffers) {
+			uint64_t state = buffer->state.load(std::memory_order_acquire);
+			if(state >> 32 != current) {
+				continue;
+			}
+			std::string name = buffer->name ? escape(buffer->name) : fmt::format("thread {}", buffer->id);
+			file << fmt::format(",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}", buffer->id, name);
+			size_t count = state & 0xffffffff;
+			for(size_t i = 0; i < count; i++) {
+				const Event &event = buffer->events[i];
+				// scopes that were still open when a capture before this one stopped
+				if(event.begin < captureStart || event.end > captureEnd) {
+					continue;
+				}
+				if(event.name) {
+					file << fmt::format(",\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{},\"dur\":{:.3f}}}",
+						escape(event.name), buffer->id, micros(event.begin), (event.end - event.begin) / 1e3);
+				}
+				else {
+					file << fmt::format(",\n{{\"name\":\"frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":{},\"ts\":{}}}", buffer->id, micros(event.begin));
+				}
+				written++;
+			}
+		}
+		file << "\n]}\n";
+
+		if(dropped) {
+			spdlog::warn("profiler: {} events didn't fit into the buffers and were dropped", dropped.load());
+		}
+		spdlog::info("profiler: wrote {} events over {:.2f} s to {}", written, (captureEnd - captureStart) / 1e9, path);
+		return bool(file);
+	}
+
+	void toggle(const std::string &path) {
+		if(capturing()) {
+			stop(path);
+		}
+		else {
+			start();
+		}
+	}
+}
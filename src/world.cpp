@@ -1,7 +1,6 @@
 #include <world.hpp>
 
 #include <algorithm>
-#include <fstream>
 
 void WorldContainer::setChunk(lvec2 pos, const std::shared_ptr<Chunk> &chunk) {
 	m_chunks[pos + m_offset] = chunk;
@@ -59,7 +58,8 @@ Tile& WorldContainer::at(lvec2 tileoffset) {
 Tile WorldContainer::at(lvec2 tileoffset) const {
 	ivec2 chunkpos = tileoffset / ivec2(Chunk::size) - ivec2(tileoffset.x < 0, tileoffset.y < 0);
 	ivec2 tilepos = (tileoffset - chunkpos * Chunk::size) % Chunk::size;
-	auto chunk = getChunk(chunkpos);
+	// the non-const accessors of Chunk count as edits
+	std::shared_ptr<const Chunk> chunk = getChunk(chunkpos);
 	if(chunk) {
 		return chunk->at(tilepos);
 	}
@@ -97,7 +97,7 @@ Image WorldContainer::renderTileProperties() const {
 	Image result(ivec2(Chunk::size * 5), 1);
 	for(int cy = -2; cy <= 2; cy++) {
 		for(int cx = -2; cx <= 2; cx++) {
-			auto chunk = getChunk(lvec2(cx, cy));
+			std::shared_ptr<const Chunk> chunk = getChunk(lvec2(cx, cy));
 			if(chunk) {
 				for(int y = 0; y < Chunk::size; y++) {
 					for(int x = 0; x < Chunk::size; x++) {
@@ -146,87 +146,17 @@ std::shared_ptr<Chunk> WorldGenerator::getChunk(lvec2 pos) {
 	return chunk;
 }
 
-WorldRenderer::WorldRenderer(const WorldContainer &container, const Camera &cam, const std::shared_ptr<Entity> &mainEntity, const std::shared_ptr<TiledTexture> &texture)
- : container(container), cam(cam), mainEntity(mainEntity), texture(texture) {
-	std::ifstream src("assets/platformer.glsl", std::ios::ate);
-	std::string buffer(src.tellg(), '\0');
-	src.seekg(src.beg);
-	src.read(buffer.data(), buffer.size());
-
-	shader = opengl::Program::load(buffer, opengl::Shader::VertexStage | opengl::Shader::FragmentStage);
-	shader.use();
-	shader.setUniform("sampler", 0);
-
-	// init ubos
-	cameraInfoUBO.bindBase(0);
-	cameraInfoUBO.setData({mat4(), mat4()});
-	modelInfoUBO.bindBase(1);
-	modelInfoUBO.setData({mat4(), mat4()});
-	renderInfoUBO.bindBase(2);
-	renderInfoUBO.setData({vec4(0), cam.res, 0.0f, 0.0f});
-
-	// init meshes
-	unitplane = opengl::Mesh<vec3, vec2>({
-		{ math::vec3( 0.5f, 0.5f, 0.0f), math::vec2(1,0) },
-		{ math::vec3(-0.5f, 0.5f, 0.0f), math::vec2(0,0) },
-		{ math::vec3( 0.5f,-0.5f, 0.0f), math::vec2(1,1) },
-		{ math::vec3(-0.5f,-0.5f, 0.0f), math::vec2(0,1) },
-	});
-}
-
-void WorldRenderer::render() {
-	shader.use();
-
-	cameraInfoUBO.bindBase(0);
-	modelInfoUBO.bindBase(1);
-	renderInfoUBO.bindBase(2);
-
-	cameraMutex.lock();
-
-	mat4 proj = cam.proj();
-	mat4 view = cam.view();
-	vec2 res = cam.res;
-	vec3 campos = cam.pos;
-
-	cameraInfoUBO.update({proj, view});
-	renderInfoUBO.update({vec4(0), res, 0.0f, 0.0f});
-
-	mat4 transform = mainEntity->getTransform();
-	modelInfoUBO.update({transform, mainEntity->getUVTransform()});
-	mainEntity->getTexturePtr()->activate();
-	unitplane.drawElements(GL_TRIANGLE_STRIP);
-
-	cameraMutex.unlock();
-
-	texture->activate();
-	for(auto &[chunkid, chunk] : container.chunks()) {
-		lvec2 chunkoffset = chunkid - container.offset();
-		vec2 chunkpos = chunkoffset * Chunk::size * Tile::resolution;
-		vec2 chunkcenter = (vec2(chunkoffset) + 0.5f) * Chunk::size * Tile::resolution;
-
-		if(dist(campos.xy, chunkcenter) < Chunk::size * Tile::resolution * 1.5) {
-			modelInfoUBO.update({mat4().translate(vec3(chunkpos)), mat4()});
-			chunk->render();
-		}
-	}
-
-	for(auto &entity : container.entities()) {
-		mat4 transform = entity->getTransform();
-		vec2 pos = transform * vec4(0.0f, 0.0f, 0.0f, 1.0f);
-		if(dist(campos.xy, pos) < Chunk::size * Tile::resolution * 2) {
-			modelInfoUBO.update({transform, entity->getUVTransform()});
-			entity->getTexturePtr()->activate();
-			unitplane.drawElements(GL_TRIANGLE_STRIP);
-		}
-	}
-}
-
-mat4 WorldRenderer::getCamTransform() {
-	std::lock_guard<std::mutex> lock(cameraMutex);
-	mat4 transform = cam.proj() * cam.view();
-	return transform;
-}
-
-std::mutex& WorldRenderer::getCameraMutex() {
-	return cameraMutex;
+WorldMetrics& worldMetrics() {
+	static WorldMetrics instance = {
+		metrics::Histogram("photon_world_tick_seconds", "time of a simulation tick", metrics::Histogram::exponential(0.0001, 2.0, 14)),
+#if defined(METRICS_ALLOCATIONS)
+		metrics::Histogram("photon_world_tick_allocations", "heap allocations during a simulation tick", metrics::Histogram::exponential(1.0, 4.0, 10)),
+#endif
+		metrics::Gauge("photon_world_chunks", "chunks loaded"),
+		metrics::Gauge("photon_world_chunk_load_queue", "chunks the last tick had to generate or load"),
+		metrics::Gauge("photon_world_entities", "entities in the world"),
+		metrics::Gauge("photon_world_particles", "live particles"),
+		metrics::Counter("photon_world_chunks_loaded_total", "chunks generated or loaded from storage"),
+	};
+	return instance;
 }
\ No newline at end of file
@@ -0,0 +1,361 @@
+#include <worlddb.hpp>
+
+#include <cstring>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+#include <stb/stb_image.h>
+
+// implemented in stb_image_write, but not part of its public interface
+extern "C" unsigned char* stbi_zlib_compress(unsigned char *data, int data_len, int *out_len, int quality);
+
+static constexpr uint32_t regionMagic = 0x47524850;	// "PHRG"
+static constexpr uint32_t regionVersion = 1;
+static constexpr size_t recordAlignment = 64;
+
+RegionFile::RegionFile(const std::string &path) : path(path) {
+	open();
+}
+
+RegionFile::~RegionFile() {
+	close();
+}
+
+void RegionFile::open() {
+	fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+	if(fd < 0) {
+		throw std::runtime_error("error: couldn't open region file '" + path + "'");
+	}
+
+	struct stat info;
+	fstat(fd, &info);
+
+	uint32_t magic[4] = {};
+	if(size_t(info.st_size) < headerSize || pread(fd, magic, sizeof(magic), 0) != sizeof(magic) || magic[0] != regionMagic) {
+		std::vector<uint8_t> header(headerSize, 0);
+		uint32_t tmp[4] = {regionMagic, regionVersion, 0, 0};
+		memcpy(header.data(), tmp, sizeof(tmp));
+		if(pwrite(fd, header.data(), header.size(), 0) != ssize_t(header.size())) {
+			spdlog::error("couldn't initialize region file '{}'", path);
+		}
+		entries = {};
+	}
+	else {
+		pread(fd, entries.data(), sizeof(entries), sizeof(magic));
+	}
+
+	// the last record doesn't have to fill its capacity, so the file size isn't where the next one goes
+	end = headerSize;
+	size_t used = 0;
+	for(const Entry &entry : entries) {
+		if(entry.offset != 0) {
+			end = std::max<size_t>(end, entry.offset + entry.capacity);
+			used += entry.capacity;
+		}
+	}
+	dead = end - headerSize - std::min(used, end - headerSize);
+}
+
+void RegionFile::close() {
+	if(mapping) {
+		munmap(const_cast<uint8_t*>(mapping), mappedSize);
+		mapping = nullptr;
+		mappedSize = 0;
+	}
+	if(fd >= 0) {
+		::close(fd);
+		fd = -1;
+	}
+}
+
+bool RegionFile::map(size_t size) {
+	if(size <= mappedSize) {
+		return true;
+	}
+	if(mapping) {
+		munmap(const_cast<uint8_t*>(mapping), mappedSize);
+		mapping = nullptr, mappedSize = 0;
+	}
+	void *ptr = mmap(nullptr, end, PROT_READ, MAP_SHARED, fd, 0);
+	if(ptr == MAP_FAILED) {
+		spdlog::error("couldn't map region file '{}'", path);
+		return false;
+	}
+	mapping = static_cast<const uint8_t*>(ptr);
+	mappedSize = end;
+	return size <= mappedSize;
+}
+
+void RegionFile::writeEntry(unsigned index) {
+	if(pwrite(fd, &entries[index], sizeof(Entry), 16 + index * sizeof(Entry)) != sizeof(Entry)) {
+		spdlog::error("couldn't update header of region file '{}'", path);
+	}
+}
+
+void RegionFile::write(unsigned index, std::span<const uint8_t> data) {
+	std::lock_guard<std::mutex> lock(mutex);
+	Entry &entry = entries[index];
+
+	if(entry.offset == 0 || entry.capacity < data.size()) {
+		dead += entry.capacity;
+		entry.offset = end;
+		entry.capacity = (data.size() + recordAlignment - 1) / recordAlignment * recordAlignment;
+		end += entry.capacity;
+		if(ftruncate(fd, end) != 0) {
+			spdlog::error("couldn't grow region file '{}'", path);
+		}
+	}
+	entry.size = data.size();
+
+	// payload first, so that a crash in between leaves the old record intact
+	if(pwrite(fd, data.data(), data.size(), entry.offset) != ssize_t(data.size())) {
+		spdlog::error("couldn't write record to region file '{}'", path);
+	}
+	writeEntry(index);
+}
+
+void RegionFile::erase(unsigned index) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if(entries[index].offset != 0) {
+		dead += entries[index].capacity;
+		entries[index] = {};
+		writeEntry(index);
+	}
+}
+
+void RegionFile::compact() {
+	std::lock_guard<std::mutex> lock(mutex);
+	if(dead < compactThreshold || dead * 2 < end - headerSize || !map(end)) {
+		return;
+	}
+
+	std::string tmpPath = path + ".tmp";
+	int tmp = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if(tmp < 0) {
+		spdlog::error("couldn't create '{}' for compaction", tmpPath);
+		return;
+	}
+
+	std::vector<uint8_t> header(headerSize, 0);
+	std::array<Entry, size * size> compacted = entries;
+	size_t offset = headerSize;
+	for(Entry &entry : compacted) {
+		if(entry.offset != 0) {
+			pwrite(tmp, mapping + entry.offset, entry.size, offset);
+			entry.offset = offset;
+			entry.capacity = (entry.size + recordAlignment - 1) / recordAlignment * recordAlignment;
+			offset += entry.capacity;
+		}
+	}
+	uint32_t magic[4] = {regionMagic, regionVersion, 0, 0};
+	memcpy(header.data(), magic, sizeof(magic));
+	memcpy(header.data() + sizeof(magic), compacted.data(), sizeof(compacted));
+	pwrite(tmp, header.data(), header.size(), 0);
+	if(ftruncate(tmp, offset) != 0) {
+		spdlog::error("couldn't resize '{}' for compaction", tmpPath);
+	}
+	fsync(tmp);
+	::close(tmp);
+
+	close();
+	std::filesystem::rename(tmpPath, path);
+	open();
+}
+
+size_t RegionFile::fileSize() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return end;
+}
+
+size_t RegionFile::deadSize() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return dead;
+}
+
+lvec2 RegionFile::region(lvec2 pos) {
+	return lvec2(pos.x >> shift, pos.y >> shift);
+}
+
+unsigned RegionFile::index(lvec2 pos) {
+	return unsigned((pos.y & (size - 1)) * size + (pos.x & (size - 1)));
+}
+
+WorldDB::WorldDB(const std::string &path) : path(path) {
+	std::filesystem::create_directories(path);
+	worker = std::thread([this](){
+		run();
+	});
+}
+
+WorldDB::~WorldDB() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	cv.notify_all();
+	worker.join();
+}
+
+bool WorldDB::read(lvec2 pos, std::vector<uint8_t> &data) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = pending.find(pos);
+		if(it != pending.end()) {
+			if(!it->second) {
+				return false;
+			}
+			data = *it->second;
+			return true;
+		}
+	}
+
+	RegionFile *file = region(pos, false);
+	return file && file->read(RegionFile::index(pos), [&](std::span<const uint8_t> record) -> bool {
+		uint32_t rawSize;
+		if(record.size() < sizeof(rawSize)) {
+			return false;
+		}
+		memcpy(&rawSize, record.data(), sizeof(rawSize));
+		data.resize(rawSize);
+
+		const char *src = reinterpret_cast<const char*>(record.data() + sizeof(rawSize));
+		int len = stbi_zlib_decode_buffer(reinterpret_cast<char*>(data.data()), data.size(), src, record.size() - sizeof(rawSize));
+		if(len != int(rawSize)) {
+			spdlog::error("corrupted record for chunk ({}, {}) in '{}'", pos.x, pos.y, path);
+			return false;
+		}
+		return true;
+	});
+}
+
+void WorldDB::write(lvec2 pos, std::vector<uint8_t> &&data) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending[pos] = std::make_shared<const std::vector<uint8_t>>(std::move(data));
+		queue.push_back(pos);
+	}
+	cv.notify_one();
+}
+
+void WorldDB::erase(lvec2 pos) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending[pos] = nullptr;
+		queue.push_back(pos);
+	}
+	cv.notify_one();
+}
+
+bool WorldDB::load(Chunk &chunk) {
+	std::vector<uint8_t> data;
+	ChunkDelta delta;
+	if(!read(chunk.getPos(), data)) {
+		return false;
+	}
+	if(!ChunkDelta::deserialize(data, delta)) {
+		spdlog::error("invalid delta for chunk ({}, {}) in '{}'", chunk.getPos().x, chunk.getPos().y, path);
+		return false;
+	}
+	delta.apply(chunk);
+	chunk.setModified(false);
+	return true;
+}
+
+void WorldDB::save(Chunk &chunk, const Chunk &baseline) {
+	ChunkDelta delta(baseline, chunk);
+	if(delta.empty()) {
+		erase(chunk.getPos());
+	}
+	else {
+		write(chunk.getPos(), delta.serialize());
+	}
+	chunk.setModified(false);
+}
+
+void WorldDB::sync() {
+	std::unique_lock<std::mutex> lock(mutex);
+	idle.wait(lock, [this](){
+		return pending.empty();
+	});
+}
+
+size_t WorldDB::pendingWrites() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return pending.size();
+}
+
+void WorldDB::run() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while(true) {
+		cv.wait(lock, [this](){
+			return quit || !queue.empty();
+		});
+		if(queue.empty()) {
+			break;
+		}
+
+		lvec2 pos = queue.front();
+		queue.pop_front();
+		auto it = pending.find(pos);
+		if(it == pending.end()) {
+			continue;	// already stored by an earlier queue entry
+		}
+		Payload data = it->second;
+
+		lock.unlock();
+		store(pos, data);
+		lock.lock();
+
+		// a newer version might have been queued while storing this one
+		it = pending.find(pos);
+		if(it != pending.end() && it->second == data) {
+			pending.erase(it);
+		}
+		if(pending.empty()) {
+			idle.notify_all();
+		}
+	}
+}
+
+void WorldDB::store(lvec2 pos, const Payload &data) {
+	// a chunk that was never stored has nothing to erase, and gets no region file for it
+	RegionFile *file = region(pos, bool(data));
+	if(!file) {
+		return;
+	}
+	unsigned index = RegionFile::index(pos);
+
+	if(!data) {
+		file->erase(index);
+	}
+	else {
+		int len = 0;
+		unsigned char *compressed = stbi_zlib_compress(const_cast<unsigned char*>(data->data()), data->size(), &len, compressionLevel);
+		std::vector<uint8_t> record(sizeof(uint32_t) + len);
+		uint32_t rawSize = data->size();
+		memcpy(record.data(), &rawSize, sizeof(rawSize));
+		memcpy(record.data() + sizeof(rawSize), compressed, len);
+		free(compressed);
+		file->write(index, record);
+	}
+	file->compact();
+}
+
+RegionFile* WorldDB::region(lvec2 pos, bool create) {
+	lvec2 regionPos = RegionFile::region(pos);
+	std::lock_guard<std::mutex> lock(regionMutex);
+	auto it = regions.find(regionPos);
+	if(it == regions.end()) {
+		std::string filePath = path + "/r." + std::to_string(regionPos.x) + "." + std::to_string(regionPos.y) + ".dat";
+		if(!create && !std::filesystem::exists(filePath)) {
+			return nullptr;
+		}
+		it = regions.emplace(regionPos, std::unique_ptr<RegionFile>(new RegionFile(filePath))).first;
+	}
+	return it->second.get();
+}
@@ -0,0 +1,202 @@
+#include <worldrenderer.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+#include <utils/metrics.hpp>
+
+static metrics::Counter& meshRebuilds() {
+	static metrics::Counter counter("photon_mesh_rebuilds_total", "chunk meshes rebuilt");
+	return counter;
+}
+
+// chunks are built a bit beyond where they are drawn, so they are ready when the camera gets there
+static constexpr float drawDistance = Chunk::size * Tile::resolution * 1.5f, buildDistance = Chunk::size * Tile::resolution * 2.0f;
+
+static vec2 chunkCenter(lvec2 chunkoffset) {
+	return (vec2(chunkoffset) + 0.5f) * Chunk::size * Tile::resolution;
+}
+
+void ChunkMesh::build(const std::shared_ptr<const Chunk> &chunk, std::mutex &mutex) {
+	if(built.lock() == chunk && revision == chunk->getRevision()) {
+		return;
+	}
+	revision = chunk->getRevision();
+	built = chunk;
+	building.build(*chunk);
+	meshRebuilds().add();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	std::swap(building, ready);
+	sync = true;
+}
+
+void ChunkMesh::render() {
+	if(!mesh) {
+		mesh = std::unique_ptr<Mesh>(new Mesh());
+	}
+	if(sync) {
+		mesh->setVertexData(ready.getVertices());
+		mesh->setIndexData(ready.getIndices());
+		sync = false;
+	}
+	mesh->drawElements();
+}
+
+ParticleRenderer::ParticleRenderer(std::shared_ptr<TiledTexture> texture) : texture(texture), buffer(opengl::Buffer<Particle>::Array) {
+	std::ifstream src("assets/particles.glsl", std::ios::ate);
+	std::string buffer(src.tellg(), '\0');
+	src.seekg(src.beg);
+	src.read(buffer.data(), buffer.size());
+	prog = opengl::Program::load(buffer, opengl::Shader::VertexStage | opengl::Shader::GeometryStage | opengl::Shader::FragmentStage);
+
+	this->buffer.initEmpty(opengl::Buffer<Particle>::DynamicDraw, 0);
+	transformUBO.bindBase(0);
+	transformUBO.setData(mat4());
+
+	vao.bind();
+	this->buffer.bind();
+	vao.setVertexAttributes<vec4, vec4, vec4, vec4>();
+	vao.unbind();
+}
+
+void ParticleRenderer::render(const ParticleSystem &particles, mat4 transform) {
+	if(revision != particles.getRevision()) {
+		revision = particles.getRevision();
+		buffer.setData(particles.data(), opengl::Buffer<Particle>::DynamicDraw);
+	}
+
+	prog.use();
+	transformUBO.bindBase(0);
+	transformUBO.update(transform);
+	if(texture) {
+		texture->activate();
+	}
+	vao.bind();
+	glDrawArrays(GL_POINTS, 0, buffer.size());
+	vao.unbind();
+	// the geometry shader makes a quad of each point
+	opengl::drawCalls().add();
+	opengl::drawnTriangles().add(buffer.size() * 2);
+}
+
+void ParticleRenderer::setTexture(const std::shared_ptr<TiledTexture> &texture) {
+	this->texture = texture;
+}
+
+WorldRenderer::WorldRenderer(const WorldContainer &container, const Camera &cam, const std::shared_ptr<Entity> &mainEntity, const std::shared_ptr<TiledTexture> &texture)
+ : container(container), cam(cam), mainEntity(mainEntity), texture(texture) {
+	std::ifstream src("assets/platformer.glsl", std::ios::ate);
+	std::string buffer(src.tellg(), '\0');
+	src.seekg(src.beg);
+	src.read(buffer.data(), buffer.size());
+
+	shader = opengl::Program::load(buffer, opengl::Shader::VertexStage | opengl::Shader::FragmentStage);
+	shader.use();
+	shader.setUniform("sampler", 0);
+
+	// init ubos
+	cameraInfoUBO.bindBase(0);
+	cameraInfoUBO.setData({mat4(), mat4()});
+	modelInfoUBO.bindBase(1);
+	modelInfoUBO.setData({affine2().pack(), affine2().pack()});
+	renderInfoUBO.bindBase(2);
+	renderInfoUBO.setData({vec4(0), cam.res, 0.0f, 0.0f});
+
+	// init meshes
+	unitplane = opengl::Mesh<vec3, vec2>({
+		{ math::vec3( 0.5f, 0.5f, 0.0f), math::vec2(1,0) },
+		{ math::vec3(-0.5f, 0.5f, 0.0f), math::vec2(0,0) },
+		{ math::vec3( 0.5f,-0.5f, 0.0f), math::vec2(1,1) },
+		{ math::vec3(-0.5f,-0.5f, 0.0f), math::vec2(0,1) },
+	});
+}
+
+void WorldRenderer::render() {
+	shader.use();
+
+	cameraInfoUBO.bindBase(0);
+	modelInfoUBO.bindBase(1);
+	renderInfoUBO.bindBase(2);
+
+	cameraMutex.lock();
+
+	mat4 proj = cam.proj();
+	mat4 view = cam.view();
+	vec2 res = cam.res;
+	vec3 campos = cam.pos;
+
+	cameraInfoUBO.update({proj, view});
+	renderInfoUBO.update({vec4(0), res, 0.0f, 0.0f});
+
+	{
+		opengl::QueryPool::Scope pass("main entity");
+		modelInfoUBO.update({mainEntity->getTransform().pack(), mainEntity->getUVTransform().pack()});
+		mainEntity->getTexturePtr()->activate();
+		unitplane.drawElements(GL_TRIANGLE_STRIP);
+	}
+
+	cameraMutex.unlock();
+
+	{
+		opengl::QueryPool::Scope pass("chunks");
+		texture->activate();
+		std::lock_guard<std::mutex> lock(meshMutex);
+		std::erase_if(meshes, [](const auto &mesh) {
+			return !mesh.second.loaded;
+		});
+		for(auto &[chunkid, mesh] : meshes) {
+			lvec2 chunkoffset = chunkid - container.offset();
+			vec2 chunkpos = chunkoffset * Chunk::size * Tile::resolution;
+			if(dist(campos.xy, chunkCenter(chunkoffset)) < drawDistance) {
+				modelInfoUBO.update({affine2::translation(chunkpos).pack(), affine2().pack()});
+				mesh.render();
+			}
+		}
+	}
+
+	opengl::QueryPool::Scope pass("entities");
+	for(auto &entity : container.entities()) {
+		affine2 transform = entity->getTransform();
+		if(dist(campos.xy, transform.t) < Chunk::size * Tile::resolution * 2) {
+			modelInfoUBO.update({transform.pack(), entity->getUVTransform().pack()});
+			entity->getTexturePtr()->activate();
+			unitplane.drawElements(GL_TRIANGLE_STRIP);
+		}
+	}
+}
+
+void WorldRenderer::build() {
+	vec2 campos;
+	{
+		std::lock_guard<std::mutex> lock(cameraMutex);
+		campos = cam.pos.xy;
+	}
+
+	for(auto &[chunkid, chunk] : container.chunks()) {
+		if(dist(campos, chunkCenter(chunkid - container.offset())) < buildDistance) {
+			ChunkMesh *mesh;
+			{
+				std::lock_guard<std::mutex> lock(meshMutex);
+				mesh = &meshes[chunkid];
+			}
+			// only the render thread erases meshes, and only unloaded ones
+			mesh->build(chunk, meshMutex);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(meshMutex);
+	for(auto &[chunkid, mesh] : meshes) {
+		mesh.loaded = container.chunks().count(chunkid);
+	}
+}
+
+mat4 WorldRenderer::getCamTransform() {
+	std::lock_guard<std::mutex> lock(cameraMutex);
+	mat4 transform = cam.proj() * cam.view();
+	return transform;
+}
+
+std::mutex& WorldRenderer::getCameraMutex() {
+	return cameraMutex;
+}
\ No newline at end of file
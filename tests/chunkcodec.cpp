@@ -0,0 +1,121 @@
+#include <limits>
+#include <random>
+
+#include <chunkstream.hpp>
+#include <utils/serialization.hpp>
+
+#include "test.hpp"
+
+static const size_t tileCount = Chunk::size * Chunk::size;
+
+static void varints() {
+	for(int64_t value : {int64_t(0), int64_t(1), int64_t(-1), int64_t(63), int64_t(-64), int64_t(64), int64_t(1) << 40, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()}) {
+		std::vector<uint8_t> data;
+		writeVarint(data, zigzag(value));
+		std::span<const uint8_t> in = data;
+		uint64_t read;
+		CHECK(readVarint(in, read) && in.empty() && unzigzag(read) == value);
+		CHECK(data.size() <= 10);
+		// small magnitudes of either sign take a single byte
+		CHECK((data.size() == 1) == (value >= -64 && value < 64));
+	}
+
+	std::vector<uint8_t> data;
+	writeVarint(data, std::numeric_limits<uint64_t>::max());
+	for(size_t size = 0; size < data.size(); size++) {
+		std::span<const uint8_t> in = std::span(data).first(size);
+		uint64_t read;
+		CHECK(!readVarint(in, read));
+	}
+	// more than 64 bits
+	data = {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01};
+	std::span<const uint8_t> in = data;
+	uint64_t read;
+	CHECK(!readVarint(in, read));
+
+	uint8_t bytes[8];
+	put16(bytes, 0xbeef);
+	CHECK(bytes[0] == 0xef && bytes[1] == 0xbe && get16(bytes) == 0xbeef);
+	put64(bytes, 0x0123456789abcdefull);
+	CHECK(bytes[0] == 0xef && bytes[7] == 0x01 && get64(bytes) == 0x0123456789abcdefull && get32(bytes) == 0x89abcdef);
+}
+
+static void roundTrip(const std::vector<Tile> &tiles) {
+	std::vector<uint8_t> data = ChunkCodec::encode(tiles);
+	CHECK(data.size() <= ChunkCodec::maxSize);
+	std::vector<Tile> decoded(tileCount, Tile(1234));
+	CHECK(ChunkCodec::decode(data, decoded));
+	CHECK(decoded == tiles);
+	CHECK(ChunkCodec::hash(data) == ChunkCodec::hash(ChunkCodec::encode(decoded)));
+
+	// every truncation fails, as does trailing data or a chunk of another size
+	for(size_t size = 0; size < data.size(); size++) {
+		CHECK(!ChunkCodec::decode(std::span(data).first(size), decoded));
+	}
+	data.push_back(0);
+	CHECK(!ChunkCodec::decode(data, decoded));
+	data.pop_back();
+	decoded.resize(tileCount + 1);
+	CHECK(!ChunkCodec::decode(data, decoded));
+}
+
+static void corrupt(std::mt19937 &rng) {
+	std::vector<Tile> tiles(tileCount);
+	// more palette entries than tiles
+	std::vector<uint8_t> data = {0xff, 0xff, 0x03};
+	CHECK(!ChunkCodec::decode(data, tiles));
+	// a run past the end of the chunk
+	data = {1, 0, 0, 0, uint8_t(0x80 | ((tileCount + 1) & 0x7f)), uint8_t((tileCount + 1) >> 7), 0};
+	CHECK(!ChunkCodec::decode(data, tiles));
+	// an empty run
+	data = {1, 0, 0, 0, 0, 0};
+	CHECK(!ChunkCodec::decode(data, tiles));
+	// a palette index out of range
+	data = {1, 0, 0, 0, uint8_t(0x80 | (tileCount & 0x7f)), uint8_t(tileCount >> 7), 1};
+	CHECK(!ChunkCodec::decode(data, tiles));
+	data.back() = 0;
+	CHECK(ChunkCodec::decode(data, tiles));
+	// a tile type wider than 32 bits
+	data = {1, 0x80, 0x80, 0x80, 0x80, 0x10, 0, 0, uint8_t(0x80 | (tileCount & 0x7f)), uint8_t(tileCount >> 7), 0};
+	CHECK(!ChunkCodec::decode(data, tiles));
+
+	// random bytes either decode to a full chunk or fail
+	for(int i = 0; i < 10000; i++) {
+		data.resize(rng() % 32);
+		for(uint8_t &byte : data) {
+			byte = rng() % 4 ? rng() % 8 : rng();
+		}
+		if(ChunkCodec::decode(data, tiles)) {
+			CHECK(ChunkCodec::encode(tiles).size() <= data.size());
+		}
+	}
+}
+
+int main() {
+	varints();
+
+	std::mt19937 rng(1337);
+	std::vector<Tile> tiles(tileCount);
+	roundTrip(tiles);
+	for(int kinds : {1, 2, 8, 64, 1000}) {
+		for(Tile &tile : tiles) {
+			// mostly runs like real terrain, with some noise
+			if(rng() % 8 == 0) {
+				tile = Tile(rng() % kinds, rng() % 4, rng() % 16 ? 0 : uint64_t(rng()) << 32 | rng());
+			}
+		}
+		roundTrip(tiles);
+	}
+	for(Tile &tile : tiles) {
+		tile = Tile(rng(), rng(), uint64_t(rng()) << 32 | rng());
+	}
+	roundTrip(tiles);
+	// the widest values, every tile different
+	for(size_t i = 0; i < tiles.size(); i++) {
+		tiles[i] = Tile(UINT32_MAX - i, UINT32_MAX, UINT64_MAX - i);
+	}
+	roundTrip(tiles);
+
+	corrupt(rng);
+	return testFailures() != 0;
+}
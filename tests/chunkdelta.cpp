@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <random>
+
+#include <chunkdelta.hpp>
+#include <world.hpp>
+
+#include "test.hpp"
+
+class TestWorld : public WorldContainer {
+protected:
+	std::shared_ptr<Chunk> loadChunk(lvec2 pos) override {
+		return getChunkAbsolute(pos);
+	}
+};
+
+static Tile randomTile(std::mt19937 &rng) {
+	return Tile(rng() % 8, rng() % 16, rng() % 3 ? 0 : rng());
+}
+
+static bool equal(const Chunk &a, const Chunk &b) {
+	return std::ranges::equal(a.data(), b.data());
+}
+
+static void roundTrip(const TestWorld &world, std::mt19937 &rng, int edits) {
+	Chunk baseline(world, lvec2(0), vec2(1)), chunk(world, lvec2(0), vec2(1));
+	for(Tile &tile : baseline.data()) {
+		tile = randomTile(rng);
+	}
+	std::ranges::copy(std::as_const(baseline).data(), chunk.data().begin());
+
+	ChunkDelta edited;
+	size_t changed = 0;
+	for(int i = 0; i < edits; i++) {
+		unsigned index = rng() % chunk.data().size();
+		Tile tile = randomTile(rng);
+		chunk.data()[index] = tile;
+		edited.set(index, tile);
+	}
+	for(size_t i = 0; i < chunk.data().size(); i++) {
+		changed += !(std::as_const(chunk).data()[i] == std::as_const(baseline).data()[i]);
+	}
+
+	ChunkDelta delta(baseline, chunk);
+	CHECK(delta.size() == changed);
+	CHECK(delta.empty() == (changed == 0));
+
+	// runs are sorted, disjoint and not adjacent
+	for(size_t i = 1; i < delta.runs().size(); i++) {
+		CHECK(delta.runs()[i - 1].begin + delta.runs()[i - 1].tiles.size() < delta.runs()[i].begin);
+	}
+
+	Chunk applied(world, lvec2(0), vec2(1));
+	std::ranges::copy(std::as_const(baseline).data(), applied.data().begin());
+	delta.apply(applied);
+	CHECK(equal(applied, chunk));
+
+	// set() may keep tiles that equal the baseline, applying it still has to give the same chunk
+	std::ranges::copy(std::as_const(baseline).data(), applied.data().begin());
+	edited.apply(applied);
+	CHECK(equal(applied, chunk));
+
+	std::vector<uint8_t> data = delta.serialize();
+	ChunkDelta loaded;
+	CHECK(ChunkDelta::deserialize(data, loaded));
+	CHECK(loaded.serialize() == data);
+	std::ranges::copy(std::as_const(baseline).data(), applied.data().begin());
+	loaded.apply(applied);
+	CHECK(equal(applied, chunk));
+
+	// every truncation fails, as does trailing data
+	for(size_t size = 0; size < data.size(); size++) {
+		CHECK(!ChunkDelta::deserialize(std::span(data).first(size), loaded));
+	}
+	data.push_back(0);
+	CHECK(!ChunkDelta::deserialize(data, loaded));
+}
+
+static void corrupt(const TestWorld &world, std::mt19937 &rng) {
+	ChunkDelta delta;
+	const uint64_t tiles = Chunk::size * Chunk::size;
+
+	// one run past the end of the chunk
+	std::vector<uint8_t> data = {1, uint8_t(0x80 | (tiles & 0x7f)), uint8_t(tiles >> 7), 1, 0, 0, 0};
+	CHECK(!ChunkDelta::deserialize(data, delta));
+	// a skip that would overflow
+	data = {1, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01, 1, 0, 0, 0};
+	CHECK(!ChunkDelta::deserialize(data, delta));
+	// more runs than tiles
+	data = {0xff, 0xff, 0x03};
+	CHECK(!ChunkDelta::deserialize(data, delta));
+	// a tile type wider than 32 bits
+	data = {1, 0, 1, 0x80, 0x80, 0x80, 0x80, 0x10, 0, 0};
+	CHECK(!ChunkDelta::deserialize(data, delta));
+	// an unterminated varint
+	data = {0x80};
+	CHECK(!ChunkDelta::deserialize(data, delta));
+
+	// whatever random bytes decode to has to stay inside the chunk
+	for(int i = 0; i < 10000; i++) {
+		data.resize(rng() % 32);
+		for(uint8_t &byte : data) {
+			byte = rng() % 4 ? rng() % 8 : rng();
+		}
+		if(ChunkDelta::deserialize(data, delta)) {
+			size_t end = 0;
+			for(const ChunkDelta::Run &run : delta.runs()) {
+				CHECK(run.begin >= end);
+				end = run.begin + run.tiles.size();
+			}
+			CHECK(end <= tiles);
+			Chunk chunk(world, lvec2(0), vec2(1));
+			delta.apply(chunk);
+		}
+	}
+}
+
+int main() {
+	TestWorld world;
+	std::mt19937 rng(1337);
+	for(int edits : {0, 1, 2, 10, 100, 1000, 5000}) {
+		for(int i = 0; i < 4; i++) {
+			roundTrip(world, rng, edits);
+		}
+	}
+	corrupt(world, rng);
+	return testFailures() != 0;
+}
@@ -0,0 +1,202 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <network/http.hpp>
+
+#include "test.hpp"
+
+using namespace network;
+
+// feeds input the way a connection does: every call sees all unconsumed input in a new buffer, the old one is overwritten
+class feeder {
+public:
+	http::parser::status feed(std::string_view data) {
+		std::string next = buffer + std::string(data);
+		buffer.assign(buffer.size(), '#');
+		buffer = std::move(next);
+		return p.parse(buffer);
+	}
+
+	void consume() {
+		buffer.erase(0, p.consumed());
+		p.reset();
+	}
+
+	http::parser p;
+	std::string buffer;
+};
+
+static void splitBody() {
+	feeder f;
+	CHECK(f.feed("POST /upload?x=1 HTTP/1.1\r\nHost: example.com\r\nContent-Length: 11\r\n\r\n") == http::parser::Incomplete);
+	CHECK(f.feed("hello ") == http::parser::Incomplete);
+	CHECK(f.feed("world") == http::parser::Complete);
+
+	const http::request &req = f.p.get();
+	CHECK(req.method == "POST");
+	CHECK(req.target == "/upload?x=1");
+	CHECK(req.version == "HTTP/1.1");
+	CHECK(req.get("host") == "example.com");
+	CHECK(req.get("Content-Length") == "11");
+	CHECK(req.body == "hello world");
+	CHECK(req.keepAlive);
+	CHECK(f.p.consumed() == f.buffer.size());
+}
+
+static void splitChunked() {
+	feeder f;
+	CHECK(f.feed("PUT /chunks HTTP/1.1\r\nTransfer-Encoding: chunked\r\nConnection: close\r\n\r\n5\r\nhel") == http::parser::Incomplete);
+	CHECK(f.feed("lo\r\n6\r\n world\r\n0\r\n") == http::parser::Incomplete);
+	CHECK(f.feed("X-Trailer: 1\r\n\r\n") == http::parser::Complete);
+
+	const http::request &req = f.p.get();
+	CHECK(req.method == "PUT");
+	CHECK(req.target == "/chunks");
+	CHECK(req.get("transfer-encoding") == "chunked");
+	CHECK(req.body == "hello world");
+	CHECK(!req.keepAlive);
+}
+
+// every split of the input into two reads, and one byte per read
+static void everySplit() {
+	std::string request = "GET /index.html HTTP/1.0\r\nConnection: keep-alive\r\nContent-Length: 3\r\n\r\nabc";
+	for(size_t split = 0; split <= request.size(); split++) {
+		feeder f;
+		http::parser::status first = f.feed(std::string_view(request).substr(0, split));
+		CHECK(first == (split == request.size() ? http::parser::Complete : http::parser::Incomplete));
+		if(first != http::parser::Complete) {
+			CHECK(f.feed(std::string_view(request).substr(split)) == http::parser::Complete);
+		}
+		CHECK(f.p.get().target == "/index.html");
+		CHECK(f.p.get().get("connection") == "keep-alive");
+		CHECK(f.p.get().body == "abc");
+		CHECK(f.p.get().keepAlive);
+	}
+
+	feeder f;
+	http::parser::status status = http::parser::Incomplete;
+	for(char c : request) {
+		CHECK(status == http::parser::Incomplete);
+		status = f.feed(std::string_view(&c, 1));
+	}
+	CHECK(status == http::parser::Complete);
+	CHECK(f.p.get().method == "GET");
+	CHECK(f.p.get().body == "abc");
+}
+
+static void pipelined() {
+	feeder f;
+	CHECK(f.feed("GET /a HTTP/1.1\r\n\r\nGET /b HTTP/1.1\r\nContent-Length: 2\r\n\r\nxy") == http::parser::Complete);
+	CHECK(f.p.get().target == "/a");
+	CHECK(f.p.get().body.empty());
+	f.consume();
+	CHECK(f.feed("") == http::parser::Complete);
+	CHECK(f.p.get().target == "/b");
+	CHECK(f.p.get().body == "xy");
+	f.consume();
+	CHECK(f.buffer.empty());
+}
+
+static void errors() {
+	auto error = [](std::string_view data) {
+		http::parser p;
+		return p.parse(data) == http::parser::Error ? p.error() : 0;
+	};
+	CHECK(error("GET /\r\n\r\n") == HttpStatus_BadRequest);
+	CHECK(error("GET / HTTP/2.0\r\n\r\n") == HttpStatus_HTTPVersionNotSupported);
+	CHECK(error("GET / HTTP/1.1\r\nno colon\r\n\r\n") == HttpStatus_BadRequest);
+	CHECK(error("GET / HTTP/1.1\r\n: empty name\r\n\r\n") == HttpStatus_BadRequest);
+	CHECK(error("POST / HTTP/1.1\r\nContent-Length: 12x\r\n\r\n") == HttpStatus_BadRequest);
+	CHECK(error("POST / HTTP/1.1\r\nContent-Length: 99999999999\r\n\r\n") == HttpStatus_PayloadTooLarge);
+	CHECK(error("POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n") == HttpStatus_NotImplemented);
+	CHECK(error("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n") == HttpStatus_BadRequest);
+	CHECK(error(std::string(http::parser::maxHeaderSize + 1, 'a')) == HttpStatus_RequestHeaderFieldsTooLarge);
+
+	// truncated requests never complete
+	std::string request = "POST /x HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n0\r\n\r\n";
+	for(size_t size = 0; size < request.size(); size++) {
+		http::parser p;
+		CHECK(p.parse(std::string_view(request).substr(0, size)) == http::parser::Incomplete);
+	}
+}
+
+static size_t openFiles() {
+	return std::distance(std::filesystem::directory_iterator("/proc/self/fd"), std::filesystem::directory_iterator());
+}
+
+// HEAD answers with the headers of the file, the file itself is closed even though the connection ends right after
+static void headRequests(const std::filesystem::path &dir) {
+	std::ofstream(dir / "index.html") << "<p>hello</p>";
+	http::server server(http::serveDirectory(dir.string()), 0, address::LoopBack, 1);
+	server.start();
+	size_t before = openFiles();
+	for(int i = 0; i < 3; i++) {
+		tcpsocket socket(AF_INET, SOCK_STREAM, 0);
+		CHECK(socket.connect("127.0.0.1", server.getPort()));
+		CHECK(socket.send("HEAD /index.html HTTP/1.1\r\nConnection: close\r\n\r\n"));
+		std::string response;
+		while(auto line = socket.readUntil('\n')) {
+			response.append(*line).push_back('\n');
+		}
+		CHECK(response.starts_with("HTTP/1.1 200"));
+		CHECK(response.find("Content-Length: 12\r\n") != std::string::npos);
+		CHECK(response.ends_with("\r\n\r\n") && !socket.readExact(1));
+	}
+	for(int i = 0; i < 100 && server.connections() > 0; i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	CHECK(openFiles() == before);
+	server.stop();
+}
+
+// a client that half-closes right after its request still gets the whole response, a file too big to go out in one write
+static void halfClose(const std::filesystem::path &dir, eventloop::backends backend) {
+	std::string content(8 * 1024 * 1024, 'x');
+	std::ofstream(dir / "big.bin") << content;
+	http::server server(http::serveDirectory(dir.string()), 0, address::LoopBack, 1, backend);
+	server.start();
+
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+	struct sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(server.getPort());
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	CHECK(connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0);
+	std::string request = "GET /big.bin HTTP/1.1\r\n\r\n";
+	CHECK(::send(fd, request.data(), request.size(), 0) == ssize_t(request.size()));
+	shutdown(fd, SHUT_WR);
+	// the server sees the end of the request stream while most of the file is still queued
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	std::string response;
+	char buffer[65536];
+	ssize_t len;
+	while((len = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+		response.append(buffer, len);
+	}
+	close(fd);
+	size_t body = response.find("\r\n\r\n");
+	CHECK(response.starts_with("HTTP/1.1 200"));
+	CHECK(body != std::string::npos && response.size() - body - 4 == content.size());
+	server.stop();
+}
+
+int main() {
+	splitBody();
+	splitChunked();
+	everySplit();
+	pipelined();
+	errors();
+
+	std::filesystem::path dir = std::filesystem::temp_directory_path() / "photon_test_http";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir);
+	headRequests(dir);
+	halfClose(dir, eventloop::Epoll);
+	halfClose(dir, eventloop::IoUring);
+	std::filesystem::remove_all(dir);
+	return testFailures() != 0;
+}
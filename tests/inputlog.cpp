@@ -0,0 +1,138 @@
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+#include <inputlog.hpp>
+
+#include "test.hpp"
+
+static bool equal(const InputLog &a, const InputLog &b) {
+	if(a.getSeed() != b.getSeed() || a.getFrames().size() != b.getFrames().size()) {
+		return false;
+	}
+	for(size_t i = 0; i < a.getFrames().size(); i++) {
+		const InputLog::Frame &x = a.getFrames()[i], &y = b.getFrames()[i];
+		bool edit = x.flags & (InputLog::Frame::place | InputLog::Frame::remove);
+		if(x.dt != y.dt || x.move != y.move || x.flags != y.flags || (edit && x.tile != y.tile)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static InputLog randomLog(std::mt19937 &rng, size_t frames) {
+	InputLog log(rng());
+	for(size_t i = 0; i < frames; i++) {
+		InputLog::Frame frame;
+		frame.dt = std::uniform_real_distribution<float>(0.001f, 0.1f)(rng);
+		// moves are stored in 1/127 steps
+		frame.move = (int(rng() % 255) - 127) / 127.0f;
+		frame.flags = rng() & 0x7f;
+		frame.tile = lvec2(int64_t(rng()) - int64_t(rng()), rng() % 4 ? int64_t(rng() % 64) - 32 : int64_t(uint64_t(rng()) << 31));
+		log.push(frame);
+	}
+	return log;
+}
+
+static void roundTrip(std::mt19937 &rng, size_t frames) {
+	InputLog log = randomLog(rng, frames), loaded;
+	std::vector<uint8_t> data = log.serialize();
+	CHECK(InputLog::deserialize(data, loaded));
+	CHECK(equal(log, loaded));
+	CHECK(loaded.serialize() == data);
+
+	// every truncation fails, as does trailing data
+	for(size_t size = 0; size < data.size(); size++) {
+		CHECK(!InputLog::deserialize(std::span(data).first(size), loaded));
+	}
+	data.push_back(0);
+	CHECK(!InputLog::deserialize(data, loaded));
+}
+
+static void corrupt(std::mt19937 &rng) {
+	InputLog log;
+	std::vector<uint8_t> valid = InputLog(7).serialize();
+	CHECK(InputLog::deserialize(valid, log) && log.getSeed() == 7 && log.getFrames().empty());
+
+	std::vector<uint8_t> data = valid;
+	data[0] = 'X';
+	CHECK(!InputLog::deserialize(data, log));
+	// another version
+	data = valid;
+	data[4] = InputLog::version + 1;
+	CHECK(!InputLog::deserialize(data, log));
+	// a seed wider than 32 bits
+	data = {'P', 'H', 'I', 'L', InputLog::version, 0x80, 0x80, 0x80, 0x80, 0x10, 0};
+	CHECK(!InputLog::deserialize(data, log));
+	// far more frames than the data holds
+	data = {'P', 'H', 'I', 'L', InputLog::version, 0, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f};
+	CHECK(!InputLog::deserialize(data, log));
+
+	// a frame time that isn't a positive number
+	for(float dt : {std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(), -0.5f}) {
+		InputLog bad(1);
+		InputLog::Frame frame;
+		frame.dt = dt;
+		bad.push(frame);
+		CHECK(!InputLog::deserialize(bad.serialize(), log));
+	}
+
+	// random bytes after the header either give frames with sane times or fail
+	for(int i = 0; i < 10000; i++) {
+		data = {'P', 'H', 'I', 'L', InputLog::version, 1, uint8_t(rng() % 4)};
+		data.resize(data.size() + rng() % 24);
+		for(size_t j = 7; j < data.size(); j++) {
+			data[j] = rng();
+		}
+		if(InputLog::deserialize(data, log)) {
+			for(const InputLog::Frame &frame : log.getFrames()) {
+				CHECK(std::isfinite(frame.dt) && frame.dt >= 0.0f);
+				CHECK(frame.move >= -1.01f && frame.move <= 1.01f);
+			}
+		}
+	}
+}
+
+static void files(std::mt19937 &rng, const std::filesystem::path &dir) {
+	std::string path = (dir / "session.log").string();
+	InputLog log = randomLog(rng, 100);
+	log.save(path);
+	CHECK(equal(InputLog::load(path), log));
+
+	// a missing, truncated or corrupt file throws, that is what the game reports on --replay
+	bool thrown = false;
+	try {
+		InputLog::load((dir / "missing.log").string());
+	}
+	catch(const std::runtime_error &) {
+		thrown = true;
+	}
+	CHECK(thrown);
+
+	std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+	thrown = false;
+	try {
+		InputLog::load(path);
+	}
+	catch(const std::runtime_error &) {
+		thrown = true;
+	}
+	CHECK(thrown);
+}
+
+int main() {
+	std::mt19937 rng(1337);
+	for(size_t frames : {0, 1, 2, 10, 1000}) {
+		roundTrip(rng, frames);
+	}
+	corrupt(rng);
+
+	std::filesystem::path dir = std::filesystem::temp_directory_path() / "photon_test_inputlog";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir);
+	files(rng, dir);
+	std::filesystem::remove_all(dir);
+	return testFailures() != 0;
+}
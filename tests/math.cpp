@@ -0,0 +1,119 @@
+#include <cmath>
+#include <random>
+
+#include <math/matrix.hpp>
+#include <math/vector.hpp>
+
+#include "test.hpp"
+
+using namespace math;
+
+using dmat4 = tmat4<double>;
+
+// built twice, test_math_scalar defines MATH_NO_SIMD, so the float results of both builds
+// are checked against the generic code instantiated for double
+static double difference(const mat4 &a, const dmat4 &b) {
+	double error = 0.0;
+	for(unsigned col = 0; col < 4; col++) {
+		for(unsigned row = 0; row < 4; row++) {
+			error = std::max(error, std::abs(a(col, row) - b(col, row)) / std::max(1.0, std::abs(b(col, row))));
+		}
+	}
+	return error;
+}
+
+static double difference(const vec4 &a, const dvec4 &b) {
+	double error = 0.0;
+	for(unsigned i = 0; i < 4; i++) {
+		error = std::max(error, std::abs(a[i] - b[i]) / std::max(1.0, std::abs(b[i])));
+	}
+	return error;
+}
+
+static mat4 randomMatrix(std::mt19937 &rng) {
+	std::uniform_real_distribution<float> dist(-4.0f, 4.0f);
+	mat4 m;
+	for(unsigned col = 0; col < 4; col++) {
+		for(unsigned row = 0; row < 4; row++) {
+			m(col, row) = dist(rng);
+		}
+	}
+	return m;
+}
+
+static vec3 randomVector(std::mt19937 &rng) {
+	std::uniform_real_distribution<float> dist(-3.0f, 3.0f);
+	return vec3(dist(rng), dist(rng), dist(rng));
+}
+
+static void vectors(std::mt19937 &rng) {
+	for(int i = 0; i < 100; i++) {
+		vec4 a(randomVector(rng), 1.5f), b(randomVector(rng), -0.5f);
+		dvec4 da(a.x, a.y, a.z, a.w), db(b.x, b.y, b.z, b.w);
+		CHECK(difference(a + b, da + db) < 1e-6);
+		CHECK(difference(a - b, da - db) < 1e-6);
+		CHECK(difference(a * b, da * db) < 1e-6);
+		CHECK(difference(a / b, da / db) < 1e-5);
+		CHECK(difference(-a, -da) == 0.0);
+
+		vec4 c = a;
+		c += b, c *= b, c -= a, c /= b;
+		CHECK(difference(c, ((da + db) * db - da) / db) < 1e-5);
+	}
+
+	// negation only flips the sign bit, in both builds
+	vec4 zero = -vec4(0.0f);
+	CHECK(std::signbit(zero.x) && std::signbit(zero.y) && std::signbit(zero.z) && std::signbit(zero.w));
+	vec4 negativeZero = -zero;
+	CHECK(!std::signbit(negativeZero.x) && !std::signbit(negativeZero.w));
+
+	vec4 v(1, 2, 3, 4);
+	CHECK(v[0] == 1 && v[1] == 2 && v[2] == 3 && v[3] == 4);
+	CHECK(v[4] == 1 && vec3(5, 6, 7)[3] == 5 && vec2(8, 9)[2] == 8);
+	v[2] = 7;
+	CHECK(v.z == 7);
+}
+
+static void matrices(std::mt19937 &rng) {
+	for(int i = 0; i < 100; i++) {
+		mat4 a = randomMatrix(rng), b = randomMatrix(rng);
+		dmat4 da(a), db(b);
+		vec4 v(randomVector(rng), 1.0f);
+		CHECK(difference(a * b, da * db) < 1e-5);
+		CHECK(difference(a * v, da * dvec4(v.x, v.y, v.z, v.w)) < 1e-5);
+		CHECK(difference(a.transpose(), da.transpose()) == 0.0);
+
+		// the inverse grows with the condition of the matrix, so only well conditioned ones are compared
+		double det = da.determinant();
+		if(std::abs(det) > 1.0) {
+			CHECK(difference(a.inverse(), da.inverse()) < 1e-3);
+			CHECK(difference(a * a.inverse(), dmat4()) < 1e-3);
+		}
+
+		vec3 angles = randomVector(rng);
+		mat4 affine = mat4::translation(randomVector(rng)) * mat4::rotation(angles) * mat4::scaling(vec3(0.5f, 2.0f, 1.5f));
+		dmat4 daffine(affine);
+		CHECK(difference(affine.affineInverse(), daffine.affineInverse()) < 1e-5);
+		CHECK(difference(affine.affineInverse(), daffine.inverse()) < 1e-5);
+		CHECK(difference(affine * affine.affineInverse(), dmat4()) < 1e-5);
+
+		// z * y * x of the rotations around each axis on its own
+		dvec3 dangles(angles.x, angles.y, angles.z);
+		dmat4 composed = dmat4::rotation(dvec3(0, 0, dangles.z)) * dmat4::rotation(dvec3(0, dangles.y, 0)) * dmat4::rotation(dvec3(dangles.x, 0, 0));
+		CHECK(difference(mat4::rotation(angles), composed) < 1e-6);
+		CHECK(difference(mat4::rotation(angles), dmat4::rotation(dangles)) < 1e-6);
+	}
+
+	// not invertible, both give the identity
+	mat4 singular(1, 2, 3, 4, 2, 4, 6, 8, 0, 1, 0, 1, 1, 0, 1, 0);
+	CHECK(difference(singular.inverse(), dmat4()) == 0.0);
+	mat4 flat = mat4::scaling(vec3(1, 0, 1));
+	CHECK(difference(flat.affineInverse(), dmat4()) == 0.0);
+}
+
+int main() {
+	std::mt19937 rng(1337);
+	vectors(rng);
+	matrices(rng);
+	return testFailures() != 0;
+}
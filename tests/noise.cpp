@@ -0,0 +1,121 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <math/noise.hpp>
+
+#include "test.hpp"
+
+using namespace math;
+
+// the float batches against the double scalar path, the largest difference.
+// rounding stays near 1e-5, a kernel that interpolates differently is off by far more
+static double perlinPoints(const perlin &noise, std::mt19937 &rng, double range) {
+	std::uniform_real_distribution<float> dist(-range, range);
+	std::vector<vec2> points2(1001);
+	std::vector<vec3> points3(1001);
+	for(size_t i = 0; i < points2.size(); i++) {
+		points2[i] = vec2(dist(rng), dist(rng));
+		points3[i] = vec3(dist(rng), dist(rng), dist(rng));
+	}
+	std::vector<float> out2(points2.size()), out3(points3.size());
+	noise.noise(points2, out2);
+	noise.noise(points3, out3);
+
+	double error = 0.0;
+	for(size_t i = 0; i < points2.size(); i++) {
+		error = std::max(error, std::abs(out2[i] - noise.noise(points2[i].x, points2[i].y)));
+		error = std::max(error, std::abs(out3[i] - noise.noise(points3[i].x, points3[i].y, points3[i].z)));
+	}
+	return error;
+}
+
+static double perlinGrids(const perlin &noise, dvec3 origin) {
+	ivec3 size(37, 5, 3);
+	dvec3 step(0.173, 0.291, 0.37);
+	std::vector<float> out2(size.x * size.y), out3(size.x * size.y * size.z);
+	noise.grid(dvec2(origin.x, origin.y), dvec2(step.x, step.y), ivec2(size.x, size.y), out2);
+	noise.grid(origin, step, size, out3);
+
+	double error = 0.0;
+	for(int z = 0; z < size.z; z++) {
+		for(int y = 0; y < size.y; y++) {
+			for(int x = 0; x < size.x; x++) {
+				dvec3 pos = origin + step * dvec3(x, y, z);
+				if(z == 0) {
+					error = std::max(error, std::abs(out2[y * size.x + x] - noise.noise(pos.x, pos.y)));
+				}
+				error = std::max(error, std::abs(out3[(z * size.y + y) * size.x + x] - noise.noise(pos.x, pos.y, pos.z)));
+			}
+		}
+	}
+	return error;
+}
+
+static double simplexBatches(const simplex &noise, std::mt19937 &rng, dvec2 origin) {
+	std::uniform_real_distribution<float> dist(-50.0f, 50.0f);
+	std::vector<vec2> points(1001);
+	for(vec2 &point : points) {
+		point = vec2(dist(rng), dist(rng));
+	}
+	std::vector<float> out(points.size());
+	noise.noise2d(points, out);
+	double error = 0.0;
+	for(size_t i = 0; i < points.size(); i++) {
+		error = std::max(error, std::abs(out[i] - noise.noise2d(dvec2(points[i].x, points[i].y))));
+	}
+
+	ivec2 size(37, 11);
+	dvec2 step(0.173, 0.291);
+	std::vector<float> grid(size.x * size.y);
+	noise.grid2d(origin, step, size, grid);
+	for(int y = 0; y < size.y; y++) {
+		for(int x = 0; x < size.x; x++) {
+			error = std::max(error, std::abs(grid[y * size.x + x] - noise.noise2d(origin + step * dvec2(x, y))));
+		}
+	}
+	return error;
+}
+
+// simplex::noise2d, noise3d, noise4d and perlin::noise at (x, y, z) of the same points. the simplex values are
+// those of the tables before they were built at compile time, a change to the lattice tables shows up here
+struct Golden {
+	uint64_t seed;
+	dvec4 pos;
+	double simplex2, simplex3, simplex4, perlin3;
+};
+
+static const Golden golden[] = {
+	{0, dvec4(0.3, -1.7, 2.9, 0.45), 0.32028574335676158, 0.30750152178739093, -0.072363466992677525, 0.80473203163854035},
+	{0, dvec4(12.25, 7.5, -3.125, -8.8), -0.53745360432086753, 0.21949240583183016, 0.055368301853666951, 0.7175489217042923},
+	{0, dvec4(-9999.63, 1999.89, 517.3, 91.9), 0.77470343125169439, -0.29408600610709629, 0.052162212364314509, 0.59285981506132324},
+	{1, dvec4(0.3, -1.7, 2.9, 0.45), 0.51759847333472064, -0.31846014975568276, 0.24213344588254268, 0.80473203163854035},
+	{1, dvec4(12.25, 7.5, -3.125, -8.8), 0.31493522619502617, -0.27098513515138201, 0.091957879175408708, 0.7175489217042923},
+	{1, dvec4(-9999.63, 1999.89, 517.3, 91.9), -0.29630493002541547, 0.52227508238746567, -0.011203737363878355, 0.59285981506132324},
+	{1337, dvec4(0.3, -1.7, 2.9, 0.45), 0.67275540829863278, 0.27035178397070186, 0.04049357880798557, 0.37468224441666553},
+	{1337, dvec4(12.25, 7.5, -3.125, -8.8), 0.46141233067327714, 0.15944692467873534, 0.031332323979986115, 0.5639275535941124},
+	{1337, dvec4(-9999.63, 1999.89, 517.3, 91.9), 0.71757889615359516, 0.37231959268733028, -0.072465475084334943, 0.25433345903521359},
+};
+
+int main() {
+	std::mt19937 rng(1337);
+	for(uint64_t seed : {0, 1, 1337}) {
+		perlin p(seed);
+		simplex s(seed);
+		CHECK(perlinPoints(p, rng, 50.0) < 1e-4);
+		for(dvec3 origin : {dvec3(0.0), dvec3(-3.7, 12.1, 0.5), dvec3(1e5 + 0.3, -1e5 - 0.6, 2e4 + 0.1)}) {
+			CHECK(perlinGrids(p, origin) < 1e-4);
+			CHECK(simplexBatches(s, rng, dvec2(origin.x, origin.y)) < 1e-4);
+		}
+	}
+
+	for(const Golden &g : golden) {
+		simplex s(g.seed);
+		perlin p(g.seed);
+		CHECK(std::abs(s.noise2d(dvec2(g.pos.x, g.pos.y)) - g.simplex2) < 1e-12);
+		CHECK(std::abs(s.noise3d(dvec3(g.pos.x, g.pos.y, g.pos.z)) - g.simplex3) < 1e-12);
+		CHECK(std::abs(s.noise4d(g.pos) - g.simplex4) < 1e-12);
+		CHECK(std::abs(p.noise(g.pos.x, g.pos.y, g.pos.z) - g.perlin3) < 1e-12);
+	}
+	return testFailures() != 0;
+}
@@ -0,0 +1,173 @@
+#include <array>
+#include <cmath>
+#include <memory>
+#include <random>
+
+#include <replication.hpp>
+#include <rigidbody.hpp>
+#include <world.hpp>
+
+#include "test.hpp"
+
+class TestWorld : public WorldContainer {
+protected:
+	std::shared_ptr<Chunk> loadChunk(lvec2 pos) override {
+		return getChunkAbsolute(pos);
+	}
+};
+
+// forwards the datagrams of a single client and drops some of them in both directions
+class LossyRelay {
+public:
+	LossyRelay(unsigned short serverPort, double loss) : server(*network::udpsocket::resolve("127.0.0.1", serverPort)), loss(loss) {}
+
+	unsigned short getPort() const {
+		return front.getPort();
+	}
+
+	void pump() {
+		struct sockaddr_in peer;
+		int len;
+		while((len = front.recvFrom(buffer, peer)) >= 0) {
+			client = peer;
+			forward(back, len, server);
+		}
+		while(client && (len = back.recvFrom(buffer, peer)) >= 0) {
+			forward(front, len, *client);
+		}
+	}
+
+private:
+	void forward(network::udpsocket &socket, int len, const struct sockaddr_in &to) {
+		if(std::uniform_real_distribution<double>(0.0, 1.0)(rng) >= loss) {
+			socket.sendTo(std::span(buffer.data(), len), to);
+		}
+	}
+
+	network::udpsocket front = network::udpsocket(network::address::LoopBack);
+	network::udpsocket back = network::udpsocket(network::address::LoopBack);
+	struct sockaddr_in server;
+	std::optional<struct sockaddr_in> client;
+	std::array<uint8_t, 2048> buffer;
+	double loss;
+	std::mt19937 rng = std::mt19937(42);
+};
+
+// constant speeds, so the interpolation between snapshots is exact up to the quantization.
+// every fourth entity stands still, the speeds cover several delta size classes
+static void motion(int i, double time, vec2 &pos, vec2 &speed) {
+	speed = i % 4 == 0 ? vec2(0.0f) : vec2(float(i % 7) * 24.0f - 72.0f, float(i % 5) * 300.0f - 600.0f);
+	pos = vec2(float(i % 20) * 96.0f, float(i / 20) * 96.0f) + speed * float(time);
+}
+
+struct Scene {
+	Scene(int entities) {
+		for(int i = 0; i < entities; i++) {
+			bodies.push_back(world.createEntity<RigidBody>(std::shared_ptr<TiledTexture>()));
+			bodies.back()->scale.x = i % 3 == 0 ? -1.0f : 1.0f;
+		}
+	}
+
+	void move(int tick) {
+		for(size_t i = 0; i < bodies.size(); i++) {
+			motion(i, tick / double(tickRate), bodies[i]->pos, bodies[i]->speed);
+		}
+	}
+
+	static constexpr uint8_t tickRate = 60;
+	TestWorld world;
+	std::vector<std::shared_ptr<RigidBody>> bodies;
+};
+
+// largest distance between the interpolated and the exact positions, negative if a state is missing or wrong
+static double error(const Scene &scene, const ReplicationClient &client) {
+	const std::vector<EntityState> &states = client.getStates();
+	if(states.size() != scene.bodies.size()) {
+		return -1.0;
+	}
+	// server ticks count from 1, tick n holds the motion at (n - 1) * dt
+	double time = client.getTime() - 1.0 / scene.tickRate, max = 0.0;
+	for(size_t i = 0; i < states.size(); i++) {
+		vec2 pos, speed;
+		motion(i, time, pos, speed);
+		if(states[i].flipped != (i % 3 == 0) || length(states[i].speed - speed) > 0.25f) {
+			return -1.0;
+		}
+		max = std::max<double>(max, length(states[i].pos - pos));
+	}
+	return max;
+}
+
+static void loopback() {
+	// enough entities that the first snapshot is split into several datagrams
+	Scene scene(400);
+	ReplicationServer server(scene.world, 0, scene.tickRate);
+	ReplicationClient first("127.0.0.1", server.getPort()), late("127.0.0.1", server.getPort());
+	CHECK(!first.isSynchronized());
+
+	double maxError = 0.0;
+	for(int tick = 0; tick < 180; tick++) {
+		scene.move(tick);
+		server.tick();
+		first.update(1.0f / scene.tickRate);
+		if(tick >= 60) {
+			late.update(1.0f / scene.tickRate);
+		}
+		if(tick >= 30) {
+			double e = error(scene, first);
+			CHECK(e >= 0.0);
+			maxError = std::max(maxError, e);
+		}
+	}
+	CHECK(server.getClientCount() == 2);
+	CHECK(first.isSynchronized() && late.isSynchronized());
+	// 1/8 pixel quantization in both axes
+	CHECK(maxError < 0.2);
+	CHECK(error(scene, late) >= 0.0 && error(scene, late) < 0.2);
+	// the steady state costs far less than the full states
+	CHECK(first.getBytesReceived() < 180 * 400 * 4);
+
+	TestWorld mirror;
+	for(size_t i = 0; i < scene.bodies.size(); i++) {
+		mirror.createEntity<RigidBody>(std::shared_ptr<TiledTexture>());
+	}
+	first.apply(mirror);
+	for(size_t i = 0; i < scene.bodies.size(); i++) {
+		const RigidBody &body = static_cast<const RigidBody&>(*mirror.entities()[i]);
+		CHECK(body.pos == first.getStates()[i].pos);
+		CHECK((body.scale.x < 0.0f) == (i % 3 == 0));
+	}
+}
+
+// lost datagrams and acks, the deltas only ever refer to snapshots the client has
+static void lossy() {
+	Scene scene(100);
+	ReplicationServer server(scene.world, 0, scene.tickRate);
+	LossyRelay relay(server.getPort(), 0.2);
+	ReplicationClient client("127.0.0.1", relay.getPort(), 0.15f);
+
+	double maxError = 0.0;
+	int checked = 0;
+	for(int tick = 0; tick < 600; tick++) {
+		scene.move(tick);
+		server.tick();
+		relay.pump();
+		client.update(1.0f / scene.tickRate);
+		relay.pump();
+		if(tick >= 120) {
+			double e = error(scene, client);
+			CHECK(e >= 0.0);
+			maxError = std::max(maxError, e);
+			checked++;
+		}
+	}
+	CHECK(server.getClientCount() == 1);
+	CHECK(checked == 480);
+	CHECK(maxError < 0.2);
+}
+
+int main() {
+	loopback();
+	lossy();
+	return testFailures() ? 1 : 0;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+// the test executables count failed checks and return non zero if there were any
+inline int& testFailures() {
+	static int failures = 0;
+	return failures;
+}
+
+#define CHECK(condition) do { \
+	if(!(condition)) { \
+		spdlog::error("{}:{}: check failed: {}", __FILE__, __LINE__, #condition); \
+		testFailures()++; \
+	} \
+} while(0)
@@ -0,0 +1,120 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <worlddb.hpp>
+
+#include "test.hpp"
+
+static std::vector<uint8_t> record(char c, size_t size) {
+	return std::vector<uint8_t>(size, uint8_t(c));
+}
+
+static bool readsAs(RegionFile &file, unsigned index, const std::vector<uint8_t> &expected) {
+	return file.read(index, [&](std::span<const uint8_t> data) {
+		return std::ranges::equal(data, expected);
+	});
+}
+
+// the end of the file and the dead space have to be derived from the header after a reopen
+static void reopen(const std::string &path) {
+	std::filesystem::remove(path);
+	{
+		RegionFile file(path);
+		file.write(0, record('a', 10));
+		file.write(1, record('b', 10));
+	}
+
+	RegionFile file(path);
+	CHECK(file.deadSize() == 0);
+	CHECK(file.fileSize() == RegionFile::headerSize + 128);
+	CHECK(readsAs(file, 0, record('a', 10)));
+	CHECK(readsAs(file, 1, record('b', 10)));
+
+	// in place, then appended after the capacity of the last record
+	file.write(0, record('c', 40));
+	file.write(2, record('d', 10));
+	CHECK(file.deadSize() == 0);
+	CHECK(readsAs(file, 0, record('c', 40)));
+	CHECK(readsAs(file, 1, record('b', 10)));
+	CHECK(readsAs(file, 2, record('d', 10)));
+
+	// moves to the end, its old place is dead
+	file.write(1, record('e', 100));
+	CHECK(file.deadSize() == 64);
+	CHECK(readsAs(file, 1, record('e', 100)));
+	CHECK(readsAs(file, 2, record('d', 10)));
+}
+
+static void reopenAgain(const std::string &path) {
+	RegionFile file(path);
+	CHECK(file.deadSize() == 64);
+	CHECK(file.fileSize() == RegionFile::headerSize + 64 * 3 + 128);
+	CHECK(readsAs(file, 0, record('c', 40)));
+	CHECK(readsAs(file, 1, record('e', 100)));
+	CHECK(readsAs(file, 2, record('d', 10)));
+	CHECK(!readsAs(file, 3, {}));
+}
+
+// anything that isn't a region file is replaced by an empty one
+static void corrupt(const std::string &path) {
+	{
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		out << "not a region file";
+	}
+	RegionFile file(path);
+	CHECK(file.fileSize() == RegionFile::headerSize);
+	CHECK(file.deadSize() == 0);
+	CHECK(!readsAs(file, 0, {}));
+	file.write(0, record('f', 10));
+	CHECK(readsAs(file, 0, record('f', 10)));
+}
+
+static void worldRoundTrip(const std::string &path) {
+	std::filesystem::remove_all(path);
+	std::vector<uint8_t> a = record('g', 1000), b = record('h', 3);
+	{
+		WorldDB db(path);
+		db.write(lvec2(0, 0), std::vector<uint8_t>(a));
+		db.write(lvec2(1, 0), std::vector<uint8_t>(b));
+		db.write(lvec2(-9, 3), std::vector<uint8_t>(b));
+		db.sync();
+	}
+	{
+		WorldDB db(path);
+		db.write(lvec2(1, 0), std::vector<uint8_t>(a));
+		db.erase(lvec2(-9, 3));
+		db.sync();
+	}
+	WorldDB db(path);
+	std::vector<uint8_t> data;
+	CHECK(db.read(lvec2(0, 0), data) && data == a);
+	CHECK(db.read(lvec2(1, 0), data) && data == a);
+	CHECK(!db.read(lvec2(-9, 3), data));
+	CHECK(!db.read(lvec2(5, 5), data));
+
+	// reading or erasing chunks of a region without a file doesn't create one
+	auto files = [&]() {
+		return std::distance(std::filesystem::directory_iterator(path), std::filesystem::directory_iterator());
+	};
+	auto before = files();
+	CHECK(!db.read(lvec2(1000, 1000), data));
+	db.erase(lvec2(1000, -1000));
+	db.sync();
+	CHECK(files() == before);
+}
+
+int main() {
+	std::string dir = (std::filesystem::temp_directory_path() / "photon_test_worlddb").string();
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir);
+
+	reopen(dir + "/region.dat");
+	reopenAgain(dir + "/region.dat");
+	corrupt(dir + "/corrupt.dat");
+	worldRoundTrip(dir + "/world");
+
+	std::filesystem::remove_all(dir);
+	return testFailures() != 0;
+}